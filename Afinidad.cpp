@@ -0,0 +1,94 @@
+#include "Afinidad.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+bool parsearListaCpus(const char* texto, std::vector<int>& cpus) {
+    std::vector<int> leidas;
+    const char* p = texto;
+    while (*p != '\0') {
+        char* fin;
+        long desde = std::strtol(p, &fin, 10);
+        if (fin == p || desde < 0) return false;
+        long hasta = desde;
+        p = fin;
+        if (*p == '-') {
+            ++p;
+            hasta = std::strtol(p, &fin, 10);
+            if (fin == p || hasta < desde) return false;
+            p = fin;
+        }
+        if (hasta >= CPU_SETSIZE) return false;
+        for (long c = desde; c <= hasta; ++c) leidas.push_back(static_cast<int>(c));
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '\0') {
+            return false;
+        }
+    }
+    if (leidas.empty()) return false;
+    cpus.swap(leidas);
+    return true;
+}
+
+bool cpusPermitidas(const std::vector<int>& cpus, int& invalida) {
+    cpu_set_t permitidas;
+    CPU_ZERO(&permitidas);
+    if (sched_getaffinity(0, sizeof(permitidas), &permitidas) != 0) return true;   // Sin datos: que decida aplicar()
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (!CPU_ISSET(cpus[i], &permitidas)) {
+            invalida = cpus[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+int cpuActual() {
+    return sched_getcpu();
+}
+
+int nodoNumaActual() {
+    unsigned cpu = 0;
+    unsigned nodo = 0;
+    if (syscall(SYS_getcpu, &cpu, &nodo, nullptr) != 0) return -1;
+    return static_cast<int>(nodo);
+}
+
+AfinidadHilos& AfinidadHilos::global() {
+    static AfinidadHilos afinidad;
+    return afinidad;
+}
+
+void AfinidadHilos::setCpus(RolHilo rol, const std::vector<int>& lista) {
+    std::lock_guard<std::mutex> lock(mtx);
+    cpus[rol] = lista;
+}
+
+std::vector<int> AfinidadHilos::getCpus(RolHilo rol) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return cpus[rol];
+}
+
+bool AfinidadHilos::aplicar(RolHilo rol, size_t indice) {
+    int cpu;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (cpus[rol].empty()) return true;
+        cpu = cpus[rol][indice % cpus[rol].size()];
+    }
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(cpu, &conjunto);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(conjunto), &conjunto);
+    if (error == 0) return true;
+    static const char* nombres[ROLES_HILO] = {"lectura", "ingesta", "procesamiento"};
+    fallos.fetch_add(1, std::memory_order_relaxed);
+    std::cout << "[WARN] No se pudo fijar un hilo de " << nombres[rol] << " a la CPU " << cpu << ": "
+              << std::strerror(error) << ". Sigue sin fijar.\n";
+    return false;
+}
@@ -0,0 +1,86 @@
+#ifndef AFINIDAD_H
+#define AFINIDAD_H
+
+/**
+ * @file Afinidad.h
+ * @brief Fijación de los hilos de la ingesta a CPUs elegidas
+ *
+ * En equipos con varios zócalos, un hilo que el planificador mueve de un
+ * zócalo a otro deja atrás sus cachés y lee su memoria por el enlace entre
+ * nodos NUMA. Cada hilo de larga vida se declara con un rol al arrancar
+ * (lectura y parseo, aplicación en fragmentos, procesamiento) y se fija a
+ * las CPUs configuradas para ese rol. Como los historiales se reservan en la
+ * arena del hilo que escribe (ArenaNodos.h), fijar el hilo fija también el
+ * nodo de su memoria.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/// Rol de un hilo de larga vida
+enum RolHilo {
+    HILO_LECTURA,        ///< Bucle serial y servidor de red: leen y parsean
+    HILO_INGESTA,        ///< Hilos de los fragmentos de MotorIngesta: registran lecturas
+    HILO_PROCESAMIENTO,  ///< ProgramadorProcesamiento
+    ROLES_HILO
+};
+
+/**
+ * @brief Interpreta una lista de CPUs como "0-3,8,10-11"
+ * @return false si el texto no es válido o nombra una CPU fuera de rango
+ */
+bool parsearListaCpus(const char* texto, std::vector<int>& cpus);
+
+/**
+ * @brief Comprueba que el proceso pueda correr en todas las CPUs de la lista
+ *
+ * Compara con sched_getaffinity del hilo que llama, que excluye las CPUs
+ * fuera de línea y las que el cpuset del proceso no permite.
+ * @param invalida Primera CPU no permitida, si la hay
+ */
+bool cpusPermitidas(const std::vector<int>& cpus, int& invalida);
+
+/// CPU en la que corre el hilo que llama (-1 si no se sabe)
+int cpuActual();
+
+/// Nodo NUMA de la CPU del hilo que llama (-1 si no se sabe)
+int nodoNumaActual();
+
+/**
+ * @brief CPUs configuradas por rol
+ *
+ * La configuración rige para los hilos que arrancan después de fijarla.
+ */
+class AfinidadHilos {
+public:
+    static AfinidadHilos& global();
+
+    /// CPUs de un rol; una lista vacía deja los hilos sin fijar
+    void setCpus(RolHilo rol, const std::vector<int>& cpus);
+    std::vector<int> getCpus(RolHilo rol) const;
+
+    /**
+     * @brief Fija el hilo que llama según su rol
+     *
+     * El i-ésimo hilo de un rol va a cpus[i % n], de modo que los fragmentos
+     * quedan repartidos de a uno por CPU.
+     * Una falla se cuenta y se avisa por consola con el rol y la CPU.
+     * @param indice Número del hilo dentro de su rol
+     * @return false si la fijación falló (el hilo sigue sin fijar)
+     */
+    bool aplicar(RolHilo rol, size_t indice = 0);
+
+    /// Fijaciones que fallaron desde el arranque
+    unsigned long getFallos() const { return fallos.load(std::memory_order_relaxed); }
+
+private:
+    mutable std::mutex mtx;
+    std::vector<int> cpus[ROLES_HILO];
+    std::atomic<unsigned long> fallos;
+
+    AfinidadHilos() : fallos(0) {}
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "ArchivoDerrame.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+ArchivoDerrame::ArchivoDerrame() : fd(-1), fin(0), enUso(0), recuperaciones(0), errores(0) {}
+
+ArchivoDerrame::~ArchivoDerrame() {
+    int f = fd.load();
+    if (f >= 0) close(f);
+}
+
+bool ArchivoDerrame::abrir(const char* directorio) {
+    static std::mutex mtxApertura;
+    std::lock_guard<std::mutex> lock(mtxApertura);
+    if (estaAbierto()) return true;
+    int f = open(directorio, O_TMPFILE | O_RDWR | O_EXCL | O_CLOEXEC, 0600);
+    if (f < 0 && (errno == EOPNOTSUPP || errno == EISDIR || errno == EINVAL)) {
+        // Sistema de archivos sin O_TMPFILE: nombre único que solo este proceso creó
+        std::string plantilla = std::string(directorio) + "/derrame-XXXXXX";
+        f = mkostemp(&plantilla[0], O_CLOEXEC);
+        if (f >= 0) unlink(plantilla.c_str());
+    }
+    if (f < 0) return false;
+    fd.store(f, std::memory_order_release);
+    return true;
+}
+
+RegionDerrame* ArchivoDerrame::reservar(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtxHuecos);
+    uint64_t desplazamiento = fin.load(std::memory_order_relaxed);
+    // Primer hueco que alcance; el sobrante sigue libre
+    for (std::map<uint64_t, uint64_t>::iterator h = huecos.begin(); h != huecos.end(); ++h) {
+        if (h->second < bytes) continue;
+        desplazamiento = h->first;
+        uint64_t resto = h->second - bytes;
+        huecos.erase(h);
+        if (resto > 0) huecos[desplazamiento + bytes] = resto;
+        enUso.fetch_add(bytes, std::memory_order_relaxed);
+        return new RegionDerrame(desplazamiento, bytes);
+    }
+    fin.store(desplazamiento + bytes, std::memory_order_relaxed);
+    enUso.fetch_add(bytes, std::memory_order_relaxed);
+    return new RegionDerrame(desplazamiento, bytes);
+}
+
+void ArchivoDerrame::soltar(RegionDerrame* region) {
+    if (region->referencias.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    uint64_t inicio = region->desplazamiento;
+    uint64_t largo = region->bytes;
+    delete region;
+    int f = fd.load(std::memory_order_acquire);
+
+    std::lock_guard<std::mutex> lock(mtxHuecos);
+    enUso.fetch_sub(largo, std::memory_order_relaxed);
+    if (largo == 0) return;
+    // Devolver los bloques al sistema de archivos; si no lo soporta, el hueco se reutiliza igual
+    fallocate(f, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(inicio),
+              static_cast<off_t>(largo));
+
+    // Fusionar con los huecos vecinos
+    std::map<uint64_t, uint64_t>::iterator siguiente = huecos.lower_bound(inicio);
+    if (siguiente != huecos.end() && siguiente->first == inicio + largo) {
+        largo += siguiente->second;
+        siguiente = huecos.erase(siguiente);
+    }
+    if (siguiente != huecos.begin()) {
+        std::map<uint64_t, uint64_t>::iterator anterior = siguiente;
+        --anterior;
+        if (anterior->first + anterior->second == inicio) {
+            inicio = anterior->first;
+            largo += anterior->second;
+            huecos.erase(anterior);
+        }
+    }
+    if (inicio + largo == fin.load(std::memory_order_relaxed)) {
+        // Hueco al final: el archivo se acorta
+        fin.store(inicio, std::memory_order_relaxed);
+        if (ftruncate(f, static_cast<off_t>(inicio)) != 0) errores.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    huecos[inicio] = largo;
+}
+
+bool ArchivoDerrame::escribir(uint64_t desplazamiento, const void* datos, size_t bytes) {
+    const char* p = static_cast<const char*>(datos);
+    int f = fd.load(std::memory_order_acquire);
+    while (bytes > 0) {
+        ssize_t n = pwrite(f, p, bytes, static_cast<off_t>(desplazamiento));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            errores.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        p += n;
+        desplazamiento += static_cast<uint64_t>(n);
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ArchivoDerrame::leer(uint64_t desplazamiento, void* datos, size_t bytes) const {
+    char* p = static_cast<char*>(datos);
+    int f = fd.load(std::memory_order_acquire);
+    while (bytes > 0) {
+        ssize_t n = pread(f, p, bytes, static_cast<off_t>(desplazamiento));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            errores.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        p += n;
+        desplazamiento += static_cast<uint64_t>(n);
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
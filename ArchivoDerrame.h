@@ -0,0 +1,131 @@
+#ifndef ARCHIVO_DERRAME_H
+#define ARCHIVO_DERRAME_H
+
+/**
+ * @file ArchivoDerrame.h
+ * @brief Archivo local donde se guardan los historiales fríos
+ *
+ * Cuando el sistema supera su presupuesto de memoria, los historiales de los
+ * sensores menos usados se escriben aquí y sus nodos se liberan. Cada
+ * historial ocupa una región contigua de valores crudos (float o int).
+ *
+ * Cada región cuenta sus referencias: la lista mientras sigue derramada y
+ * cada instantánea tomada en ese tiempo, que puede seguir leyéndola después
+ * de que la lista vuelva a memoria. Cuando la última se suelta, el espacio
+ * pasa a la lista de huecos libres (fusionado con los vecinos), se devuelve
+ * al sistema de archivos con FALLOC_FL_PUNCH_HOLE y lo reutilizan los
+ * derrames siguientes; si el hueco queda al final, el archivo se acorta.
+ * Así el archivo ocupa a lo sumo lo que ocupan las regiones vivas más la
+ * fragmentación entre ellas, por muchos ciclos de derrame y recuperación
+ * que haya.
+ *
+ * El archivo se crea sin nombre (O_TMPFILE, o mkstemp seguido de unlink del
+ * nombre recién creado) dentro del directorio elegido: nunca se trunca ni se
+ * borra un archivo existente, y desaparece con el proceso aunque este
+ * termine de forma abrupta.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+/**
+ * @brief Región del archivo con los valores de un historial derramado
+ */
+struct RegionDerrame {
+    uint64_t desplazamiento;        ///< Posición en el archivo
+    uint64_t bytes;                 ///< Largo reservado
+    std::atomic<int> referencias;   ///< Lista derramada más instantáneas que la leen
+
+    RegionDerrame(uint64_t d, uint64_t b) : desplazamiento(d), bytes(b), referencias(1) {}
+};
+
+/**
+ * @brief Almacenamiento de historiales derramados con reutilización de huecos
+ *
+ * reservar(), soltar() y leer() pueden llamarse desde cualquier hilo; cada
+ * región la escribe un único hilo (el que la reservó).
+ */
+class ArchivoDerrame {
+public:
+    static const int kValoresPorBloque = 1024;  ///< Valores por lectura o escritura
+
+    ArchivoDerrame();
+    ~ArchivoDerrame();
+    ArchivoDerrame(const ArchivoDerrame&) = delete;
+    ArchivoDerrame& operator=(const ArchivoDerrame&) = delete;
+
+    /**
+     * @brief Crea el archivo de derrame
+     *
+     * Solo la primera llamada tiene efecto: las regiones ya escritas deben
+     * seguir siendo legibles.
+     * @param directorio Directorio donde crear el archivo, que nunca tiene nombre visible
+     * @return true si el archivo está abierto
+     */
+    bool abrir(const char* directorio);
+
+    bool estaAbierto() const { return fd.load(std::memory_order_acquire) >= 0; }
+
+    /**
+     * @brief Reserva una región, reutilizando un hueco libre si alguno alcanza
+     * @return Región con una referencia, que el llamador suelta con soltar()
+     */
+    RegionDerrame* reservar(size_t bytes);
+
+    /// Suma una referencia a una región (una instantánea que va a leerla)
+    void retener(RegionDerrame* region) { region->referencias.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Quita una referencia; con la última, el espacio queda libre para otros derrames
+    void soltar(RegionDerrame* region);
+
+    /// Escribe datos en una región reservada
+    bool escribir(uint64_t desplazamiento, const void* datos, size_t bytes);
+
+    /// Lee datos de una región ya escrita
+    bool leer(uint64_t desplazamiento, void* datos, size_t bytes) const;
+
+    /// Lo llama ListaSensor cada vez que vuelve a cargar un historial
+    void contarRecuperacion() { recuperaciones.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Bytes de las regiones vivas
+    uint64_t getBytes() const { return enUso.load(std::memory_order_relaxed); }
+    /// Largo del archivo: regiones vivas más los huecos entre ellas
+    uint64_t getTamano() const { return fin.load(std::memory_order_relaxed); }
+    unsigned long getRecuperaciones() const { return recuperaciones.load(std::memory_order_relaxed); }
+    unsigned long getErrores() const { return errores.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int> fd;
+    std::mutex mtxHuecos;                  ///< Protege huecos y fin al reservar o soltar
+    std::map<uint64_t, uint64_t> huecos;   ///< Desplazamiento -> bytes de cada hueco libre
+    std::atomic<uint64_t> fin;
+    std::atomic<uint64_t> enUso;
+    std::atomic<unsigned long> recuperaciones;
+    mutable std::atomic<unsigned long> errores;
+};
+
+/**
+ * @brief Recorre valores de T guardados en una región del archivo
+ * @param desde Índice del primer valor a entregar
+ * @param hasta Índice siguiente al último
+ * @param f Invocable con firma void(const T&)
+ * @return false si la lectura falló (f recibió solo los valores anteriores)
+ */
+template <typename T, typename F>
+bool recorrerDerrame(const ArchivoDerrame& archivo, uint64_t desplazamiento, int desde, int hasta, F f) {
+    T bloque[ArchivoDerrame::kValoresPorBloque];
+    for (int i = desde; i < hasta; ) {
+        int n = hasta - i < ArchivoDerrame::kValoresPorBloque ? hasta - i : ArchivoDerrame::kValoresPorBloque;
+        if (!archivo.leer(desplazamiento + static_cast<uint64_t>(i) * sizeof(T), bloque, n * sizeof(T))) {
+            return false;
+        }
+        for (int j = 0; j < n; ++j) f(bloque[j]);
+        i += n;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,263 @@
+#include "ArenaNodos.h"
+#include "Afinidad.h"
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+static const size_t kClases = ArenaNodos::kMaximoBloque / 16;   ///< Bloques de 16, 32, 48 y 64 bytes
+static const size_t kCabeceraTramo = 64;
+
+struct ArenaHilo;
+
+/// Comienzo de cada tramo: liberar() encuentra la arena redondeando la dirección
+struct CabeceraTramo {
+    std::atomic<ArenaHilo*> duena;   ///< Cambia cuando otra arena adopta el tramo
+};
+
+struct ArenaHilo {
+    int nodo;                                  ///< Nodo NUMA preferido de sus tramos
+    void* libres[kClases];                     ///< Listas enlazadas por el primer puntero; solo el dueño
+    std::atomic<void*> remotos[kClases];       ///< Liberados por otros hilos
+    char* cursor;                              ///< Parte sin usar del tramo actual
+    char* limite;
+    std::vector<char*> tramos;                 ///< Tramos propios; solo el dueño o, huérfana, quien la adopta
+
+    explicit ArenaHilo(int n) : nodo(n), cursor(nullptr), limite(nullptr) {
+        for (size_t c = 0; c < kClases; ++c) {
+            libres[c] = nullptr;
+            remotos[c].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+static std::atomic<int> modoPaginas(PAGINAS_NORMALES);
+static std::atomic<size_t> cuentaArenas(0);
+static std::atomic<size_t> cuentaTramos(0);
+static std::atomic<size_t> cuentaExplicitos(0);
+static std::atomic<size_t> cuentaFallos(0);
+static std::atomic<size_t> cuentaAdoptadas(0);
+static std::atomic<size_t> cuentaRecuperados(0);
+
+/**
+ * Todas las arenas y las de hilos que terminaron. Las arenas no se destruyen
+ * nunca: un hilo que leyó la dueña de un tramo antes de que cambiara todavía
+ * puede apilar en sus remotos, y esos bloques se recuperan como los demás.
+ */
+static std::mutex mtxHuerfanas;
+static std::vector<ArenaHilo*>& todas() {
+    static std::vector<ArenaHilo*>* lista = new std::vector<ArenaHilo*>();
+    return *lista;
+}
+static std::vector<ArenaHilo*>& huerfanas() {
+    static std::vector<ArenaHilo*>* lista = new std::vector<ArenaHilo*>();
+    return *lista;
+}
+
+static thread_local ArenaHilo* propia = nullptr;
+
+/// Devuelve la arena del hilo al terminar; los nodos vivos siguen siendo válidos
+struct DuenoArena {
+    ~DuenoArena() {
+        if (propia == nullptr) return;
+        std::lock_guard<std::mutex> lock(mtxHuerfanas);
+        huerfanas().push_back(propia);
+        propia = nullptr;
+    }
+};
+static thread_local DuenoArena dueno;
+
+static ArenaHilo* arenaPropia() {
+    if (propia != nullptr) return propia;
+    (void)&dueno;   // Registra el destructor del hilo
+    int nodo = nodoNumaActual();
+    {
+        std::lock_guard<std::mutex> lock(mtxHuerfanas);
+        std::vector<ArenaHilo*>& lista = huerfanas();
+        for (size_t i = 0; i < lista.size(); ++i) {
+            if (lista[i]->nodo == nodo) {
+                propia = lista[i];
+                lista[i] = lista.back();
+                lista.pop_back();
+                return propia;
+            }
+        }
+    }
+    propia = new ArenaHilo(nodo);
+    cuentaArenas.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mtxHuerfanas);
+    todas().push_back(propia);
+    return propia;
+}
+
+/// Agrega la lista enlazada que empieza en bloque al frente de libres
+static size_t encadenar(void*& libres, void* bloque) {
+    if (bloque == nullptr) return 0;
+    size_t n = 1;
+    void* ultimo = bloque;
+    while (*static_cast<void**>(ultimo) != nullptr) {
+        ultimo = *static_cast<void**>(ultimo);
+        ++n;
+    }
+    *static_cast<void**>(ultimo) = libres;
+    libres = bloque;
+    return n;
+}
+
+/**
+ * Antes de mapear un tramo nuevo: se funden en la arena propia las huérfanas
+ * de su nodo (tramos, libres y lo que quede del tramo en curso) y se toman
+ * los remotos de las demás arenas del nodo. Así los nodos que un hilo creó y
+ * otro liberó se reutilizan aunque el dueño casi no reserve o ya no exista.
+ */
+static void recuperar(ArenaHilo* a) {
+    std::lock_guard<std::mutex> lock(mtxHuerfanas);
+    std::vector<ArenaHilo*>& lista = huerfanas();
+    for (size_t i = 0; i < lista.size();) {
+        ArenaHilo* h = lista[i];
+        if (h->nodo != a->nodo) {
+            ++i;
+            continue;
+        }
+        for (size_t t = 0; t < h->tramos.size(); ++t) {
+            reinterpret_cast<CabeceraTramo*>(h->tramos[t])->duena.store(a, std::memory_order_release);
+            a->tramos.push_back(h->tramos[t]);
+        }
+        h->tramos.clear();
+        for (size_t c = 0; c < kClases; ++c) {
+            encadenar(a->libres[c], h->libres[c]);
+            h->libres[c] = nullptr;
+        }
+        if (h->limite - h->cursor > a->limite - a->cursor) {
+            a->cursor = h->cursor;
+            a->limite = h->limite;
+        }
+        h->cursor = h->limite = nullptr;
+        cuentaAdoptadas.fetch_add(1, std::memory_order_relaxed);
+        lista[i] = lista.back();
+        lista.pop_back();
+    }
+    // Vaciar la pila con exchange es seguro con varios lectores: nadie desapila de a uno
+    size_t recuperados = 0;
+    std::vector<ArenaHilo*>& arenas = todas();
+    for (size_t i = 0; i < arenas.size(); ++i) {
+        if (arenas[i]->nodo != a->nodo) continue;
+        for (size_t c = 0; c < kClases; ++c) {
+            recuperados += encadenar(a->libres[c], arenas[i]->remotos[c].exchange(nullptr, std::memory_order_acquire));
+        }
+    }
+    cuentaRecuperados.fetch_add(recuperados, std::memory_order_relaxed);
+}
+
+static char* mapearTramo(int nodo) {
+    int modo = modoPaginas.load(std::memory_order_relaxed);
+    void* p = MAP_FAILED;
+    if (modo == PAGINAS_EXPLICITAS) {
+        // Las páginas de hugetlb ya vienen alineadas a su tamaño
+        p = mmap(nullptr, ArenaNodos::kBytesTramo, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p == MAP_FAILED) {
+            cuentaFallos.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            cuentaExplicitos.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (p == MAP_FAILED) {
+        // El doble, para recortar un tramo alineado a kBytesTramo
+        size_t pedido = 2 * ArenaNodos::kBytesTramo;
+        void* q = mmap(nullptr, pedido, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (q == MAP_FAILED) throw std::bad_alloc();
+        uintptr_t inicio = reinterpret_cast<uintptr_t>(q);
+        uintptr_t alineado = (inicio + ArenaNodos::kBytesTramo - 1) & ~(ArenaNodos::kBytesTramo - 1);
+        if (alineado > inicio) munmap(q, alineado - inicio);
+        size_t cola = inicio + pedido - (alineado + ArenaNodos::kBytesTramo);
+        if (cola > 0) munmap(reinterpret_cast<void*>(alineado + ArenaNodos::kBytesTramo), cola);
+        p = reinterpret_cast<void*>(alineado);
+        if (modo != PAGINAS_NORMALES) madvise(p, ArenaNodos::kBytesTramo, MADV_HUGEPAGE);
+    }
+    if (nodo >= 0 && nodo < 64) {
+        // Antes de tocar el tramo: las páginas se asignan al primer acceso
+        unsigned long mascara = 1UL << nodo;
+        syscall(SYS_mbind, p, ArenaNodos::kBytesTramo, MPOL_PREFERRED, &mascara, 64UL, 0U);
+    }
+    cuentaTramos.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(p);
+}
+
+void* ArenaNodos::reservar(size_t bytes) {
+    size_t clase = (bytes + 15) / 16 - 1;
+    if (bytes == 0 || clase >= kClases) return ::operator new(bytes);
+    ArenaHilo* a = arenaPropia();
+    void* bloque = a->libres[clase];
+    if (bloque == nullptr) bloque = a->remotos[clase].exchange(nullptr, std::memory_order_acquire);
+    if (bloque != nullptr) {
+        a->libres[clase] = *static_cast<void**>(bloque);
+        return bloque;
+    }
+    size_t tamano = (clase + 1) * 16;
+    if (a->cursor == nullptr || a->cursor + tamano > a->limite) {
+        recuperar(a);
+        bloque = a->libres[clase];
+        if (bloque != nullptr) {
+            a->libres[clase] = *static_cast<void**>(bloque);
+            return bloque;
+        }
+    }
+    if (a->cursor == nullptr || a->cursor + tamano > a->limite) {
+        char* tramo = mapearTramo(a->nodo);
+        new (tramo) CabeceraTramo();
+        reinterpret_cast<CabeceraTramo*>(tramo)->duena.store(a, std::memory_order_release);
+        a->tramos.push_back(tramo);
+        a->cursor = tramo + kCabeceraTramo;
+        a->limite = tramo + kBytesTramo;
+    }
+    bloque = a->cursor;
+    a->cursor += tamano;
+    return bloque;
+}
+
+void ArenaNodos::liberar(void* bloque, size_t bytes) {
+    if (bloque == nullptr) return;
+    size_t clase = (bytes + 15) / 16 - 1;
+    if (bytes == 0 || clase >= kClases) {
+        ::operator delete(bloque);
+        return;
+    }
+    uintptr_t tramo = reinterpret_cast<uintptr_t>(bloque) & ~(kBytesTramo - 1);
+    ArenaHilo* a = reinterpret_cast<CabeceraTramo*>(tramo)->duena.load(std::memory_order_acquire);
+    if (a == propia) {
+        *static_cast<void**>(bloque) = a->libres[clase];
+        a->libres[clase] = bloque;
+        return;
+    }
+    // Pila de Treiber: se vacía entera con exchange, así que no hay ABA
+    void* cabeza = a->remotos[clase].load(std::memory_order_relaxed);
+    do {
+        *static_cast<void**>(bloque) = cabeza;
+    } while (!a->remotos[clase].compare_exchange_weak(cabeza, bloque, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+}
+
+void ArenaNodos::setModoPaginas(ModoPaginasArena modo) {
+    modoPaginas.store(modo, std::memory_order_relaxed);
+}
+
+ModoPaginasArena ArenaNodos::getModoPaginas() {
+    return static_cast<ModoPaginasArena>(modoPaginas.load(std::memory_order_relaxed));
+}
+
+EstadisticasArenas ArenaNodos::getEstadisticas() {
+    EstadisticasArenas e;
+    e.arenas = cuentaArenas.load();
+    e.tramos = cuentaTramos.load();
+    e.tramosExplicitos = cuentaExplicitos.load();
+    e.fallosExplicitos = cuentaFallos.load();
+    e.adoptadas = cuentaAdoptadas.load();
+    e.recuperados = cuentaRecuperados.load();
+    e.bytes = e.tramos * kBytesTramo;
+    return e;
+}
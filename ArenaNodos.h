@@ -0,0 +1,77 @@
+#ifndef ARENA_NODOS_H
+#define ARENA_NODOS_H
+
+/**
+ * @file ArenaNodos.h
+ * @brief Arenas por hilo para los nodos de los historiales
+ *
+ * Cada hilo reserva los nodos de ListaSensor desde su propia arena, hecha de
+ * tramos de 2 MiB alineados a 2 MiB:
+ *  - Los tramos se piden con preferencia por el nodo NUMA de la CPU del hilo
+ *    (mbind con MPOL_PREFERRED antes de tocarlos). El hilo que registra las
+ *    lecturas de un sensor es el de su fragmento, así que el historial queda
+ *    en el nodo de ese hilo.
+ *  - Un tramo ocupa exactamente una página grande: según el modo se pide
+ *    con páginas transparentes (MADV_HUGEPAGE) o explícitas (MAP_HUGETLB),
+ *    y recorrer un historial largo deja de fallar en la TLB cada 4 KiB.
+ *
+ * Reservar y liberar desde el hilo dueño no toma cerrojos. Un nodo liberado
+ * desde otro hilo (el procesamiento, una instantánea que se suelta) vuelve a
+ * su arena por una pila atómica que el dueño recoge cuando se le acaban los
+ * libres. Antes de mapear un tramo nuevo, un hilo toma además las pilas de
+ * las otras arenas de su nodo NUMA y funde en la suya las de hilos que
+ * terminaron: los nodos creados en el menú y recortados por el procesamiento
+ * no se acumulan en una arena que ya casi no reserva.
+ *
+ * La memoria de los tramos se reutiliza pero no vuelve al sistema: los
+ * bloques libres están enlazados dentro del propio tramo, así que un tramo
+ * vacío no puede devolverse sin sacarlos antes de todas las listas. Por eso
+ * PresupuestoMemoria cuenta bytes de nodos y no memoria residente; derramar
+ * historiales deja espacio para los nodos nuevos, no baja el RSS.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+/// Cómo se piden las páginas de los tramos nuevos
+enum ModoPaginasArena {
+    PAGINAS_NORMALES,        ///< Sin indicaciones: decide la configuración del kernel
+    PAGINAS_TRANSPARENTES,   ///< madvise(MADV_HUGEPAGE)
+    PAGINAS_EXPLICITAS       ///< MAP_HUGETLB; si no hay páginas reservadas, transparentes
+};
+
+/**
+ * @brief Contadores globales de las arenas
+ */
+struct EstadisticasArenas {
+    size_t arenas;              ///< Arenas creadas (una por hilo que reservó nodos)
+    size_t tramos;              ///< Tramos mapeados
+    size_t tramosExplicitos;    ///< De ellos, con MAP_HUGETLB
+    size_t fallosExplicitos;    ///< Pedidos de MAP_HUGETLB que no pudieron cumplirse
+    size_t adoptadas;           ///< Arenas de hilos terminados fundidas en otra
+    size_t recuperados;         ///< Bloques tomados de las pilas remotas de otras arenas
+    size_t bytes;               ///< Bytes mapeados
+};
+
+/**
+ * @brief Reserva de bloques chicos (hasta kMaximoBloque bytes) en las arenas
+ *
+ * Lo usan los operator new/delete de Nodo; los pedidos más grandes van al
+ * montículo común.
+ */
+class ArenaNodos {
+public:
+    static const size_t kBytesTramo = 2 * 1024 * 1024;
+    static const size_t kMaximoBloque = 64;
+
+    static void* reservar(size_t bytes);
+    static void liberar(void* bloque, size_t bytes);
+
+    /// Modo de los tramos que se mapeen desde ahora
+    static void setModoPaginas(ModoPaginasArena modo);
+    static ModoPaginasArena getModoPaginas();
+
+    static EstadisticasArenas getEstadisticas();
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "BosquejoKLL.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/// splitmix64: semillas parecidas (ids consecutivos) dan estados sin relación, nunca 0
+static uint64_t mezclarSemilla(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x != 0 ? x : BosquejoKLL::kSemillaFija;
+}
+
+BosquejoKLL::BosquejoKLL(int kParam, uint64_t semillaInicial)
+    : k(kParam < 8 ? 8 : kParam), cantidad(0), minimo(0.0f), maximo(0.0f),
+      semilla(mezclarSemilla(semillaInicial)), capacidadSuma(0) {
+    agregarNivel();
+}
+
+void BosquejoKLL::limpiar() {
+    cantidad = 0;
+    minimo = maximo = 0.0f;
+    niveles.clear();
+    capacidadSuma = 0;
+    agregarNivel();
+}
+
+void BosquejoKLL::agregarNivel() {
+    // Los niveles altos (peso grande) tienen capacidad k; cada nivel inferior, 2/3 de la anterior.
+    // La capacidad de una profundidad no cambia: se calcula una vez, al aparecer
+    size_t profundidad = niveles.size();
+    if (capacidades.size() <= profundidad) {
+        uint32_t c = static_cast<uint32_t>(std::ceil(k * std::pow(2.0 / 3.0, static_cast<double>(profundidad))));
+        capacidades.push_back(c < 2 ? 2 : c);
+    }
+    capacidadSuma += capacidades[profundidad];
+    niveles.push_back(std::vector<float>());
+}
+
+size_t BosquejoKLL::getRetenidos() const {
+    size_t total = 0;
+    for (size_t h = 0; h < niveles.size(); ++h) total += niveles[h].size();
+    return total;
+}
+
+bool BosquejoKLL::moneda() {
+    // xorshift64: suficiente para elegir la mitad par o impar
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 7;
+    semilla ^= semilla << 17;
+    return (semilla & 1) != 0;
+}
+
+void BosquejoKLL::agregar(float valor) {
+    if (cantidad == 0 || valor < minimo) minimo = valor;
+    if (cantidad == 0 || valor > maximo) maximo = valor;
+    ++cantidad;
+    niveles[0].push_back(valor);
+    if (niveles[0].size() >= capacidad(0)) comprimir();
+}
+
+void BosquejoKLL::comprimir() {
+    while (getRetenidos() >= capacidadTotal()) {
+        for (size_t h = 0; h < niveles.size(); ++h) {
+            if (niveles[h].size() < capacidad(h)) continue;
+            if (h + 1 == niveles.size()) agregarNivel();
+
+            std::vector<float>& nivel = niveles[h];
+            std::sort(nivel.begin(), nivel.end());
+            // Con cantidad impar, el último valor se queda en este nivel
+            float sobrante = 0.0f;
+            bool haySobrante = (nivel.size() % 2) != 0;
+            if (haySobrante) {
+                sobrante = nivel.back();
+                nivel.pop_back();
+            }
+            size_t desplazamiento = moneda() ? 1 : 0;
+            std::vector<float>& superior = niveles[h + 1];
+            for (size_t i = desplazamiento; i < nivel.size(); i += 2) {
+                superior.push_back(nivel[i]);
+            }
+            nivel.clear();
+            if (haySobrante) nivel.push_back(sobrante);
+            break;
+        }
+    }
+}
+
+void BosquejoKLL::fusionar(const BosquejoKLL& otro) {
+    if (otro.cantidad == 0) return;
+    if (cantidad == 0 || otro.minimo < minimo) minimo = otro.minimo;
+    if (cantidad == 0 || otro.maximo > maximo) maximo = otro.maximo;
+    cantidad += otro.cantidad;
+    while (niveles.size() < otro.niveles.size()) agregarNivel();
+    for (size_t h = 0; h < otro.niveles.size(); ++h) {
+        niveles[h].insert(niveles[h].end(), otro.niveles[h].begin(), otro.niveles[h].end());
+    }
+    comprimir();
+}
+
+float BosquejoKLL::cuantil(double q) const {
+    float resultado;
+    cuantiles(&q, &resultado, 1);
+    return resultado;
+}
+
+void BosquejoKLL::cuantiles(const double* q, float* resultado, size_t n) const {
+    for (size_t j = 0; j < n; ++j) {
+        if (cantidad == 0) resultado[j] = 0.0f;
+        else if (q[j] <= 0.0) resultado[j] = minimo;
+        else if (q[j] >= 1.0) resultado[j] = maximo;
+    }
+    if (cantidad == 0) return;
+
+    // Vector por hilo: tras el primer uso, consultar no reserva memoria
+    static thread_local std::vector<std::pair<float, uint64_t> > ponderados;
+    ponderados.clear();
+    uint64_t pesoTotal = 0;
+    for (size_t h = 0; h < niveles.size(); ++h) {
+        uint64_t peso = static_cast<uint64_t>(1) << h;
+        for (size_t i = 0; i < niveles[h].size(); ++i) {
+            ponderados.push_back(std::make_pair(niveles[h][i], peso));
+            pesoTotal += peso;
+        }
+    }
+    std::sort(ponderados.begin(), ponderados.end());
+
+    uint64_t acumulado = 0;
+    size_t i = 0;
+    for (size_t j = 0; j < n; ++j) {
+        if (q[j] <= 0.0 || q[j] >= 1.0) continue;
+        double objetivo = q[j] * static_cast<double>(pesoTotal);
+        while (i < ponderados.size() && static_cast<double>(acumulado) < objetivo) {
+            acumulado += ponderados[i].second;
+            ++i;
+        }
+        resultado[j] = static_cast<double>(acumulado) >= objetivo && i > 0 ? ponderados[i - 1].first : maximo;
+    }
+}
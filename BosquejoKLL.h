@@ -0,0 +1,88 @@
+#ifndef BOSQUEJO_KLL_H
+#define BOSQUEJO_KLL_H
+
+/**
+ * @file BosquejoKLL.h
+ * @brief Bosquejo de cuantiles aproximados en flujo (Karnin, Lang y Liberty)
+ *
+ * Responde p50/p95/p99 de un flujo de lecturas con memoria acotada por el
+ * parámetro k, sin copiar ni ordenar el historial. Dos bosquejos pueden
+ * fusionarse, lo que permite calcular percentiles de toda la flota a partir
+ * de los bosquejos de cada sensor.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Bosquejo KLL de valores float
+ *
+ * El error de rango es aproximadamente 1.7/k con alta probabilidad; con
+ * k = 200 el bosquejo ocupa del orden de 3k valores sin importar cuántas
+ * lecturas haya recibido. El azar de las compactaciones es determinista
+ * para que los resultados sean reproducibles, pero cada sensor pasa su propia
+ * semilla (derivada de su id): con una sola semilla, todos los bosquejos
+ * tirarían las mismas monedas y sus errores se sumarían al fusionarlos.
+ */
+class BosquejoKLL {
+public:
+    static const uint64_t kSemillaFija = 0x9E3779B97F4A7C15ull;
+
+    /**
+     * @param k Capacidad del nivel superior (mínimo 8)
+     * @param semilla Cualquier valor; se mezcla antes de usarla
+     */
+    explicit BosquejoKLL(int k = 200, uint64_t semilla = kSemillaFija);
+
+    /// Agrega un valor al bosquejo
+    void agregar(float valor);
+
+    /// Incorpora los valores resumidos por otro bosquejo
+    void fusionar(const BosquejoKLL& otro);
+
+    /**
+     * @brief Cuantil aproximado
+     * @param q Fracción entre 0 y 1 (0.5 = mediana)
+     * @return Valor estimado o 0 si el bosquejo está vacío
+     */
+    float cuantil(double q) const;
+
+    /**
+     * @brief Varios cuantiles con una sola ordenación
+     * @param q Fracciones en orden creciente
+     * @param resultado Arreglo de n valores
+     * @param n Cantidad de cuantiles
+     */
+    void cuantiles(const double* q, float* resultado, size_t n) const;
+
+    /// Cantidad de valores agregados (incluyendo los fusionados)
+    uint64_t getCantidad() const { return cantidad; }
+
+    float getMinimo() const { return minimo; }
+    float getMaximo() const { return maximo; }
+
+    /// Valores que retiene el bosquejo en memoria
+    size_t getRetenidos() const;
+
+    void limpiar();
+
+private:
+    int k;
+    uint64_t cantidad;
+    float minimo;
+    float maximo;
+    uint64_t semilla;                          ///< Estado del generador de monedas
+    std::vector<std::vector<float> > niveles;  ///< Compactador de cada nivel (peso 2^nivel)
+    std::vector<uint32_t> capacidades;         ///< Por profundidad desde el nivel superior
+    size_t capacidadSuma;                      ///< Suma de las capacidades de los niveles actuales
+
+    /// Capacidad del nivel; sin cálculos en punto flotante por lectura
+    size_t capacidad(size_t nivel) const { return capacidades[niveles.size() - 1 - nivel]; }
+    size_t capacidadTotal() const { return capacidadSuma; }
+    void agregarNivel();
+    void comprimir();
+    bool moneda();
+};
+
+#endif
@@ -0,0 +1,309 @@
+#include "BucleSerial.h"
+#include "serial_linux.h"
+#include "ProtocoloBinario.h"
+#include "Trazas.h"
+#include "Afinidad.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+
+static const uint64_t kIdDespertador = ~static_cast<uint64_t>(0);
+
+static int64_t ahoraMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+BucleSerial::BucleSerial(CallbackLinea cb)
+    : callback(cb), epfd(epoll_create1(EPOLL_CLOEXEC)),
+      despertador(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), activo(true),
+      reconexionMinimaMs(250), reconexionMaximaMs(8000) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kIdDespertador;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, despertador, &ev);
+}
+
+BucleSerial::~BucleSerial() {
+    for (size_t i = 0; i < dispositivos.size(); ++i) {
+        if (dispositivos[i]->fd >= 0) close(dispositivos[i]->fd);
+        delete dispositivos[i];
+    }
+    close(despertador);
+    close(epfd);
+}
+
+int BucleSerial::agregarDispositivo(const char* ruta, int baud, const char* saludo) {
+    Dispositivo* d = new Dispositivo();
+    d->ruta = ruta;
+    d->baud = baud;
+    d->fd = -1;
+    d->reconectar = true;
+    d->saludo = saludo;
+    d->descartando = false;
+    d->enTrama = false;
+    d->proximoIntento = 0;
+    d->esperaMs = reconexionMinimaMs;
+    d->estadisticas = Estadisticas();
+    dispositivos.push_back(d);
+
+    int indice = static_cast<int>(dispositivos.size() - 1);
+    if (!conectar(indice)) {
+        d->proximoIntento = ahoraMs() + d->esperaMs;
+    }
+    return indice;
+}
+
+int BucleSerial::agregarDescriptor(int fd, const char* nombre) {
+    if (fd < 0) return -1;
+    Dispositivo* d = new Dispositivo();
+    d->ruta = nombre;
+    d->baud = 0;
+    d->fd = fd;
+    d->reconectar = false;
+    d->descartando = false;
+    d->enTrama = false;
+    d->proximoIntento = 0;
+    d->esperaMs = 0;
+    d->estadisticas = Estadisticas();
+    dispositivos.push_back(d);
+
+    int indice = static_cast<int>(dispositivos.size() - 1);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = static_cast<uint64_t>(indice);
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    // En modo edge-triggered los datos que ya estaban en el descriptor no generan evento
+    atenderLectura(indice, ahoraMs());
+    return indice;
+}
+
+void BucleSerial::setIntervaloReconexion(int minimoMs, int maximoMs) {
+    reconexionMinimaMs = minimoMs > 0 ? minimoMs : 1;
+    reconexionMaximaMs = maximoMs > reconexionMinimaMs ? maximoMs : reconexionMinimaMs;
+}
+
+bool BucleSerial::conectar(int indice) {
+    Dispositivo& d = *dispositivos[indice];
+    int fd = abrirPuertoSerial(d.ruta.c_str(), d.baud);
+    if (fd < 0) return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = static_cast<uint64_t>(indice);
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return false;
+    }
+    d.fd = fd;
+    d.esperaMs = reconexionMinimaMs;
+    bool escribible = (fcntl(fd, F_GETFL) & O_ACCMODE) == O_RDWR;
+    if (!d.saludo.empty() && escribible) enviar(indice, d.saludo.data(), d.saludo.size());
+    atenderLectura(indice, ahoraMs(), true);
+    return true;
+}
+
+void BucleSerial::desconectar(int indice, int64_t ahora) {
+    Dispositivo& d = *dispositivos[indice];
+    if (d.fd < 0) return;
+    epoll_ctl(epfd, EPOLL_CTL_DEL, d.fd, nullptr);
+    close(d.fd);
+    d.fd = -1;
+    d.pendiente.clear();
+    d.descartando = false;
+    d.enTrama = false;
+    d.trama.clear();
+    if (d.reconectar) {
+        d.proximoIntento = ahora + d.esperaMs;
+    }
+}
+
+bool BucleSerial::enviar(int dispositivo, const void* datos, size_t n) {
+    Dispositivo& d = *dispositivos[dispositivo];
+    if (d.fd < 0) return false;
+    const char* p = static_cast<const char*>(datos);
+    while (n > 0) {
+        ssize_t escritos = write(d.fd, p, n);
+        if (escritos < 0 && errno == EINTR) continue;
+        if (escritos <= 0) return false;
+        p += escritos;
+        n -= static_cast<size_t>(escritos);
+    }
+    return true;
+}
+
+size_t BucleSerial::completarTrama(Dispositivo& d, const char* datos, size_t n, int indice) {
+    size_t usado = 0;
+    while (usado < n) {
+        size_t total = kCabeceraTrama;
+        if (d.trama.size() >= kCabeceraTrama) {
+            total += static_cast<uint8_t>(d.trama[3]) | (static_cast<uint8_t>(d.trama[4]) << 8);
+            total += 2;
+        }
+        size_t tomar = total - d.trama.size();
+        if (tomar > n - usado) tomar = n - usado;
+        d.trama.append(datos + usado, tomar);
+        usado += tomar;
+        if (d.trama.size() < total) continue;
+
+        const uint8_t* t = reinterpret_cast<const uint8_t*>(d.trama.data());
+        if (total == kCabeceraTrama) {
+            size_t largo = t[3] | (t[4] << 8);
+            if (largo <= kCargaMaximaTrama) continue;  // Falta la carga: seguir acumulando
+            // Cabecera imposible: no era una trama; se retoma en busca de líneas
+            d.estadisticas.tramasInvalidas++;
+        } else {
+            size_t largo = total - kCabeceraTrama - 2;
+            uint16_t crc = static_cast<uint16_t>(t[total - 2] | (t[total - 1] << 8));
+            if (crc16(t + 1, kCabeceraTrama - 1 + largo) != crc) {
+                d.estadisticas.tramasInvalidas++;
+            } else {
+                d.estadisticas.tramas++;
+                if (callbackTrama) callbackTrama(indice, t[1], t[2], t + kCabeceraTrama, largo);
+            }
+        }
+        d.enTrama = false;
+        d.trama.clear();
+        break;
+    }
+    return usado;
+}
+
+void BucleSerial::consumirBytes(Dispositivo& d, const char* datos, size_t n, int indice) {
+    size_t inicio = 0;
+    size_t i = 0;
+    if (d.enTrama) {
+        i = inicio = completarTrama(d, datos, n, indice);
+    }
+    for (; i < n; ++i) {
+        if (static_cast<uint8_t>(datos[i]) == kSincroniaTrama && i == inicio &&
+            d.pendiente.empty() && !d.descartando) {
+            // Una trama solo puede empezar donde empezaría una línea
+            d.enTrama = true;
+            d.trama.clear();
+            i += completarTrama(d, datos + i, n - i, indice);
+            inicio = i;
+            if (d.enTrama) break;
+            --i;  // El for avanza al primer byte tras la trama
+            continue;
+        }
+        if (datos[i] != '\n' && datos[i] != '\r') continue;
+        if (d.descartando) {
+            d.descartando = false;
+        } else if (!d.pendiente.empty()) {
+            d.pendiente.append(datos + inicio, i - inicio);
+            d.estadisticas.lineas++;
+            callback(indice, d.pendiente.data(), d.pendiente.size());
+            d.pendiente.clear();
+        } else if (i > inicio) {
+            // Línea completa dentro del buffer: se entrega sin copiarla
+            d.estadisticas.lineas++;
+            callback(indice, datos + inicio, i - inicio);
+        }
+        inicio = i + 1;
+    }
+    if (!d.descartando && !d.enTrama && inicio < n) {
+        d.pendiente.append(datos + inicio, n - inicio);
+        if (d.pendiente.size() > kLargoMaximoLinea) {
+            d.pendiente.clear();
+            d.descartando = true;
+            d.estadisticas.desbordes++;
+        }
+    }
+}
+
+void BucleSerial::atenderLectura(int indice, int64_t ahora, bool recienAbierto) {
+    TramoTraza traza("atenderLectura");
+    char buffer[4096];
+    bool hayDatos = false;
+    for (;;) {
+        Dispositivo& d = *dispositivos[indice];
+        if (d.fd < 0) return;
+        ssize_t leidos = read(d.fd, buffer, sizeof(buffer));
+        if (leidos > 0) {
+            hayDatos = true;
+            d.estadisticas.bytes += static_cast<unsigned long>(leidos);
+            consumirBytes(d, buffer, static_cast<size_t>(leidos), indice);
+            continue;
+        }
+        if (leidos < 0 && errno == EINTR) continue;
+        if (leidos < 0 && errno == EAGAIN) return; // vaciado: esperar el siguiente flanco
+        // Un FIFO recién abierto sin escritor devuelve EOF: seguir esperando al escritor
+        if (leidos == 0 && recienAbierto && !hayDatos) return;
+        // Fin de datos o error: entregar la última línea incompleta y desconectar
+        if (leidos == 0 && !d.pendiente.empty() && !d.descartando) {
+            d.estadisticas.lineas++;
+            callback(indice, d.pendiente.data(), d.pendiente.size());
+        }
+        desconectar(indice, ahora);
+        return;
+    }
+}
+
+void BucleSerial::reintentarConexiones(int64_t ahora) {
+    for (size_t i = 0; i < dispositivos.size(); ++i) {
+        Dispositivo& d = *dispositivos[i];
+        if (d.fd >= 0 || !d.reconectar || d.proximoIntento > ahora) continue;
+        if (conectar(static_cast<int>(i))) {
+            d.estadisticas.reconexiones++;
+        } else {
+            d.esperaMs = d.esperaMs * 2 > reconexionMaximaMs ? reconexionMaximaMs : d.esperaMs * 2;
+            d.proximoIntento = ahora + d.esperaMs;
+        }
+    }
+}
+
+int BucleSerial::calcularTimeout(int timeoutMs, int64_t ahora) const {
+    int64_t limite = timeoutMs < 0 ? -1 : timeoutMs;
+    for (size_t i = 0; i < dispositivos.size(); ++i) {
+        const Dispositivo& d = *dispositivos[i];
+        if (d.fd >= 0 || !d.reconectar) continue;
+        int64_t espera = d.proximoIntento > ahora ? d.proximoIntento - ahora : 0;
+        if (limite < 0 || espera < limite) limite = espera;
+    }
+    return static_cast<int>(limite);
+}
+
+bool BucleSerial::ejecutarUnaVez(int timeoutMs) {
+    if (!activo.load()) return false;
+
+    epoll_event eventos[64];
+    int n = epoll_wait(epfd, eventos, 64, calcularTimeout(timeoutMs, ahoraMs()));
+    if (n < 0 && errno != EINTR) return false;
+
+    int64_t ahora = ahoraMs();
+    for (int i = 0; i < n; ++i) {
+        if (eventos[i].data.u64 == kIdDespertador) {
+            uint64_t valor;
+            ssize_t r = read(despertador, &valor, sizeof(valor));
+            (void)r;
+            continue;
+        }
+        int indice = static_cast<int>(eventos[i].data.u64);
+        // EPOLLHUP/EPOLLERR llegan junto con los últimos datos: leer hasta EOF o EAGAIN
+        atenderLectura(indice, ahora);
+        if ((eventos[i].events & (EPOLLHUP | EPOLLERR)) && dispositivos[indice]->fd >= 0) {
+            desconectar(indice, ahora);
+        }
+    }
+    reintentarConexiones(ahora);
+    return activo.load();
+}
+
+void BucleSerial::ejecutar() {
+    AfinidadHilos::global().aplicar(HILO_LECTURA, 0);
+    Trazador::global().nombrarHilo("bucleSerial");
+    while (ejecutarUnaVez(-1)) {
+    }
+}
+
+void BucleSerial::detener() {
+    activo.store(false);
+    uint64_t uno = 1;
+    ssize_t r = write(despertador, &uno, sizeof(uno));
+    (void)r;
+}
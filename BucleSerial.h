@@ -0,0 +1,151 @@
+#ifndef BUCLE_SERIAL_H
+#define BUCLE_SERIAL_H
+
+/**
+ * @file BucleSerial.h
+ * @brief Bucle de eventos epoll para muchos dispositivos seriales en un solo hilo
+ *
+ * Sustituye la espera con select() sobre un único descriptor de
+ * readLineFromSerial() cuando hay que atender decenas de Arduinos: cada
+ * dispositivo se vigila con epoll en modo edge-triggered, conserva su línea
+ * parcial y se reabre automáticamente si se desconecta.
+ *
+ * En el mismo flujo pueden llegar tramas binarias (ProtocoloBinario.h): se
+ * separan de las líneas por su byte de sincronía, se verifica su CRC y se
+ * entregan por un callback propio.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Multiplexor de dispositivos seriales, pipes y ptys
+ *
+ * Todas las operaciones, salvo detener(), deben llamarse desde el hilo que
+ * ejecuta el bucle (o antes de arrancarlo). Los callbacks se invocan en ese
+ * mismo hilo.
+ */
+class BucleSerial {
+public:
+    /// Recibe el índice del dispositivo y una línea completa sin el salto de línea
+    typedef std::function<void(int dispositivo, const char* linea, size_t longitud)> CallbackLinea;
+
+    /// Recibe una trama binaria con CRC válido: tipo, cantidad y carga útil
+    typedef std::function<void(int dispositivo, uint8_t tipo, uint8_t cantidad,
+                               const uint8_t* carga, size_t largo)> CallbackTrama;
+
+    /**
+     * @brief Contadores de un dispositivo
+     */
+    struct Estadisticas {
+        unsigned long bytes;          ///< Bytes leídos
+        unsigned long lineas;         ///< Líneas entregadas
+        unsigned long desbordes;      ///< Líneas descartadas por superar el límite
+        unsigned long reconexiones;   ///< Reaperturas tras una desconexión
+        unsigned long tramas;         ///< Tramas binarias entregadas
+        unsigned long tramasInvalidas; ///< Tramas descartadas por cabecera o CRC
+    };
+
+    static const size_t kLargoMaximoLinea = 2048; ///< Igual al límite de readLineFromSerial
+
+    explicit BucleSerial(CallbackLinea callback);
+    ~BucleSerial();
+
+    BucleSerial(const BucleSerial&) = delete;
+    BucleSerial& operator=(const BucleSerial&) = delete;
+
+    /**
+     * @brief Añade un dispositivo por ruta con su propia velocidad
+     *
+     * Si no puede abrirse ahora, se reintenta según el intervalo de reconexión.
+     * @param saludo Texto que se escribe al dispositivo en cada conexión
+     *               (p. ej. kPedidoBinario); vacío = nada. Solo se envía a
+     *               terminales: pipes y FIFOs se abren solo para lectura
+     * @return Índice del dispositivo
+     */
+    int agregarDispositivo(const char* ruta, int baud = 115200, const char* saludo = "");
+
+    /// Define quién recibe las tramas binarias; sin callback se cuentan y descartan
+    void setCallbackTrama(CallbackTrama cb) { callbackTrama = cb; }
+
+    /**
+     * @brief Escribe datos al dispositivo sin bloquear
+     * @return false si está desconectado o el kernel no aceptó todos los bytes
+     */
+    bool enviar(int dispositivo, const void* datos, size_t n);
+
+    /**
+     * @brief Adopta un descriptor ya abierto (pipe, pty, socket)
+     *
+     * El descriptor pasa a ser propiedad del bucle; no se reconecta al cerrarse.
+     * @return Índice del dispositivo o -1 si fd no es válido
+     */
+    int agregarDescriptor(int fd, const char* nombre);
+
+    /**
+     * @brief Configura la espera entre reintentos de apertura
+     * @param minimoMs Primera espera tras una desconexión
+     * @param maximoMs Tope del crecimiento exponencial
+     */
+    void setIntervaloReconexion(int minimoMs, int maximoMs);
+
+    /// Ejecuta el bucle hasta que se llame a detener()
+    void ejecutar();
+
+    /**
+     * @brief Atiende los eventos pendientes una vez
+     * @param timeoutMs Espera máxima (-1 = indefinida, acotada por la próxima reconexión)
+     * @return false si se pidió detener el bucle
+     */
+    bool ejecutarUnaVez(int timeoutMs);
+
+    /// Pide al bucle que termine; seguro desde cualquier hilo
+    void detener();
+
+    /// Descriptor de epoll, para integrarlo en otro bucle de eventos
+    int getDescriptor() const { return epfd; }
+
+    size_t getCantidad() const { return dispositivos.size(); }
+    const std::string& getRuta(int dispositivo) const { return dispositivos[dispositivo]->ruta; }
+    bool estaConectado(int dispositivo) const { return dispositivos[dispositivo]->fd >= 0; }
+    Estadisticas getEstadisticas(int dispositivo) const { return dispositivos[dispositivo]->estadisticas; }
+
+private:
+    struct Dispositivo {
+        std::string ruta;
+        int baud;
+        int fd;
+        bool reconectar;          ///< false para descriptores adoptados
+        std::string saludo;       ///< Se envía en cada conexión
+        std::string pendiente;    ///< Línea parcial acumulada
+        bool descartando;         ///< Se superó el límite; ignorar hasta el próximo salto
+        bool enTrama;             ///< Se está acumulando una trama binaria
+        std::string trama;        ///< Trama parcial (desde la sincronía)
+        int64_t proximoIntento;   ///< Instante (ms monotónicos) del próximo reintento
+        int esperaMs;             ///< Espera actual del backoff
+        Estadisticas estadisticas;
+    };
+
+    CallbackLinea callback;
+    CallbackTrama callbackTrama;
+    std::vector<Dispositivo*> dispositivos;
+    int epfd;
+    int despertador;              ///< eventfd para detener()
+    std::atomic<bool> activo;
+    int reconexionMinimaMs;
+    int reconexionMaximaMs;
+
+    bool conectar(int indice);
+    void desconectar(int indice, int64_t ahora);
+    void atenderLectura(int indice, int64_t ahora, bool recienAbierto = false);
+    void consumirBytes(Dispositivo& d, const char* datos, size_t n, int indice);
+    size_t completarTrama(Dispositivo& d, const char* datos, size_t n, int indice);
+    void reintentarConexiones(int64_t ahora);
+    int calcularTimeout(int timeoutMs, int64_t ahora) const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "ClasificacionSensores.h"
+#include <algorithm>
+
+void MonticuloIndexado::subir(size_t i) {
+    PosicionClasificacion e = elementos[i];
+    while (i > 0) {
+        size_t padre = (i - 1) / 2;
+        if (!(elementos[padre].valor < e.valor)) break;
+        colocar(i, elementos[padre]);
+        i = padre;
+    }
+    colocar(i, e);
+}
+
+void MonticuloIndexado::bajar(size_t i) {
+    PosicionClasificacion e = elementos[i];
+    size_t n = elementos.size();
+    for (;;) {
+        size_t hijo = 2 * i + 1;
+        if (hijo >= n) break;
+        if (hijo + 1 < n && elementos[hijo].valor < elementos[hijo + 1].valor) ++hijo;
+        if (!(e.valor < elementos[hijo].valor)) break;
+        colocar(i, elementos[hijo]);
+        i = hijo;
+    }
+    colocar(i, e);
+}
+
+void MonticuloIndexado::actualizar(uint32_t sensor, float valor) {
+    if (sensor >= posiciones.size()) posiciones.resize(sensor + 1, kAusente);
+    uint32_t i = posiciones[sensor];
+    if (i == kAusente) {
+        PosicionClasificacion e = {sensor, valor};
+        elementos.push_back(e);
+        posiciones[sensor] = static_cast<uint32_t>(elementos.size() - 1);
+        subir(elementos.size() - 1);
+        return;
+    }
+    float anterior = elementos[i].valor;
+    if (valor == anterior) return;
+    elementos[i].valor = valor;
+    if (anterior < valor) subir(i); else bajar(i);
+}
+
+void MonticuloIndexado::quitar(uint32_t sensor) {
+    if (sensor >= posiciones.size() || posiciones[sensor] == kAusente) return;
+    size_t i = posiciones[sensor];
+    posiciones[sensor] = kAusente;
+    PosicionClasificacion ultimo = elementos.back();
+    elementos.pop_back();
+    if (i == elementos.size()) return;
+    // El último ocupa el hueco y se reacomoda hacia donde corresponda
+    colocar(i, ultimo);
+    subir(i);
+    bajar(posiciones[ultimo.sensor]);
+}
+
+void MonticuloIndexado::mejores(size_t k, std::vector<PosicionClasificacion>& destino) const {
+    if (k == 0 || elementos.empty()) return;
+    // Frontera: posiciones del montículo ordenadas como un montículo de máximos por su valor
+    std::vector<uint32_t> frontera;
+    frontera.reserve(2 * k + 1);
+    const std::vector<PosicionClasificacion>& e = elementos;
+    auto menor = [&e](uint32_t a, uint32_t b) { return e[a].valor < e[b].valor; };
+    frontera.push_back(0);
+    while (k > 0 && !frontera.empty()) {
+        std::pop_heap(frontera.begin(), frontera.end(), menor);
+        uint32_t i = frontera.back();
+        frontera.pop_back();
+        destino.push_back(elementos[i]);
+        --k;
+        for (uint32_t hijo = 2 * i + 1; hijo <= 2 * i + 2 && hijo < elementos.size(); ++hijo) {
+            frontera.push_back(hijo);
+            std::push_heap(frontera.begin(), frontera.end(), menor);
+        }
+    }
+}
+
+void ClasificacionSensores::actualizar(char tipo, uint32_t sensor, float ultima, float promedio, float maximo) {
+    int t = indiceTipo(tipo);
+    if (t < 0) return;
+    Franja& f = tipos[t].franjas[sensor % kFranjas];
+    uint32_t local = sensor / kFranjas;
+    std::lock_guard<std::mutex> lock(f.mtx);
+    f.monticulos[METRICA_ULTIMA].actualizar(local, ultima);
+    f.monticulos[METRICA_PROMEDIO].actualizar(local, promedio);
+    f.monticulos[METRICA_MAXIMO].actualizar(local, maximo);
+}
+
+void ClasificacionSensores::actualizarPromedio(char tipo, uint32_t sensor, float promedio) {
+    int t = indiceTipo(tipo);
+    if (t < 0) return;
+    Franja& f = tipos[t].franjas[sensor % kFranjas];
+    std::lock_guard<std::mutex> lock(f.mtx);
+    f.monticulos[METRICA_PROMEDIO].actualizar(sensor / kFranjas, promedio);
+}
+
+void ClasificacionSensores::quitar(char tipo, uint32_t sensor) {
+    int t = indiceTipo(tipo);
+    if (t < 0) return;
+    Franja& f = tipos[t].franjas[sensor % kFranjas];
+    std::lock_guard<std::mutex> lock(f.mtx);
+    for (int m = 0; m < METRICAS_CLASIFICACION; ++m) f.monticulos[m].quitar(sensor / kFranjas);
+}
+
+size_t ClasificacionSensores::mejores(char tipo, MetricaClasificacion metrica, size_t k,
+                                      std::vector<PosicionClasificacion>& destino) const {
+    int t = indiceTipo(tipo);
+    if (t < 0 || metrica >= METRICAS_CLASIFICACION || k == 0) return 0;
+    // Los k mayores del tipo están entre los k mayores de cada franja
+    std::vector<PosicionClasificacion> candidatos;
+    for (uint32_t i = 0; i < kFranjas; ++i) {
+        const Franja& f = tipos[t].franjas[i];
+        size_t desde = candidatos.size();
+        {
+            std::lock_guard<std::mutex> lock(f.mtx);
+            f.monticulos[metrica].mejores(k, candidatos);
+        }
+        for (size_t j = desde; j < candidatos.size(); ++j) candidatos[j].sensor = candidatos[j].sensor * kFranjas + i;
+    }
+    size_t n = std::min(k, candidatos.size());
+    std::partial_sort(candidatos.begin(), candidatos.begin() + n, candidatos.end(),
+                      [](const PosicionClasificacion& a, const PosicionClasificacion& b) { return b.valor < a.valor; });
+    destino.insert(destino.end(), candidatos.begin(), candidatos.begin() + n);
+    return n;
+}
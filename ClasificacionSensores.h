@@ -0,0 +1,126 @@
+#ifndef CLASIFICACION_SENSORES_H
+#define CLASIFICACION_SENSORES_H
+
+/**
+ * @file ClasificacionSensores.h
+ * @brief Tablas de los K mejores sensores por tipo y métrica
+ *
+ * Para cada tipo de sensor ('T', 'P', 'V') y cada métrica (última lectura,
+ * promedio del historial y máximo registrado) se mantiene un montículo de
+ * máximos indexado por el handle del sensor. Cada lectura actualiza la
+ * posición de su sensor en O(log n); consultar los K primeros cuesta
+ * O(K log K) sin importar cuántos sensores o lecturas haya.
+ *
+ * Cada lectura de cada fragmento de la ingesta pasa por aquí, así que los
+ * montículos de un tipo se reparten en franjas según el handle, cada una con
+ * su cerrojo: dos hilos solo compiten si sus sensores caen en la misma
+ * franja. La consulta toma los K primeros de cada franja y los mezcla.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/// Métrica por la que se ordena una clasificación
+enum MetricaClasificacion {
+    METRICA_ULTIMA,      ///< Última lectura registrada
+    METRICA_PROMEDIO,    ///< Promedio del historial actual
+    METRICA_MAXIMO,      ///< Mayor lectura registrada
+    METRICAS_CLASIFICACION
+};
+
+/**
+ * @brief Una fila de la clasificación
+ */
+struct PosicionClasificacion {
+    uint32_t sensor;     ///< Handle en TablaIds
+    float valor;
+};
+
+/**
+ * @brief Montículo de máximos con índice handle -> posición
+ *
+ * Permite cambiar el valor de un elemento cualquiera (subiéndolo o
+ * bajándolo) y quitarlo en O(log n). No es seguro entre hilos.
+ */
+class MonticuloIndexado {
+public:
+    /// Inserta el sensor o cambia su valor
+    void actualizar(uint32_t sensor, float valor);
+
+    /// Quita el sensor si estaba
+    void quitar(uint32_t sensor);
+
+    /**
+     * @brief Los k mayores, de mayor a menor
+     *
+     * Recorre el montículo como un árbol desde la raíz, con una frontera
+     * de candidatos ordenada: no toca más de 2k + 1 nodos.
+     */
+    void mejores(size_t k, std::vector<PosicionClasificacion>& destino) const;
+
+    size_t getCantidad() const { return elementos.size(); }
+
+private:
+    static constexpr uint32_t kAusente = 0xFFFFFFFFu;
+
+    std::vector<PosicionClasificacion> elementos;  ///< Montículo implícito
+    std::vector<uint32_t> posiciones;              ///< Por handle; kAusente si no está
+
+    void colocar(size_t i, const PosicionClasificacion& e) {
+        elementos[i] = e;
+        posiciones[e.sensor] = static_cast<uint32_t>(i);
+    }
+    void subir(size_t i);
+    void bajar(size_t i);
+};
+
+/**
+ * @brief Clasificaciones de todos los tipos y métricas
+ *
+ * Un cerrojo por tipo y franja. La consulta recorre las franjas de a una:
+ * no es una foto atómica de todo el tipo, como tampoco lo es entre lecturas.
+ */
+class ClasificacionSensores {
+public:
+    /**
+     * @brief Actualiza las métricas de un sensor tras una lectura
+     * @param tipo 'T', 'P' o 'V' (otros se ignoran)
+     */
+    void actualizar(char tipo, uint32_t sensor, float ultima, float promedio, float maximo);
+
+    /// Cambia solo el promedio (tras eliminar lecturas del historial)
+    void actualizarPromedio(char tipo, uint32_t sensor, float promedio);
+
+    /// Quita el sensor de las clasificaciones de su tipo
+    void quitar(char tipo, uint32_t sensor);
+
+    /**
+     * @brief Los k sensores de mayor valor
+     * @return Cantidad de filas añadidas a destino
+     */
+    size_t mejores(char tipo, MetricaClasificacion metrica, size_t k,
+                   std::vector<PosicionClasificacion>& destino) const;
+
+private:
+    static const int kTipos = 3;
+    static const uint32_t kFranjas = 16;   ///< El sensor h va a la franja h % kFranjas, con índice h / kFranjas
+
+    struct alignas(64) Franja {
+        mutable std::mutex mtx;
+        MonticuloIndexado monticulos[METRICAS_CLASIFICACION];
+    };
+
+    struct PorTipo {
+        Franja franjas[kFranjas];
+    };
+
+    PorTipo tipos[kTipos];
+
+    static int indiceTipo(char tipo) {
+        return tipo == 'T' ? 0 : tipo == 'P' ? 1 : tipo == 'V' ? 2 : -1;
+    }
+};
+
+#endif
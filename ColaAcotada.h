@@ -0,0 +1,148 @@
+#ifndef COLA_ACOTADA_H
+#define COLA_ACOTADA_H
+
+/**
+ * @file ColaAcotada.h
+ * @brief Cola FIFO de capacidad fija para comunicar hilos productores y consumidores
+ *
+ * Cuando la cola está llena el productor espera (contrapresión) en lugar de
+ * crecer sin límite. Las operaciones por lotes amortizan el coste del mutex.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Cola circular acotada y bloqueante
+ * @tparam T Tipo de elemento (debe ser movible y construible por defecto)
+ */
+template <typename T>
+class ColaAcotada {
+private:
+    std::vector<T> buffer;          ///< Almacenamiento circular
+    size_t inicio;                  ///< Índice del elemento más antiguo
+    size_t cantidad;                ///< Elementos almacenados
+    bool cerrada;                   ///< Tras cerrar() no se aceptan más elementos
+    unsigned long esperas;          ///< Veces que un productor encontró la cola llena
+    mutable std::mutex mtx;
+    std::condition_variable hayEspacio;
+    std::condition_variable hayDatos;
+
+public:
+    explicit ColaAcotada(size_t capacidad)
+        : buffer(capacidad > 0 ? capacidad : 1), inicio(0), cantidad(0),
+          cerrada(false), esperas(0) {}
+
+    ColaAcotada(const ColaAcotada&) = delete;
+    ColaAcotada& operator=(const ColaAcotada&) = delete;
+
+    /**
+     * @brief Inserta un elemento, esperando si la cola está llena
+     * @return false si la cola fue cerrada
+     */
+    bool push(T valor) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (cantidad == buffer.size() && !cerrada) {
+            ++esperas;
+            hayEspacio.wait(lock, [this] { return cantidad < buffer.size() || cerrada; });
+        }
+        if (cerrada) return false;
+        buffer[(inicio + cantidad) % buffer.size()] = std::move(valor);
+        ++cantidad;
+        hayDatos.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Inserta n elementos (moviéndolos) con una sola toma del cerrojo
+     *
+     * Espera cada vez que la cola se llena, igual que push().
+     * @return Cantidad insertada; menos de n solo si la cola fue cerrada
+     */
+    size_t pushLote(T* valores, size_t n) {
+        std::unique_lock<std::mutex> lock(mtx);
+        size_t hechos = 0;
+        while (hechos < n) {
+            if (cantidad == buffer.size() && !cerrada) {
+                ++esperas;
+                hayEspacio.wait(lock, [this] { return cantidad < buffer.size() || cerrada; });
+            }
+            if (cerrada) break;
+            while (hechos < n && cantidad < buffer.size()) {
+                buffer[(inicio + cantidad) % buffer.size()] = std::move(valores[hechos++]);
+                ++cantidad;
+            }
+            hayDatos.notify_one();
+        }
+        return hechos;
+    }
+
+    /**
+     * @brief Inserta sin esperar
+     * @return false si la cola está llena o cerrada
+     */
+    bool tryPush(T valor) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (cerrada || cantidad == buffer.size()) return false;
+        buffer[(inicio + cantidad) % buffer.size()] = std::move(valor);
+        ++cantidad;
+        hayDatos.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Extrae hasta maximo elementos, esperando a que haya al menos uno
+     * @param destino Vector al que se añaden los elementos extraídos
+     * @param maximo Número máximo de elementos a extraer
+     * @return Cantidad extraída; 0 solo si la cola está cerrada y vacía
+     */
+    size_t popLote(std::vector<T>& destino, size_t maximo) {
+        std::unique_lock<std::mutex> lock(mtx);
+        hayDatos.wait(lock, [this] { return cantidad > 0 || cerrada; });
+        return extraer(destino, maximo);
+    }
+
+    /**
+     * @brief Extrae hasta maximo elementos sin esperar
+     */
+    size_t tryPopLote(std::vector<T>& destino, size_t maximo) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return extraer(destino, maximo);
+    }
+
+    /// Despierta a todos los hilos en espera; los elementos pendientes aún pueden extraerse
+    void cerrar() {
+        std::lock_guard<std::mutex> lock(mtx);
+        cerrada = true;
+        hayDatos.notify_all();
+        hayEspacio.notify_all();
+    }
+
+    size_t getCantidad() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return cantidad;
+    }
+
+    size_t getCapacidad() const { return buffer.size(); }
+
+    unsigned long getEsperas() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return esperas;
+    }
+
+private:
+    size_t extraer(std::vector<T>& destino, size_t maximo) {
+        size_t n = cantidad < maximo ? cantidad : maximo;
+        for (size_t i = 0; i < n; ++i) {
+            destino.push_back(std::move(buffer[inicio]));
+            inicio = (inicio + 1) % buffer.size();
+        }
+        cantidad -= n;
+        if (n > 0) hayEspacio.notify_all();
+        return n;
+    }
+};
+
+#endif
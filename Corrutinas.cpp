@@ -0,0 +1,182 @@
+#include "Corrutinas.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+static thread_local Planificador* planificadorActual = nullptr;
+
+Planificador::Planificador()
+    : epfd(epoll_create1(EPOLL_CLOEXEC)), activo(true), esperasDescriptor(0),
+      secuenciaTemporizador(0) {}
+
+Planificador::~Planificador() {
+    for (size_t i = 0; i < tareas.size(); ++i) {
+        tareas[i].destroy();
+    }
+    close(epfd);
+}
+
+Planificador* Planificador::actual() {
+    return planificadorActual;
+}
+
+int64_t Planificador::ahoraMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void Planificador::lanzar(Tarea tarea) {
+    Tarea::Handle h = tarea.liberar();
+    if (!h) return;
+    tareas.push_back(h);
+    listos.push_back(h);
+}
+
+void Planificador::esperarDescriptor(EsperaDescriptor* espera) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = espera;
+    if (epoll_ctl(epfd, EPOLL_CTL_MOD, espera->fd, &ev) < 0 && errno == ENOENT) {
+        epoll_ctl(epfd, EPOLL_CTL_ADD, espera->fd, &ev);
+    }
+    ++esperasDescriptor;
+}
+
+void Planificador::esperarHasta(int64_t instanteMs, std::coroutine_handle<> h) {
+    Temporizador t;
+    t.instante = instanteMs;
+    t.orden = secuenciaTemporizador++;
+    t.handle = h;
+    temporizadores.push(t);
+}
+
+void Planificador::barrerTerminadas() {
+    size_t j = 0;
+    for (size_t i = 0; i < tareas.size(); ++i) {
+        if (tareas[i].done()) {
+            tareas[i].destroy();
+        } else {
+            tareas[j++] = tareas[i];
+        }
+    }
+    tareas.resize(j);
+}
+
+void Planificador::ejecutar() {
+    Planificador* anterior = planificadorActual;
+    planificadorActual = this;
+    activo = true;
+
+    epoll_event eventos[32];
+    while (activo && !tareas.empty()) {
+        // Reanudar las tareas listas de esta vuelta; las que se programen ahora esperan a la siguiente
+        std::deque<std::coroutine_handle<> > turno;
+        turno.swap(listos);
+        while (!turno.empty() && activo) {
+            std::coroutine_handle<> h = turno.front();
+            turno.pop_front();
+            h.resume();
+        }
+        barrerTerminadas();
+        if (!activo || tareas.empty()) break;
+
+        int timeout = -1;
+        int64_t ahora = ahoraMs();
+        if (!listos.empty()) {
+            timeout = 0;
+        } else if (!temporizadores.empty()) {
+            int64_t espera = temporizadores.top().instante - ahora;
+            timeout = espera > 0 ? static_cast<int>(espera) : 0;
+        } else if (esperasDescriptor == 0) {
+            break; // ninguna tarea puede avanzar
+        }
+
+        int n = epoll_wait(epfd, eventos, 32, timeout);
+        for (int i = 0; i < n; ++i) {
+            EsperaDescriptor* espera = static_cast<EsperaDescriptor*>(eventos[i].data.ptr);
+            --esperasDescriptor;
+            if (espera->alListo()) {
+                listos.push_back(espera->handle);
+            } else {
+                esperarDescriptor(espera);
+            }
+        }
+
+        ahora = ahoraMs();
+        while (!temporizadores.empty() && temporizadores.top().instante <= ahora) {
+            listos.push_back(temporizadores.top().handle);
+            temporizadores.pop();
+        }
+    }
+    planificadorActual = anterior;
+}
+
+void LectorLineas::llenar() {
+    char tmp[4096];
+    for (;;) {
+        ssize_t n = read(fd, tmp, sizeof(tmp));
+        if (n > 0) {
+            buffer.append(tmp, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) fin = true;
+        return;
+    }
+}
+
+bool LectorLineas::hayLinea() const {
+    for (size_t i = inicio; i < buffer.size(); ++i) {
+        if (buffer[i] == '\n' || buffer[i] == '\r') return true;
+    }
+    return fin && inicio < buffer.size();
+}
+
+bool LectorLineas::extraer(std::string& destino) {
+    for (;;) {
+        size_t i = inicio;
+        while (i < buffer.size() && buffer[i] != '\n' && buffer[i] != '\r') ++i;
+        if (i == buffer.size() && !(fin && i > inicio)) {
+            // Sin línea completa: compactar y, si es demasiado larga, descartarla
+            buffer.erase(0, inicio);
+            inicio = 0;
+            if (buffer.size() > 2048) buffer.clear();
+            return false;
+        }
+        size_t largo = i - inicio;
+        size_t desde = inicio;
+        inicio = i < buffer.size() ? i + 1 : i;
+        if (largo == 0) continue; // línea vacía (p. ej. "\r\n")
+        if (largo > 2048) continue;
+        destino.assign(buffer, desde, largo);
+        return true;
+    }
+}
+
+Tarea procesarLote(SistemaGestion& sistema, size_t porTurno) {
+    if (porTurno == 0) porTurno = 1;
+    std::vector<uint32_t> ids;
+    {
+        SistemaGestion::GuardiaLectura guardia(sistema);
+        sistema.paraCadaSensor([&ids](SensorBase* s) { ids.push_back(s->getIdInterno()); });
+    }
+
+    std::cout << "\n--- Ejecutando Polimorfismo (asincrono) ---\n";
+    for (size_t inicio = 0; inicio < ids.size(); inicio += porTurno) {
+        {
+            // La guardia dura un turno: se suelta antes de ceder
+            SistemaGestion::GuardiaLectura guardia(sistema);
+            size_t fin = std::min(ids.size(), inicio + porTurno);
+            for (size_t i = inicio; i < fin; ++i) {
+                SensorBase* s = sistema.buscarSensor(ids[i]);
+                if (s == nullptr) continue;
+                std::cout << "-> Procesando Sensor " << s->getId() << "...\n";
+                s->procesarLectura();
+            }
+        }
+        co_await ceder();
+    }
+}
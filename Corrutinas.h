@@ -0,0 +1,282 @@
+#ifndef CORRUTINAS_H
+#define CORRUTINAS_H
+
+/**
+ * @file Corrutinas.h
+ * @brief Capa asíncrona con corrutinas C++20 sobre un planificador de un solo hilo
+ *
+ * Permite escribir la ingesta serial, el procesamiento periódico y los
+ * reportes como tareas cooperativas: cada tarea suspende con co_await
+ * mientras espera un descriptor, un temporizador o su turno, y el
+ * planificador reanuda la siguiente sin crear hilos por dispositivo.
+ *
+ * Ejemplo:
+ * @code
+ * Tarea ingesta(SistemaGestion& sistema, int fd) {
+ *     LectorLineas lector(fd);
+ *     std::string linea;
+ *     while (co_await lector.leerLinea(linea)) {
+ *         // analizar y registrar la línea
+ *     }
+ * }
+ * @endcode
+ */
+
+#include "SensorSystem.h"
+#include <unistd.h>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <string>
+#include <vector>
+
+class Planificador;
+
+/**
+ * @brief Corrutina sin valor de retorno que arranca suspendida
+ *
+ * Puede lanzarse en un Planificador como tarea de primer nivel o esperarse con
+ * co_await desde otra tarea; en ese caso la tarea que espera se reanuda al
+ * terminar la hija.
+ */
+class Tarea {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuacion; ///< Tarea que espera a esta, si la hay
+
+        Tarea get_return_object() {
+            return Tarea(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct AlTerminar {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> c = h.promise().continuacion;
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        AlTerminar final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    explicit Tarea(Handle h) : handle(h) {}
+    Tarea(Tarea&& otra) noexcept : handle(otra.handle) { otra.handle = nullptr; }
+    Tarea(const Tarea&) = delete;
+    Tarea& operator=(const Tarea&) = delete;
+    ~Tarea() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const { return !handle || handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> quienEspera) {
+        handle.promise().continuacion = quienEspera;
+        return handle; // transferencia simétrica: arranca la hija de inmediato
+    }
+    void await_resume() {}
+
+    /// Cede la propiedad del handle (lo usa el planificador)
+    Handle liberar() {
+        Handle h = handle;
+        handle = nullptr;
+        return h;
+    }
+
+private:
+    Handle handle;
+};
+
+/**
+ * @brief Espera registrada sobre un descriptor
+ *
+ * El planificador llama a alListo() cada vez que el descriptor tiene datos;
+ * si devuelve false vuelve a vigilarlo sin reanudar la corrutina.
+ */
+struct EsperaDescriptor {
+    int fd;
+    std::coroutine_handle<> handle;
+
+    EsperaDescriptor() : fd(-1) {}
+    virtual ~EsperaDescriptor() {}
+    virtual bool alListo() = 0;
+};
+
+/**
+ * @brief Planificador cooperativo de un solo hilo basado en epoll
+ */
+class Planificador {
+public:
+    Planificador();
+    ~Planificador();
+
+    Planificador(const Planificador&) = delete;
+    Planificador& operator=(const Planificador&) = delete;
+
+    /// Añade una tarea de primer nivel; el planificador pasa a ser su dueño
+    void lanzar(Tarea tarea);
+
+    /// Ejecuta hasta que terminen todas las tareas o se llame a detener()
+    void ejecutar();
+
+    /// Termina ejecutar() tras la vuelta actual; las tareas pendientes se destruyen
+    void detener() { activo = false; }
+
+    /// Planificador que está ejecutando en este hilo (nullptr fuera de ejecutar())
+    static Planificador* actual();
+
+    /// Milisegundos de un reloj monotónico
+    static int64_t ahoraMs();
+
+    /// @name Interfaz para los awaitables
+    /// @{
+    void programar(std::coroutine_handle<> h) { listos.push_back(h); }
+    void esperarDescriptor(EsperaDescriptor* espera);
+    void esperarHasta(int64_t instanteMs, std::coroutine_handle<> h);
+    /// @}
+
+private:
+    struct Temporizador {
+        int64_t instante;
+        uint64_t orden;              ///< Desempate FIFO entre instantes iguales
+        std::coroutine_handle<> handle;
+        bool operator>(const Temporizador& o) const {
+            return instante != o.instante ? instante > o.instante : orden > o.orden;
+        }
+    };
+
+    int epfd;
+    bool activo;
+    int esperasDescriptor;           ///< Esperas de descriptor pendientes
+    uint64_t secuenciaTemporizador;
+    std::deque<std::coroutine_handle<> > listos;
+    std::priority_queue<Temporizador, std::vector<Temporizador>, std::greater<Temporizador> > temporizadores;
+    std::vector<Tarea::Handle> tareas;
+
+    void barrerTerminadas();
+};
+
+/**
+ * @brief Awaitable que reanuda la tarea tras una pausa
+ */
+struct Dormir {
+    int64_t milisegundos;
+    bool await_ready() const { return milisegundos <= 0; }
+    void await_suspend(std::coroutine_handle<> h) {
+        Planificador::actual()->esperarHasta(Planificador::ahoraMs() + milisegundos, h);
+    }
+    void await_resume() {}
+};
+
+/// Suspende la tarea actual durante ms milisegundos
+inline Dormir dormir(int64_t ms) { return Dormir{ms}; }
+
+/**
+ * @brief Awaitable que cede el turno a las demás tareas listas
+ */
+struct Ceder {
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> h) { Planificador::actual()->programar(h); }
+    void await_resume() {}
+};
+
+inline Ceder ceder() { return Ceder(); }
+
+/**
+ * @brief Lectura de líneas no bloqueante sobre un descriptor serial, pipe o pty
+ *
+ * El descriptor debe estar en modo O_NONBLOCK (abrirPuertoSerial() ya lo abre así).
+ * Aplica el mismo criterio que readLineFromSerial(): '\\n' y '\\r' terminan la
+ * línea, las líneas vacías se ignoran y las de más de 2048 caracteres se descartan.
+ */
+class LectorLineas {
+public:
+    explicit LectorLineas(int fd) : fd(fd), inicio(0), fin(false) {}
+
+    struct EsperaLinea : EsperaDescriptor {
+        LectorLineas* lector;
+        std::string* destino;
+
+        bool await_ready() { return lector->extraer(*destino); }
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            Planificador::actual()->esperarDescriptor(this);
+        }
+        /// @return false al llegar al fin de datos sin más líneas
+        bool await_resume() { return lector->extraer(*destino); }
+        bool alListo() override {
+            lector->llenar();
+            return lector->hayLinea() || lector->fin;
+        }
+    };
+
+    /**
+     * @brief Espera la siguiente línea
+     * @param destino Recibe la línea sin el salto
+     * @return Awaitable que produce false en fin de datos
+     */
+    EsperaLinea leerLinea(std::string& destino) {
+        EsperaLinea e;
+        e.fd = fd;
+        e.lector = this;
+        e.destino = &destino;
+        return e;
+    }
+
+    bool enFin() const { return fin && !hayLinea(); }
+
+private:
+    int fd;
+    std::string buffer;
+    size_t inicio;   ///< Primer carácter aún no entregado
+    bool fin;
+
+    void llenar();
+    bool hayLinea() const;
+    bool extraer(std::string& destino);
+};
+
+/**
+ * @brief Cierra un descriptor al destruirse
+ *
+ * Una tarea que se apropia de un descriptor lo recibe por valor con esta
+ * clase, así queda en su marco desde la llamada: si el planificador destruye
+ * la tarea sin terminarla (antes de arrancar o suspendida), el descriptor se
+ * cierra igual.
+ */
+class DescriptorPropio {
+public:
+    explicit DescriptorPropio(int fd) : fd(fd) {}
+    ~DescriptorPropio() {
+        if (fd >= 0) close(fd);
+    }
+    DescriptorPropio(DescriptorPropio&& otro) noexcept : fd(otro.fd) { otro.fd = -1; }
+    DescriptorPropio(const DescriptorPropio&) = delete;
+    DescriptorPropio& operator=(const DescriptorPropio&) = delete;
+
+    int get() const { return fd; }
+
+private:
+    int fd;
+};
+
+/**
+ * @brief Ejecuta procesarLectura() sobre todos los sensores cediendo el turno
+ * @param sistema Sistema a procesar
+ * @param porTurno Sensores procesados entre cesiones
+ *
+ * La GuardiaLectura no se mantiene a través de las cesiones: una tarea
+ * suspendida no debe bloquear a eliminarSensor() en otro hilo (ni, en el
+ * mismo hilo, provocar un bloqueo mutuo). Se recorren los handles tomados al
+ * empezar y cada turno vuelve a buscar sus sensores; los eliminados entre
+ * turnos se saltean.
+ */
+Tarea procesarLote(SistemaGestion& sistema, size_t porTurno);
+
+#endif
@@ -0,0 +1,69 @@
+#include "DetectorAnomalias.h"
+#include <cmath>
+
+const char* EventoAnomalia::nombreCausa() const {
+    switch (causa) {
+        case PICO: return "Pico";
+        case DERIVA_ALZA: return "Deriva al alza";
+        case DERIVA_BAJA: return "Deriva a la baja";
+    }
+    return "Desconocida";
+}
+
+double DetectorAnomalias::getDesviacion() const {
+    return std::sqrt(varianza);
+}
+
+bool DetectorAnomalias::evaluar(float valor, EventoAnomalia& evento) {
+    ++lecturas;
+    double x = valor;
+
+    if (lecturas == 1) {
+        media = x;
+        varianza = 0.0;
+        return false;
+    }
+
+    // Con un historial constante la varianza es 0: sin el piso, cualquier salto daría z = 0
+    double desviacion = std::fmax(std::sqrt(varianza), parametros.desviacionMinima);
+    double z = desviacion > 0.0 ? (x - media) / desviacion : 0.0;
+    bool anomalia = false;
+
+    if (lecturas > static_cast<uint64_t>(parametros.calentamiento)) {
+        evento.valor = valor;
+        evento.media = static_cast<float>(media);
+        evento.lectura = lecturas;
+
+        // El CUSUM acumula z recortado: un pico aislado no debe parecer una deriva
+        double zAcotado = std::fmax(-parametros.umbralZ, std::fmin(parametros.umbralZ, z));
+        cusumAlto = std::fmax(0.0, cusumAlto + zAcotado - parametros.cusumK);
+        cusumBajo = std::fmax(0.0, cusumBajo - zAcotado - parametros.cusumK);
+
+        if (std::fabs(z) > parametros.umbralZ) {
+            evento.causa = EventoAnomalia::PICO;
+            evento.puntaje = static_cast<float>(z);
+            anomalia = true;
+        } else if (cusumAlto > parametros.cusumH) {
+            evento.causa = EventoAnomalia::DERIVA_ALZA;
+            evento.puntaje = static_cast<float>(cusumAlto);
+            cusumAlto = 0.0;
+            anomalia = true;
+        } else if (cusumBajo > parametros.cusumH) {
+            evento.causa = EventoAnomalia::DERIVA_BAJA;
+            evento.puntaje = static_cast<float>(cusumBajo);
+            cusumBajo = 0.0;
+            anomalia = true;
+        }
+    }
+
+    // Actualizar la EWMA; un pico entra recortado a umbralZ para no arrastrar el modelo
+    if (std::fabs(z) > parametros.umbralZ) {
+        x = media + (z > 0 ? parametros.umbralZ : -parametros.umbralZ) * desviacion;
+    }
+    double diferencia = x - media;
+    double incremento = parametros.alfa * diferencia;
+    media += incremento;
+    varianza = (1.0 - parametros.alfa) * (varianza + diferencia * incremento);
+
+    return anomalia;
+}
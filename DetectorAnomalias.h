@@ -0,0 +1,88 @@
+#ifndef DETECTOR_ANOMALIAS_H
+#define DETECTOR_ANOMALIAS_H
+
+/**
+ * @file DetectorAnomalias.h
+ * @brief Detección de anomalías en línea, O(1) por lectura
+ *
+ * Cada sensor mantiene una media y una varianza con suavizado exponencial
+ * (EWMA). Con ellas se calcula el puntaje z de cada lectura para detectar
+ * picos aislados, y se acumula un CUSUM bilateral sobre el puntaje para
+ * detectar derivas lentas que un umbral fijo no vería. No se recorre nunca
+ * el historial: el estado por sensor son unos pocos números.
+ */
+
+#include <cstdint>
+
+/**
+ * @brief Anomalía detectada en una lectura
+ */
+struct EventoAnomalia {
+    /// Motivo del evento
+    enum Causa {
+        PICO,          ///< |z| superó el umbral en una sola lectura
+        DERIVA_ALZA,   ///< El CUSUM superior superó el límite
+        DERIVA_BAJA    ///< El CUSUM inferior superó el límite
+    };
+
+    uint32_t sensorId;   ///< Handle del sensor en TablaIds
+    char tipoSensor;     ///< 'T', 'P' o 'V'
+    Causa causa;
+    float valor;         ///< Lectura que disparó el evento
+    float media;         ///< Media EWMA antes de la lectura
+    float puntaje;       ///< Puntaje z de la lectura, o valor del CUSUM en las derivas
+    uint64_t lectura;    ///< Número de lectura del sensor (desde 1)
+
+    EventoAnomalia()
+        : sensorId(0xFFFFFFFFu), tipoSensor(0), causa(PICO), valor(0.0f), media(0.0f), puntaje(0.0f), lectura(0) {}
+
+    /// Nombre legible de la causa
+    const char* nombreCausa() const;
+};
+
+/**
+ * @brief Ajustes del detector
+ */
+struct ParametrosDeteccion {
+    double alfa;          ///< Peso de la lectura nueva en la EWMA (0-1)
+    double umbralZ;       ///< |z| a partir del cual una lectura es un pico
+    double cusumK;        ///< Holgura del CUSUM, en desviaciones estándar
+    double cusumH;        ///< Límite del CUSUM, en desviaciones estándar
+    int calentamiento;    ///< Lecturas iniciales que solo entrenan el modelo
+    double desviacionMinima; ///< Piso de la desviación: tras lecturas idénticas, un salto sigue dando z
+
+    ParametrosDeteccion()
+        : alfa(0.05), umbralZ(4.0), cusumK(0.5), cusumH(8.0), calentamiento(20), desviacionMinima(0.1) {}
+};
+
+/**
+ * @brief Estado de detección de un sensor
+ */
+class DetectorAnomalias {
+public:
+    DetectorAnomalias() : media(0.0), varianza(0.0), cusumAlto(0.0), cusumBajo(0.0), lecturas(0) {}
+
+    void setParametros(const ParametrosDeteccion& p) { parametros = p; }
+    const ParametrosDeteccion& getParametros() const { return parametros; }
+
+    /**
+     * @brief Evalúa una lectura y actualiza el modelo
+     * @param valor Lectura nueva
+     * @param evento Se completa (salvo id y tipo) si hay anomalía
+     * @return true si la lectura es anómala
+     */
+    bool evaluar(float valor, EventoAnomalia& evento);
+
+    double getMedia() const { return media; }
+    double getDesviacion() const;
+
+private:
+    ParametrosDeteccion parametros;
+    double media;
+    double varianza;
+    double cusumAlto;
+    double cusumBajo;
+    uint64_t lecturas;
+};
+
+#endif
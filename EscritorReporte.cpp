@@ -0,0 +1,175 @@
+#include "EscritorReporte.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+
+EscritorReporte::EscritorReporte(size_t capacidadInicial)
+    : buffer(capacidadInicial > 0 ? capacidadInicial : 1), usado(0), formato(REPORTE_TEXTO), filas(0) {}
+
+char* EscritorReporte::reservar(size_t n) {
+    if (usado + n > buffer.size()) {
+        size_t nuevo = buffer.size() * 2;
+        if (nuevo < usado + n) nuevo = usado + n;
+        buffer.resize(nuevo);
+    }
+    return buffer.data() + usado;
+}
+
+void EscritorReporte::texto(const char* s) {
+    size_t n = std::strlen(s);
+    std::memcpy(reservar(n), s, n);
+    usado += n;
+}
+
+void EscritorReporte::caracter(char c) {
+    *reservar(1) = c;
+    ++usado;
+}
+
+void EscritorReporte::entero(unsigned long long valor) {
+    char* inicio = reservar(24);
+    std::to_chars_result r = std::to_chars(inicio, inicio + 24, valor);
+    usado += static_cast<size_t>(r.ptr - inicio);
+}
+
+void EscritorReporte::flotante(float valor) {
+    if (formato == REPORTE_JSON && !std::isfinite(valor)) {
+        texto("null");
+        return;
+    }
+    // Formato general con 6 cifras: el mismo que std::cout por defecto
+    char* inicio = reservar(32);
+    std::to_chars_result r = std::to_chars(inicio, inicio + 32, valor, std::chars_format::general, 6);
+    usado += static_cast<size_t>(r.ptr - inicio);
+}
+
+void EscritorReporte::cadenaJson(const char* s) {
+    caracter('"');
+    for (; *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            caracter('\\');
+            caracter(static_cast<char>(c));
+        } else if (c < 0x20) {
+            char* p = reservar(7);
+            std::snprintf(p, 7, "\\u%04x", c);
+            usado += 6;
+        } else {
+            caracter(static_cast<char>(c));
+        }
+    }
+    caracter('"');
+}
+
+void EscritorReporte::comenzar(FormatoReporte f) {
+    formato = f;
+    usado = 0;
+    filas = 0;
+    if (formato == REPORTE_CSV) {
+        texto("id,tipo,lecturas,promedio,p50,p95,p99,saturadas\n");
+    } else if (formato == REPORTE_JSON) {
+        caracter('[');
+    }
+}
+
+void EscritorReporte::agregar(const ResumenSensor& r) {
+    if (formato == REPORTE_TEXTO) {
+        const char* nombre = r.tipo == 'T' ? "Temperatura" : (r.tipo == 'P' ? "Presion" : "Vibracion");
+        caracter('[');
+        caracter(r.tipo);
+        texto("-INFO ");
+        texto(r.id);
+        texto("] Tipo: ");
+        texto(nombre);
+        texto(", Lecturas: ");
+        entero(r.lecturas);
+        texto(", Promedio: ");
+        flotante(r.promedio);
+        texto(", p50: ");
+        flotante(r.p50);
+        texto(", p95: ");
+        flotante(r.p95);
+        texto(", p99: ");
+        flotante(r.p99);
+        caracter('\n');
+        // El mismo aviso que imprimirInfo()
+        if (r.saturadas > 0) {
+            texto("  [WARN] ");
+            entero(r.saturadas);
+            texto(" lecturas fuera de rango guardadas recortadas\n");
+        }
+    } else if (formato == REPORTE_CSV) {
+        // Los ids no llevan comas ni comillas en este sistema, pero por si acaso
+        bool comillas = std::strpbrk(r.id, ",\"\n") != nullptr;
+        if (comillas) {
+            caracter('"');
+            for (const char* s = r.id; *s; ++s) {
+                if (*s == '"') caracter('"');
+                caracter(*s);
+            }
+            caracter('"');
+        } else {
+            texto(r.id);
+        }
+        caracter(',');
+        caracter(r.tipo);
+        caracter(',');
+        entero(r.lecturas);
+        caracter(',');
+        flotante(r.promedio);
+        caracter(',');
+        flotante(r.p50);
+        caracter(',');
+        flotante(r.p95);
+        caracter(',');
+        flotante(r.p99);
+        caracter(',');
+        entero(r.saturadas);
+        caracter('\n');
+    } else {
+        if (filas > 0) caracter(',');
+        texto("\n  {\"id\":");
+        cadenaJson(r.id);
+        texto(",\"tipo\":\"");
+        caracter(r.tipo);
+        texto("\",\"lecturas\":");
+        entero(r.lecturas);
+        texto(",\"promedio\":");
+        flotante(r.promedio);
+        texto(",\"p50\":");
+        flotante(r.p50);
+        texto(",\"p95\":");
+        flotante(r.p95);
+        texto(",\"p99\":");
+        flotante(r.p99);
+        texto(",\"saturadas\":");
+        entero(r.saturadas);
+        caracter('}');
+    }
+    ++filas;
+}
+
+void EscritorReporte::terminar() {
+    if (formato == REPORTE_JSON) texto(filas > 0 ? "\n]\n" : "]\n");
+}
+
+bool EscritorReporte::volcar(int fd) {
+    if (fd == STDOUT_FILENO) {
+        std::cout.flush();
+        std::fflush(stdout);
+    }
+    size_t escrito = 0;
+    while (escrito < usado) {
+        ssize_t n = write(fd, buffer.data() + escrito, usado - escrito);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        escrito += static_cast<size_t>(n);
+    }
+    return true;
+}
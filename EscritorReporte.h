@@ -0,0 +1,81 @@
+#ifndef ESCRITOR_REPORTE_H
+#define ESCRITOR_REPORTE_H
+
+/**
+ * @file EscritorReporte.h
+ * @brief Reporte de sensores formateado en un búfer reutilizable
+ *
+ * Sustituye los muchos operator<< por sensor de imprimirInfo(): cada fila se
+ * formatea con std::to_chars en un búfer que se conserva entre reportes y el
+ * reporte completo se emite con una sola llamada a write(). Texto, CSV y
+ * JSON siguen el mismo camino; una vez que el búfer alcanzó el tamaño del
+ * reporte, generar otro no reserva memoria.
+ */
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Datos de un sensor para una fila del reporte
+ */
+struct ResumenSensor {
+    const char* id;      ///< Identificador (válido mientras dure la GuardiaLectura)
+    char tipo;           ///< 'T', 'P' o 'V'
+    size_t lecturas;     ///< Lecturas en el historial
+    float promedio;      ///< Promedio del historial
+    float p50;           ///< Mediana aproximada de todas las lecturas
+    float p95;
+    float p99;
+    unsigned long saturadas;  ///< Lecturas recortadas al rango del historial
+};
+
+/// Formatos de salida del reporte
+enum FormatoReporte {
+    REPORTE_TEXTO,   ///< Mismo formato que imprimirInfo()
+    REPORTE_CSV,     ///< Cabecera y una fila por sensor
+    REPORTE_JSON     ///< Arreglo de objetos
+};
+
+/**
+ * @brief Acumula un reporte y lo escribe de una vez en un descriptor
+ */
+class EscritorReporte {
+public:
+    explicit EscritorReporte(size_t capacidadInicial = 64 * 1024);
+
+    /// Descarta lo acumulado y escribe la cabecera del formato
+    void comenzar(FormatoReporte formato);
+
+    /// Agrega la fila de un sensor
+    void agregar(const ResumenSensor& resumen);
+
+    /// Cierra el formato (p. ej. el ']' de JSON)
+    void terminar();
+
+    /**
+     * @brief Escribe todo lo acumulado en fd con una sola llamada a write()
+     *
+     * Si fd es la salida estándar, vacía antes std::cout para no desordenar
+     * la salida. Reintenta escrituras parciales.
+     * @return true si se escribió todo
+     */
+    bool volcar(int fd);
+
+    const char* getDatos() const { return buffer.data(); }
+    size_t getLongitud() const { return usado; }
+
+private:
+    std::vector<char> buffer;
+    size_t usado;
+    FormatoReporte formato;
+    size_t filas;
+
+    char* reservar(size_t n);
+    void texto(const char* s);
+    void caracter(char c);
+    void entero(unsigned long long valor);
+    void flotante(float valor);
+    void cadenaJson(const char* s);
+};
+
+#endif
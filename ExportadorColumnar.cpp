@@ -0,0 +1,149 @@
+#include "ExportadorColumnar.h"
+#include "SensorSystem.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+ExportadorColumnar::ExportadorColumnar(int fdSalida, size_t filasPorBloque, size_t tamanoBuffer)
+    : fd(fdSalida), error(false), escritos(0),
+      capacidadBloque(filasPorBloque > 0 ? filasPorBloque : 1), filas(0), nFlotantes(0), nEnteros(0),
+      columnaIds(capacidadBloque), columnaTipos(capacidadBloque),
+      columnaFlotantes(capacidadBloque), columnaEnteros(capacidadBloque),
+      codigoActual(0), tipoActual(0),
+      buffer(tamanoBuffer > 0 ? tamanoBuffer : 1), usado(0) {
+    std::memset(&meta, 0, sizeof(meta));
+    std::memset(&estadisticas, 0, sizeof(estadisticas));
+}
+
+void ExportadorColumnar::vaciarBuffer() {
+    size_t enviado = 0;
+    while (enviado < usado && !error) {
+        ssize_t n = write(fd, buffer.data() + enviado, usado - enviado);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = true;
+            break;
+        }
+        enviado += static_cast<size_t>(n);
+    }
+    usado = 0;
+}
+
+void ExportadorColumnar::emitir(const void* datos, size_t n) {
+    const char* p = static_cast<const char*>(datos);
+    escritos += n;
+    while (n > 0) {
+        if (usado == buffer.size()) vaciarBuffer();
+        size_t cabe = buffer.size() - usado;
+        size_t parte = n < cabe ? n : cabe;
+        std::memcpy(buffer.data() + usado, p, parte);
+        usado += parte;
+        p += parte;
+        n -= parte;
+    }
+}
+
+void ExportadorColumnar::cerrarBloque() {
+    if (filas == 0) return;
+    meta.desplazamiento = escritos;
+    meta.filas = static_cast<uint32_t>(filas);
+    meta.nFlotantes = static_cast<uint32_t>(nFlotantes);
+    meta.nEnteros = static_cast<uint32_t>(nEnteros);
+    uint32_t cabecera[3] = {static_cast<uint32_t>(filas), static_cast<uint32_t>(nFlotantes),
+                            static_cast<uint32_t>(nEnteros)};
+    emitir(cabecera, sizeof(cabecera));
+    emitir(columnaIds.data(), filas * sizeof(uint32_t));
+    emitir(columnaTipos.data(), filas * sizeof(uint8_t));
+    emitir(columnaFlotantes.data(), nFlotantes * sizeof(float));
+    emitir(columnaEnteros.data(), nEnteros * sizeof(int32_t));
+    bloques.push_back(meta);
+
+    estadisticas.filas += filas;
+    filas = nFlotantes = nEnteros = 0;
+    std::memset(&meta, 0, sizeof(meta));
+}
+
+void ExportadorColumnar::comenzarSensor(const char* id, char tipo, int) {
+    // Recortarlo lo confundiría con otro id: mejor fallar
+    if (std::strlen(id) > kLargoMaximoId) error = true;
+    EntradaDiccionario entrada;
+    entrada.id = id;
+    entrada.tipo = tipo;
+    codigoActual = static_cast<uint32_t>(diccionario.size());
+    tipoActual = static_cast<uint8_t>(tipo);
+    diccionario.push_back(entrada);
+}
+
+void ExportadorColumnar::visitar(float valor) {
+    if (filas == capacidadBloque) cerrarBloque();
+    if (nFlotantes == 0 || valor < meta.minF) meta.minF = valor;
+    if (nFlotantes == 0 || valor > meta.maxF) meta.maxF = valor;
+    columnaIds[filas] = codigoActual;
+    columnaTipos[filas] = tipoActual;
+    columnaFlotantes[nFlotantes++] = valor;
+    ++filas;
+}
+
+void ExportadorColumnar::visitar(int valor) {
+    if (filas == capacidadBloque) cerrarBloque();
+    if (nEnteros == 0 || valor < meta.minI) meta.minI = valor;
+    if (nEnteros == 0 || valor > meta.maxI) meta.maxI = valor;
+    columnaIds[filas] = codigoActual;
+    columnaTipos[filas] = tipoActual;
+    columnaEnteros[nEnteros++] = valor;
+    ++filas;
+}
+
+void ExportadorColumnar::escribirPie() {
+    uint64_t desplazamientoPie = escritos;
+
+    uint32_t nSensores = static_cast<uint32_t>(diccionario.size());
+    emitir(&nSensores, sizeof(nSensores));
+    for (size_t i = 0; i < diccionario.size(); ++i) {
+        uint8_t tipo = static_cast<uint8_t>(diccionario[i].tipo);
+        size_t largo = diccionario[i].id.size() > kLargoMaximoId ? kLargoMaximoId : diccionario[i].id.size();
+        uint16_t largo16 = static_cast<uint16_t>(largo);
+        emitir(&tipo, 1);
+        emitir(&largo16, sizeof(largo16));
+        emitir(diccionario[i].id.data(), largo);
+    }
+
+    uint32_t nBloques = static_cast<uint32_t>(bloques.size());
+    emitir(&nBloques, sizeof(nBloques));
+    for (size_t i = 0; i < bloques.size(); ++i) {
+        const MetaBloque& b = bloques[i];
+        emitir(&b.desplazamiento, sizeof(b.desplazamiento));
+        emitir(&b.filas, sizeof(b.filas));
+        emitir(&b.nFlotantes, sizeof(b.nFlotantes));
+        emitir(&b.nEnteros, sizeof(b.nEnteros));
+        emitir(&b.minF, sizeof(b.minF));
+        emitir(&b.maxF, sizeof(b.maxF));
+        emitir(&b.minI, sizeof(b.minI));
+        emitir(&b.maxI, sizeof(b.maxI));
+    }
+
+    emitir(&desplazamientoPie, sizeof(desplazamientoPie));
+    emitir("SCOL", 4);
+}
+
+bool ExportadorColumnar::exportar(const SistemaGestion& sistema) {
+    InstantaneaSistema foto = sistema.tomarInstantanea();
+    return exportar(foto);
+}
+
+bool ExportadorColumnar::exportar(const InstantaneaSistema& foto) {
+    emitir("SCOL", 4);
+    uint32_t version = kVersion;
+    emitir(&version, sizeof(version));
+
+    foto.paraCadaSensor([this](const InstantaneaSensor& s) { s.recorrerHistorial(*this); });
+
+    cerrarBloque();
+    escribirPie();
+    vaciarBuffer();
+
+    estadisticas.sensores = static_cast<uint32_t>(diccionario.size());
+    estadisticas.bloques = static_cast<uint32_t>(bloques.size());
+    estadisticas.bytes = escritos;
+    return !error;
+}
@@ -0,0 +1,130 @@
+#ifndef EXPORTADOR_COLUMNAR_H
+#define EXPORTADOR_COLUMNAR_H
+
+/**
+ * @file ExportadorColumnar.h
+ * @brief Exportación de los historiales completos en un archivo columnar
+ *
+ * Formato (little-endian, tal como lo escribe la máquina):
+ *
+ *     "SCOL" u32 version
+ *     bloque*            u32 filas, u32 nFlotantes, u32 nEnteros,
+ *                        u32 idSensor[filas], u8 tipo[filas],
+ *                        f32 flotante[nFlotantes], i32 entero[nEnteros]
+ *     pie                u32 nSensores, { u8 tipo, u16 largo, char id[largo] }*
+ *                        u32 nBloques, { u64 desplazamiento, u32 filas,
+ *                                        u32 nFlotantes, u32 nEnteros,
+ *                                        f32 minF, f32 maxF, i32 minI, i32 maxI }*
+ *     u64 desplazamientoPie, "SCOL"
+ *
+ * Los ids se codifican con un diccionario (índice en el pie) y los valores
+ * van en columnas tipadas: las filas de temperatura consumen la columna de
+ * flotantes y las de presión y vibración la de enteros, en orden. El pie
+ * guarda mínimo y máximo de cada bloque para que un lector pueda saltar
+ * bloques sin leerlos; el mínimo y el máximo de una columna solo valen si
+ * su cantidad en el bloque (nFlotantes, nEnteros) no es cero. Un id de más
+ * de 65535 bytes no puede guardarse y hace fallar la exportación.
+ *
+ * El exportador solo retiene un bloque de filas y un búfer de salida de
+ * tamaño fijo; lo único que crece es el pie (una entrada por sensor y otra
+ * por bloque), nunca una copia de los historiales.
+ */
+
+#include "VisitanteHistorial.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SistemaGestion;
+class InstantaneaSistema;
+
+/**
+ * @brief Totales de una exportación
+ */
+struct EstadisticasExportacion {
+    uint64_t filas;      ///< Lecturas escritas
+    uint32_t sensores;   ///< Entradas del diccionario
+    uint32_t bloques;    ///< Bloques escritos
+    uint64_t bytes;      ///< Tamaño del archivo
+};
+
+/**
+ * @brief Escritor del formato columnar, alimentado por recorrerHistorial()
+ */
+class ExportadorColumnar : public VisitanteHistorial {
+public:
+    static const uint32_t kVersion = 2;
+    static const size_t kLargoMaximoId = 0xFFFF;   ///< Cabe en el u16 del diccionario
+
+    /**
+     * @param fd Descriptor de salida (no se cierra)
+     * @param filasPorBloque Filas por bloque
+     * @param tamanoBuffer Bytes del búfer de salida
+     */
+    explicit ExportadorColumnar(int fd, size_t filasPorBloque = 4096, size_t tamanoBuffer = 64 * 1024);
+
+    /**
+     * @brief Exporta todos los sensores del sistema
+     *
+     * Toma una instantánea y exporta desde ella, así que ningún sensor queda
+     * bloqueado mientras se escribe en disco.
+     * @return true si todo se escribió sin error
+     */
+    bool exportar(const SistemaGestion& sistema);
+
+    /// Exporta una instantánea ya tomada
+    bool exportar(const InstantaneaSistema& foto);
+
+    const EstadisticasExportacion& getEstadisticas() const { return estadisticas; }
+
+    void comenzarSensor(const char* id, char tipo, int cantidad) override;
+    void visitar(float valor) override;
+    void visitar(int valor) override;
+
+private:
+    struct EntradaDiccionario {
+        std::string id;
+        char tipo;
+    };
+
+    struct MetaBloque {
+        uint64_t desplazamiento;
+        uint32_t filas;
+        uint32_t nFlotantes, nEnteros;   ///< Sin valores de una columna, su mínimo y máximo no valen
+        float minF, maxF;
+        int32_t minI, maxI;
+    };
+
+    int fd;
+    bool error;
+    uint64_t escritos;              ///< Bytes ya enviados al descriptor o al búfer
+
+    // Bloque en construcción: columnas de capacidad fija
+    size_t capacidadBloque;
+    size_t filas;
+    size_t nFlotantes;
+    size_t nEnteros;
+    std::vector<uint32_t> columnaIds;
+    std::vector<uint8_t> columnaTipos;
+    std::vector<float> columnaFlotantes;
+    std::vector<int32_t> columnaEnteros;
+    MetaBloque meta;
+
+    uint32_t codigoActual;
+    uint8_t tipoActual;
+
+    std::vector<char> buffer;
+    size_t usado;
+
+    std::vector<EntradaDiccionario> diccionario;
+    std::vector<MetaBloque> bloques;
+    EstadisticasExportacion estadisticas;
+
+    void emitir(const void* datos, size_t n);
+    void vaciarBuffer();
+    void cerrarBloque();
+    void escribirPie();
+};
+
+#endif
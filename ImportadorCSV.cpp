@@ -0,0 +1,199 @@
+#include "ImportadorCSV.h"
+#include "Ingesta.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/// Registro analizado cuyo id apunta dentro del archivo mapeado
+struct RegistroMapeado {
+    const char* id;
+    uint32_t largoId;
+    char tipo;
+    float valor;
+};
+
+typedef std::unordered_map<std::string_view, SensorBase*> IndiceSensores;
+
+/// Estado de un trozo de la ventana durante la fase de análisis
+struct TrozoVentana {
+    const char* inicio;
+    const char* fin;
+    std::vector<std::vector<RegistroMapeado> > cubetas;  ///< Una por hilo de aplicación
+    uint64_t lineas;
+    uint64_t invalidas;
+};
+
+/// Estado de una cubeta durante la fase de aplicación (persiste entre ventanas)
+struct CubetaAplicacion {
+    IndiceSensores cache;
+    uint64_t aplicadas;
+    uint64_t creados;
+    uint64_t rechazadas;
+};
+
+static const char* siguienteLinea(const char* p, const char* fin) {
+    const char* salto = static_cast<const char*>(memchr(p, '\n', fin - p));
+    return salto ? salto + 1 : fin;
+}
+
+static void analizarTrozo(TrozoVentana& trozo) {
+    size_t nCubetas = trozo.cubetas.size();
+    const char* p = trozo.inicio;
+    while (p < trozo.fin) {
+        const char* salto = static_cast<const char*>(memchr(p, '\n', trozo.fin - p));
+        const char* finLinea = salto ? salto : trozo.fin;
+        const char* siguiente = salto ? salto + 1 : trozo.fin;
+        if (finLinea > p && finLinea[-1] == '\r') --finLinea;
+        if (finLinea > p) {
+            ++trozo.lineas;
+            CamposLinea campos;
+            if (parsearCampos(p, static_cast<size_t>(finLinea - p), campos) == PARSEO_OK) {
+                RegistroMapeado r = {campos.id, static_cast<uint32_t>(campos.largoId), campos.tipo, campos.valor};
+                trozo.cubetas[hashId(campos.id, campos.largoId) % nCubetas].push_back(r);
+            } else {
+                ++trozo.invalidas;
+            }
+        }
+        p = siguiente;
+    }
+}
+
+static void aplicarCubeta(SistemaGestion& sistema, const IndiceSensores& indice,
+                          std::vector<TrozoVentana>& trozos, size_t cubeta, CubetaAplicacion& estado) {
+    for (size_t t = 0; t < trozos.size(); ++t) {
+        const std::vector<RegistroMapeado>& registros = trozos[t].cubetas[cubeta];
+        for (size_t i = 0; i < registros.size(); ++i) {
+            const RegistroMapeado& r = registros[i];
+            std::string_view id(r.id, r.largoId);
+            IndiceSensores::iterator it = estado.cache.find(id);
+            SensorBase* sensor = nullptr;
+            if (it != estado.cache.end()) {
+                sensor = it->second;
+            } else {
+                IndiceSensores::const_iterator existente = indice.find(id);
+                if (existente != indice.end()) {
+                    sensor = existente->second;
+                } else {
+                    // Solo esta cubeta ve este id: nadie más puede estar creándolo
+                    std::string copia(id);
+                    sensor = crearSensor(r.tipo, copia.c_str());
+                    if (sensor) {
+                        sistema.agregarSensor(sensor);
+                        ++estado.creados;
+                    }
+                }
+                estado.cache[id] = sensor;
+            }
+            if (sensor) {
+                sensor->registrarLectura(r.valor);
+                ++estado.aplicadas;
+            } else {
+                ++estado.rechazadas;
+            }
+        }
+    }
+}
+
+ImportadorCSV::ImportadorCSV(SistemaGestion& s, int hilosParam, size_t bytesVentana)
+    : sistema(s), hilos(hilosParam), bytesPorVentana(bytesVentana < 4096 ? 4096 : bytesVentana) {
+    if (hilos <= 0) hilos = static_cast<int>(std::thread::hardware_concurrency());
+    if (hilos <= 0) hilos = 1;
+}
+
+bool ImportadorCSV::importar(const char* ruta, EstadisticasImportacion& e) {
+    std::memset(&e, 0, sizeof(e));
+    std::chrono::steady_clock::time_point comienzo = std::chrono::steady_clock::now();
+
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    e.bytes = static_cast<uint64_t>(st.st_size);
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void* mapa = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) return false;
+    madvise(mapa, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    const char* datos = static_cast<const char*>(mapa);
+    const char* finArchivo = datos + st.st_size;
+    size_t n = static_cast<size_t>(hilos);
+
+    bool logPrevio = logDetallado.exchange(false);
+    {
+        // Los sensores del índice y de las cachés no pueden liberarse durante la importación
+        SistemaGestion::GuardiaLectura guardia(sistema);
+        IndiceSensores indice;
+        sistema.paraCadaSensor([&indice](SensorBase* s) { indice[s->getId()] = s; });
+
+        std::vector<TrozoVentana> trozos(n);
+        for (size_t t = 0; t < n; ++t) trozos[t].cubetas.resize(n);
+        std::vector<CubetaAplicacion> cubetas(n);
+        for (size_t c = 0; c < n; ++c) cubetas[c].aplicadas = cubetas[c].creados = cubetas[c].rechazadas = 0;
+
+        const char* ventana = datos;
+        while (ventana < finArchivo) {
+            size_t resto = static_cast<size_t>(finArchivo - ventana);
+            const char* finVentana = resto <= bytesPorVentana
+                ? finArchivo : siguienteLinea(ventana + bytesPorVentana, finArchivo);
+
+            // Fase 1: cortar en límites de línea y analizar en paralelo
+            size_t porTrozo = static_cast<size_t>(finVentana - ventana) / n + 1;
+            const char* p = ventana;
+            for (size_t t = 0; t < n; ++t) {
+                trozos[t].inicio = p;
+                if (t + 1 == n || static_cast<size_t>(finVentana - p) <= porTrozo) {
+                    p = finVentana;
+                } else {
+                    p = siguienteLinea(p + porTrozo, finVentana);
+                }
+                trozos[t].fin = p;
+                trozos[t].lineas = trozos[t].invalidas = 0;
+                for (size_t c = 0; c < n; ++c) trozos[t].cubetas[c].clear();
+            }
+            std::vector<std::thread> trabajadores;
+            for (size_t t = 1; t < n; ++t) trabajadores.push_back(std::thread(analizarTrozo, std::ref(trozos[t])));
+            analizarTrozo(trozos[0]);
+            for (size_t i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+            trabajadores.clear();
+            for (size_t t = 0; t < n; ++t) {
+                e.lineas += trozos[t].lineas;
+                e.invalidas += trozos[t].invalidas;
+            }
+
+            // Fase 2: cada cubeta en su hilo, recorriendo los trozos en orden de archivo
+            for (size_t c = 1; c < n; ++c) {
+                trabajadores.push_back(std::thread(aplicarCubeta, std::ref(sistema), std::cref(indice),
+                                                   std::ref(trozos), c, std::ref(cubetas[c])));
+            }
+            aplicarCubeta(sistema, indice, trozos, 0, cubetas[0]);
+            for (size_t i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+
+            ventana = finVentana;
+        }
+
+        for (size_t c = 0; c < n; ++c) {
+            e.aplicadas += cubetas[c].aplicadas;
+            e.creados += cubetas[c].creados;
+            e.invalidas += cubetas[c].rechazadas;
+        }
+    }
+    logDetallado.store(logPrevio);
+
+    munmap(mapa, static_cast<size_t>(st.st_size));
+    e.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - comienzo).count();
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef IMPORTADOR_CSV_H
+#define IMPORTADOR_CSV_H
+
+/**
+ * @file ImportadorCSV.h
+ * @brief Importación en paralelo de capturas "T,T-001,27.8" desde archivo
+ *
+ * El archivo se mapea en memoria y se procesa por ventanas. En cada ventana
+ * se corre en dos fases:
+ *  1. Análisis: la ventana se corta en trozos en límites de línea y cada
+ *     hilo analiza el suyo sin copiar texto, repartiendo los registros en
+ *     cubetas según el hash del id.
+ *  2. Aplicación: cada hilo toma una cubeta y registra sus lecturas
+ *     recorriendo los trozos en orden de archivo.
+ * Como un mismo id cae siempre en la misma cubeta, cada sensor recibe sus
+ * lecturas en el orden del archivo y ningún par de hilos escribe en el
+ * mismo sensor. Los sensores que no existen se crean, como en la opción 8.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+class SistemaGestion;
+
+/**
+ * @brief Totales de una importación
+ */
+struct EstadisticasImportacion {
+    uint64_t bytes;          ///< Tamaño del archivo
+    uint64_t lineas;         ///< Líneas no vacías
+    uint64_t invalidas;      ///< Líneas descartadas por formato o valor
+    uint64_t aplicadas;      ///< Lecturas registradas
+    uint64_t creados;        ///< Sensores creados durante la importación
+    double segundos;         ///< Tiempo de pared
+};
+
+/**
+ * @brief Importador de capturas CSV mapeadas en memoria
+ */
+class ImportadorCSV {
+public:
+    /**
+     * @param sistema Sistema destino
+     * @param hilos Hilos de análisis y aplicación (0 = los del equipo)
+     * @param bytesPorVentana Tamaño de la porción del archivo que se procesa por vez
+     */
+    ImportadorCSV(SistemaGestion& sistema, int hilos = 0, size_t bytesPorVentana = 64 * 1024 * 1024);
+
+    /**
+     * @brief Importa un archivo completo
+     * @param ruta Archivo de captura
+     * @param estadisticas Totales (se completan también si hay error a mitad)
+     * @return false si el archivo no pudo abrirse o mapearse
+     */
+    bool importar(const char* ruta, EstadisticasImportacion& estadisticas);
+
+private:
+    SistemaGestion& sistema;
+    int hilos;
+    size_t bytesPorVentana;
+};
+
+#endif
@@ -0,0 +1,309 @@
+#include "Ingesta.h"
+#include "Trazas.h"
+#include "Afinidad.h"
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+
+ResultadoParseo parsearCampos(const char* linea, size_t longitud, CamposLinea& campos) {
+    // Espera "T,T-001,27.8" ó "P,P-105,81" ó "V,V-001,15"
+    const char* fin = linea + longitud;
+    const char* p1 = static_cast<const char*>(memchr(linea, ',', longitud));
+    if (p1 == nullptr) return PARSEO_FORMATO_INVALIDO;
+    const char* p2 = static_cast<const char*>(memchr(p1 + 1, ',', fin - (p1 + 1)));
+    if (p2 == nullptr || p1 != linea + 1 || p2 == p1 + 1 || p2 + 1 == fin) {
+        return PARSEO_FORMATO_INVALIDO;
+    }
+    char tipo = static_cast<char>(std::toupper(static_cast<unsigned char>(linea[0])));
+    if (tipo != 'T' && tipo != 'P' && tipo != 'V') return PARSEO_TIPO_INVALIDO;
+
+    // Igual que strtof: se admiten espacios y '+' delante y basura detrás ("27.8\r")
+    const char* inicioValor = p2 + 1;
+    while (inicioValor < fin && (*inicioValor == ' ' || *inicioValor == '\t')) ++inicioValor;
+    if (inicioValor < fin && *inicioValor == '+') ++inicioValor;
+    float valor = 0.0f;
+    std::from_chars_result r = std::from_chars(inicioValor, fin, valor);
+    if (r.ec != std::errc() || r.ptr == inicioValor) return PARSEO_VALOR_INVALIDO;
+
+    campos.tipo = tipo;
+    campos.id = p1 + 1;
+    campos.largoId = static_cast<size_t>(p2 - (p1 + 1));
+    campos.valor = valor;
+    return PARSEO_OK;
+}
+
+ResultadoParseo parsearLinea(const char* linea, size_t longitud, RegistroLectura& registro) {
+    CamposLinea campos;
+    ResultadoParseo resultado = parsearCampos(linea, longitud, campos);
+    if (resultado != PARSEO_OK) return resultado;
+    registro.tipo = campos.tipo;
+    registro.id = TablaIds::global().internar(campos.id, campos.largoId);
+    registro.valor = campos.valor;
+    return registro.id != TablaIds::kInvalido ? PARSEO_OK : PARSEO_FORMATO_INVALIDO;
+}
+
+ResultadoParseo parsearLinea(const char* linea, size_t longitud, RegistroLectura& registro, CupoIds& cupo) {
+    CamposLinea campos;
+    ResultadoParseo resultado = parsearCampos(linea, longitud, campos);
+    if (resultado != PARSEO_OK) return resultado;
+    uint32_t id = TablaIds::global().buscar(campos.id, campos.largoId);
+    if (id == TablaIds::kInvalido) {
+        if (cupo.restantes == 0) {
+            ++cupo.rechazados;
+            return PARSEO_ID_RECHAZADO;
+        }
+        id = TablaIds::global().internar(campos.id, campos.largoId);
+        if (id == TablaIds::kInvalido) return PARSEO_FORMATO_INVALIDO;
+        --cupo.restantes;
+    }
+    registro.tipo = campos.tipo;
+    registro.id = id;
+    registro.valor = campos.valor;
+    return PARSEO_OK;
+}
+
+SensorBase* crearSensor(char tipo, const char* id) {
+    if (tipo == 'T' || tipo == 't') return new SensorTemperatura(id);
+    if (tipo == 'P' || tipo == 'p') return new SensorPresion(id);
+    if (tipo == 'V' || tipo == 'v') return new SensorVibracion(id);
+    return nullptr;
+}
+
+SensorBase* aplicarRegistro(SistemaGestion& sistema, const RegistroLectura& registro) {
+    SensorBase* sensor = sistema.buscarSensor(registro.id);
+    if (sensor && sensor->getTipo() != registro.tipo) {
+        if (logActivo()) {
+            std::cout << "[WARN] Lectura de tipo " << registro.tipo << " para '" << sensor->getId()
+                      << "', que es de tipo " << sensor->getTipo() << ". Descartada.\n";
+        }
+        return nullptr;
+    }
+    if (!sensor) {
+        const char* id = TablaIds::global().texto(registro.id);
+        std::cout << "[WARN] Sensor '" << id << "' no existe. Creandolo...\n";
+        SensorBase* nuevo = crearSensor(registro.tipo, id);
+        if (nuevo) {
+            sistema.agregarSensor(nuevo);
+            sensor = nuevo;
+        }
+    }
+    if (sensor) {
+        sensor->registrarLectura(registro.valor);
+    }
+    return sensor;
+}
+
+uint32_t hashId(const char* id, size_t longitud) {
+    return TablaIds::calcularHash(id, longitud);
+}
+
+MotorIngesta::MotorIngesta(SistemaGestion& s, int numFragmentos, size_t capacidadCola)
+    : sistema(s),
+      bucle([this](int, const char* linea, size_t longitud) { encolarLinea(linea, longitud); }),
+      enMarcha(false), lineas(0), invalidas(0), registrosBinarios(0) {
+    bucle.setCallbackTrama([this](int dispositivo, uint8_t tipo, uint8_t cantidad, const uint8_t* carga, size_t largo) {
+        encolarTrama(sesiones[dispositivo], tipo, cantidad, carga, largo);
+    });
+    if (numFragmentos < 1) numFragmentos = 1;
+    for (int i = 0; i < numFragmentos; ++i) {
+        fragmentos.push_back(new Fragmento(capacidadCola, fragmentos.size()));
+    }
+}
+
+MotorIngesta::~MotorIngesta() {
+    detener();
+    for (size_t i = 0; i < fragmentos.size(); ++i) {
+        delete fragmentos[i];
+    }
+}
+
+bool MotorIngesta::agregarDispositivo(const char* ruta, int baud, bool binario) {
+    if (enMarcha) return false;
+    // La sesión debe existir antes de que el bucle entregue la primera trama
+    sesiones.resize(bucle.getCantidad() + 1);
+    int indice = bucle.agregarDispositivo(ruta, baud, binario ? kPedidoBinario : "");
+    if (!bucle.estaConectado(indice)) {
+        std::cout << "[WARN] " << ruta << " no disponible; se reintentara la conexion.\n";
+    }
+    return true;
+}
+
+void MotorIngesta::iniciar() {
+    if (enMarcha) return;
+    enMarcha = true;
+
+    for (size_t i = 0; i < fragmentos.size(); ++i) {
+        fragmentos[i]->hilo = std::thread(&MotorIngesta::bucleFragmento, this, fragmentos[i]);
+    }
+    if (bucle.getCantidad() > 0) {
+        lector = std::thread(&BucleSerial::ejecutar, &bucle);
+    }
+}
+
+void MotorIngesta::detener() {
+    if (!enMarcha) return;
+
+    if (lector.joinable()) {
+        bucle.detener();
+        lector.join();
+    }
+    for (size_t i = 0; i < fragmentos.size(); ++i) {
+        fragmentos[i]->cola.cerrar();
+    }
+    for (size_t i = 0; i < fragmentos.size(); ++i) {
+        if (fragmentos[i]->hilo.joinable()) fragmentos[i]->hilo.join();
+    }
+    enMarcha = false;
+}
+
+bool MotorIngesta::encolarLinea(const char* linea, size_t longitud) {
+    TramoTraza traza("parsearLinea");
+    lineas.fetch_add(1, std::memory_order_relaxed);
+    RegistroLectura registro;
+    if (parsearLinea(linea, longitud, registro) != PARSEO_OK) {
+        invalidas.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return encolar(std::move(registro));
+}
+
+size_t MotorIngesta::analizarBloque(const char* datos, size_t n, std::vector<RegistroLectura>& destino,
+                                    CupoIds* cupo) {
+    TramoTraza traza("analizarBloque");
+    size_t antes = destino.size();
+    unsigned long total = 0;
+    unsigned long malas = 0;
+    const char* p = datos;
+    const char* fin = datos + n;
+    while (p < fin) {
+        const char* salto = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(fin - p)));
+        const char* finLinea = salto ? salto : fin;
+        size_t largo = static_cast<size_t>(finLinea - p);
+        if (largo > 0 && p[largo - 1] == '\r') --largo;
+        if (largo > 0) {
+            ++total;
+            RegistroLectura registro;
+            ResultadoParseo resultado = cupo != nullptr ? parsearLinea(p, largo, registro, *cupo)
+                                                        : parsearLinea(p, largo, registro);
+            if (resultado == PARSEO_OK) {
+                destino.push_back(registro);
+            } else {
+                ++malas;
+            }
+        }
+        p = salto ? salto + 1 : fin;
+    }
+    lineas.fetch_add(total, std::memory_order_relaxed);
+    if (malas > 0) invalidas.fetch_add(malas, std::memory_order_relaxed);
+    return destino.size() - antes;
+}
+
+size_t MotorIngesta::encolarLote(std::vector<RegistroLectura>& registros) {
+    size_t m = fragmentos.size();
+    if (m == 1) return fragmentos[0]->cola.pushLote(registros.data(), registros.size());
+
+    // Orden por fragmento en un solo pase (conteo y dispersión)
+    std::vector<uint32_t> destinos(registros.size());
+    std::vector<size_t> inicios(m + 1, 0);
+    for (size_t i = 0; i < registros.size(); ++i) {
+        destinos[i] = TablaIds::global().hash(registros[i].id) % m;
+        ++inicios[destinos[i] + 1];
+    }
+    for (size_t f = 0; f < m; ++f) inicios[f + 1] += inicios[f];
+    std::vector<RegistroLectura> ordenados(registros.size());
+    std::vector<size_t> siguiente(inicios.begin(), inicios.end() - 1);
+    for (size_t i = 0; i < registros.size(); ++i) {
+        ordenados[siguiente[destinos[i]]++] = std::move(registros[i]);
+    }
+
+    size_t encolados = 0;
+    for (size_t f = 0; f < m; ++f) {
+        size_t cantidad = inicios[f + 1] - inicios[f];
+        if (cantidad > 0) encolados += fragmentos[f]->cola.pushLote(ordenados.data() + inicios[f], cantidad);
+    }
+    return encolados;
+}
+
+size_t MotorIngesta::encolarTrama(SesionBinaria& sesion, uint8_t tipo, uint8_t cantidad,
+                                  const uint8_t* carga, size_t largo) {
+    if (tipo == TRAMA_HOLA) {
+        if (!sesion.saludar(carga, largo)) invalidas.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    if (tipo == TRAMA_DECLARAR) {
+        if (!sesion.declarar(carga, largo)) invalidas.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    if (tipo != TRAMA_LOTE || largo != static_cast<size_t>(cantidad) * sizeof(RegistroTrama)) {
+        invalidas.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    RegistroTrama registros[255];
+    float valores[255];
+    decodificarLote(carga, cantidad, registros);
+    valoresLote(registros, cantidad, valores);
+    registrosBinarios.fetch_add(cantidad, std::memory_order_relaxed);
+
+    size_t encolados = 0;
+    for (size_t i = 0; i < cantidad; ++i) {
+        RegistroLectura registro;
+        registro.id = sesion.resolver(registros[i].sensor);
+        if (registro.id == TablaIds::kInvalido) {
+            invalidas.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        registro.tipo = static_cast<char>(registros[i].tipo);
+        registro.valor = valores[i];
+        if (encolar(registro)) ++encolados;
+    }
+    return encolados;
+}
+
+bool MotorIngesta::encolar(RegistroLectura registro) {
+    uint32_t h = TablaIds::global().hash(registro.id);
+    Fragmento* destino = fragmentos[h % fragmentos.size()];
+    return destino->cola.push(std::move(registro));
+}
+
+MotorIngesta::Estadisticas MotorIngesta::getEstadisticas() const {
+    Estadisticas e;
+    e.lineas = lineas.load();
+    e.invalidas = invalidas.load();
+    e.registrosBinarios = registrosBinarios.load();
+    for (size_t i = 0; i < fragmentos.size(); ++i) {
+        e.aplicados.push_back(fragmentos[i]->aplicados.load());
+        e.esperas.push_back(fragmentos[i]->cola.getEsperas());
+    }
+    return e;
+}
+
+void MotorIngesta::bucleFragmento(Fragmento* fragmento) {
+    // Antes de la primera lectura: los nodos de sus sensores van al nodo NUMA de esta CPU
+    AfinidadHilos::global().aplicar(HILO_INGESTA, fragmento->indice);
+    Trazador::global().nombrarHilo("fragmento");
+    std::vector<RegistroLectura> lote;
+    lote.reserve(256);
+    while (fragmento->cola.popLote(lote, 256) > 0) {
+        TramoTraza traza("aplicarLote");
+        for (size_t i = 0; i < lote.size(); ++i) {
+            const RegistroLectura& r = lote[i];
+            if (r.id >= fragmento->cache.size()) fragmento->cache.resize(r.id + 1, nullptr);
+            SensorBase*& sensor = fragmento->cache[r.id];
+            if (sensor == nullptr) {
+                sensor = aplicarRegistro(sistema, r);
+            } else if (sensor->getTipo() == r.tipo) {
+                sensor->registrarLectura(r.valor);
+            } else {
+                invalidas.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (sensor != nullptr) {
+                fragmento->aplicados.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                invalidas.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        lote.clear();
+    }
+}
@@ -0,0 +1,245 @@
+#ifndef INGESTA_H
+#define INGESTA_H
+
+/**
+ * @file Ingesta.h
+ * @brief Análisis de líneas "T,T-001,27.8" y motor de ingesta fragmentado
+ *
+ * El motor lee varios dispositivos seriales a la vez, analiza cada
+ * línea y la envía, según el hash del identificador del sensor, a uno de M
+ * fragmentos. Cada fragmento tiene su propio hilo y es el único que escribe
+ * en los sensores que le corresponden, por lo que los historiales no se
+ * disputan entre hilos.
+ */
+
+#include "SensorSystem.h"
+#include "ColaAcotada.h"
+#include "BucleSerial.h"
+#include "ProtocoloBinario.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Lectura ya analizada, lista para aplicarse al sistema
+ */
+struct RegistroLectura {
+    char tipo;        ///< 'T', 'P' o 'V'
+    uint32_t id;      ///< Handle del identificador en TablaIds
+    float valor;      ///< Valor leído
+
+    RegistroLectura() : tipo(0), id(TablaIds::kInvalido), valor(0.0f) {}
+};
+
+/**
+ * @brief Resultado del análisis de una línea
+ */
+enum ResultadoParseo {
+    PARSEO_OK,                ///< Línea válida
+    PARSEO_FORMATO_INVALIDO,  ///< Faltan campos o separadores
+    PARSEO_VALOR_INVALIDO,    ///< El valor no es numérico
+    PARSEO_TIPO_INVALIDO,     ///< La letra de tipo no es T, P ni V
+    PARSEO_ID_RECHAZADO       ///< Id desconocido y sin cupo para agregarlo (CupoIds)
+};
+
+/**
+ * @brief Límite de ids nuevos que una fuente no confiable puede agregar
+ *
+ * TablaIds guarda cada id para siempre y aplicarRegistro() crea un sensor
+ * por id desconocido: sin un tope, un emisor remoto podría agotar la memoria
+ * inventando ids. Los ids ya conocidos se aceptan siempre.
+ */
+struct CupoIds {
+    size_t restantes;          ///< Ids nuevos que todavía pueden agregarse
+    unsigned long rechazados;  ///< Líneas descartadas por id desconocido sin cupo
+
+    explicit CupoIds(size_t maximo = 0) : restantes(maximo), rechazados(0) {}
+};
+
+/**
+ * @brief Campos de una línea sin copiar el identificador
+ *
+ * id apunta dentro de la línea analizada; sirve a quien procesa texto en
+ * memoria (p. ej. un archivo mapeado) y no quiere reservar por registro.
+ */
+struct CamposLinea {
+    char tipo;
+    const char* id;
+    size_t largoId;
+    float valor;
+};
+
+/**
+ * @brief Analiza una línea "tipo,id,valor" sin reservar memoria
+ *
+ * El tipo es una sola letra T, P o V (también en minúscula) y se devuelve en
+ * mayúscula. Se valida aquí, antes de que nadie interne el id: una línea que
+ * no puede crear un sensor no debe dejar nada en TablaIds.
+ * @param linea Texto de la línea (sin salto de línea)
+ * @param longitud Cantidad de caracteres de la línea
+ * @param campos Destino del resultado
+ */
+ResultadoParseo parsearCampos(const char* linea, size_t longitud, CamposLinea& campos);
+
+/**
+ * @brief Analiza una línea con formato "tipo,id,valor" e interna el id
+ * @param linea Texto de la línea (sin salto de línea)
+ * @param longitud Cantidad de caracteres de la línea
+ * @param registro Destino del resultado
+ */
+ResultadoParseo parsearLinea(const char* linea, size_t longitud, RegistroLectura& registro);
+
+/**
+ * @brief Igual que parsearLinea(), pero un id desconocido gasta cupo
+ *
+ * Sin cupo, el id no se interna y la línea se rechaza.
+ */
+ResultadoParseo parsearLinea(const char* linea, size_t longitud, RegistroLectura& registro, CupoIds& cupo);
+
+/**
+ * @brief Crea el sensor concreto que corresponde a la letra de tipo
+ * @return Sensor nuevo o nullptr si el tipo no se reconoce
+ */
+SensorBase* crearSensor(char tipo, const char* id);
+
+/**
+ * @brief Registra la lectura en el sistema, creando el sensor si no existe
+ *
+ * Una lectura cuyo tipo no coincide con el del sensor existente se descarta.
+ * @return Sensor que recibió la lectura o nullptr si no pudo crearse o el tipo no coincide
+ */
+SensorBase* aplicarRegistro(SistemaGestion& sistema, const RegistroLectura& registro);
+
+/**
+ * @brief Hash FNV-1a de 32 bits de un identificador de sensor
+ *
+ * Es el mismo que TablaIds guarda por handle; sirve cuando el id todavía
+ * no está internado.
+ */
+uint32_t hashId(const char* id, size_t longitud);
+
+/**
+ * @brief Motor de ingesta multi-dispositivo con fragmentos por hash de id
+ *
+ * Un hilo lector atiende los dispositivos con un BucleSerial (epoll,
+ * reconexión automática) y reparte los registros; cada fragmento consume su
+ * cola acotada en su propio hilo. Si un fragmento se atrasa, su cola se llena y el lector espera (contrapresión),
+ * lo que a su vez deja de vaciar los buffers del kernel de los dispositivos.
+ *
+ * Los sensores que alimenta el motor no deben eliminarse mientras esté en
+ * marcha: cada fragmento guarda en caché los punteros de sus sensores.
+ */
+class MotorIngesta {
+public:
+    /**
+     * @brief Contadores del motor
+     */
+    struct Estadisticas {
+        unsigned long lineas;                       ///< Líneas recibidas
+        unsigned long invalidas;                    ///< Líneas y registros binarios descartados (también por tipo distinto al del sensor)
+        unsigned long registrosBinarios;            ///< Lecturas recibidas en tramas binarias
+        std::vector<unsigned long> aplicados;       ///< Registros aplicados por fragmento
+        std::vector<unsigned long> esperas;         ///< Veces que la cola del fragmento estaba llena
+    };
+
+    /**
+     * @param sistema Sistema que recibe las lecturas
+     * @param fragmentos Cantidad de hilos consumidores (M)
+     * @param capacidadCola Registros que admite cada cola antes de aplicar contrapresión
+     */
+    MotorIngesta(SistemaGestion& sistema, int fragmentos = 4, size_t capacidadCola = 4096);
+    ~MotorIngesta();
+
+    MotorIngesta(const MotorIngesta&) = delete;
+    MotorIngesta& operator=(const MotorIngesta&) = delete;
+
+    /**
+     * @brief Registra un dispositivo a leer; debe llamarse antes de iniciar()
+     *
+     * Si el dispositivo aún no existe se reintenta su apertura periódicamente.
+     * @param binario Pedir el protocolo binario en cada conexión; si el
+     *                dispositivo no lo entiende se sigue leyendo texto
+     * @return false si el motor ya está en marcha
+     */
+    bool agregarDispositivo(const char* ruta, int baud = 115200, bool binario = false);
+
+    /// Arranca el hilo lector y los hilos de los fragmentos
+    void iniciar();
+
+    /// Detiene la lectura, vacía las colas y espera a todos los hilos
+    void detener();
+
+    /**
+     * @brief Encola una línea desde otra fuente (red, archivo, pruebas)
+     * @return false si la línea es inválida o el motor está detenido
+     */
+    bool encolarLinea(const char* linea, size_t longitud);
+
+    /**
+     * @brief Analiza un bloque de líneas completas separadas por '\n'
+     *
+     * Una última línea sin salto también se analiza. Cuenta líneas e
+     * inválidas como encolarLinea(), pero no encola nada.
+     * @param destino Vector al que se añaden los registros válidos
+     * @param cupo Si no es nullptr, límite de ids nuevos (entrada no confiable)
+     * @return Registros añadidos
+     */
+    size_t analizarBloque(const char* datos, size_t n, std::vector<RegistroLectura>& destino,
+                          CupoIds* cupo = nullptr);
+
+    /**
+     * @brief Reparte un lote de registros entre los fragmentos
+     *
+     * Agrupa por fragmento y encola cada grupo con una sola toma del
+     * cerrojo de su cola. Los registros quedan movidos.
+     * @return Registros encolados
+     */
+    size_t encolarLote(std::vector<RegistroLectura>& registros);
+
+    /**
+     * @brief Aplica una trama binaria ya verificada
+     *
+     * 'H' y 'D' actualizan la sesión; los registros de un 'L' se traducen
+     * con los handles declarados y se encolan.
+     * @param sesion Estado binario de la conexión que envió la trama
+     * @return Lecturas encoladas
+     */
+    size_t encolarTrama(SesionBinaria& sesion, uint8_t tipo, uint8_t cantidad,
+                        const uint8_t* carga, size_t largo);
+
+    /**
+     * @brief Envía un registro ya analizado al fragmento que le corresponde
+     */
+    bool encolar(RegistroLectura registro);
+
+    int getFragmentos() const { return static_cast<int>(fragmentos.size()); }
+
+    Estadisticas getEstadisticas() const;
+
+private:
+    struct Fragmento {
+        ColaAcotada<RegistroLectura> cola;
+        std::thread hilo;
+        std::vector<SensorBase*> cache;  ///< Indexado por handle de TablaIds; solo lo usa el hilo del fragmento
+        std::atomic<unsigned long> aplicados;
+        size_t indice;                   ///< Posición en fragmentos; elige la CPU del hilo
+
+        Fragmento(size_t capacidad, size_t i) : cola(capacidad), aplicados(0), indice(i) {}
+    };
+
+    SistemaGestion& sistema;
+    std::vector<Fragmento*> fragmentos;
+    BucleSerial bucle;
+    std::vector<SesionBinaria> sesiones;   ///< Por dispositivo; solo las usa el hilo lector
+    std::thread lector;
+    bool enMarcha;
+    std::atomic<unsigned long> lineas;
+    std::atomic<unsigned long> invalidas;
+    std::atomic<unsigned long> registrosBinarios;
+
+    void bucleFragmento(Fragmento* fragmento);
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include "MotorConsultas.h"
+#include "SensorSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+/// Sensor que el plan no pudo resolver con estadísticas
+struct Superviviente {
+    InstantaneaSensor* foto;
+    float cota;     ///< Mejor valor que podría aportar (MAXIMO/MINIMO)
+};
+
+/**
+ * @brief Núcleo de evaluación: procesa bloques de lecturas de cualquier tipo
+ */
+class NucleoConsulta : public VisitanteHistorial {
+public:
+    NucleoConsulta(const Consulta& c)
+        : agregado(c.agregado), mayor(c.comparacion == COMPARAR_MAYOR), umbral(c.umbral),
+          maximo(-std::numeric_limits<float>::infinity()),
+          minimo(std::numeric_limits<float>::infinity()), contados(0), leidos(0) {}
+
+    void comenzarSensor(const char*, char, int) override {}
+    void visitar(float valor) override { procesar(&valor, 1); }
+    void visitar(int valor) override { procesar(&valor, 1); }
+    void visitarBloque(const float* valores, int n) override { procesar(valores, n); }
+    void visitarBloque(const int* valores, int n) override { procesar(valores, n); }
+
+    AgregadoConsulta agregado;
+    bool mayor;
+    float umbral;
+    float maximo;
+    float minimo;
+    uint64_t contados;
+    uint64_t leidos;
+
+private:
+    // Bucles sin saltos dependientes de los datos: el compilador puede vectorizarlos
+    template <typename T>
+    void procesar(const T* v, int n) {
+        leidos += static_cast<uint64_t>(n);
+        if (agregado == CONSULTA_MAXIMO) {
+            float m = maximo;
+            for (int i = 0; i < n; ++i) {
+                float x = static_cast<float>(v[i]);
+                m = x > m ? x : m;
+            }
+            maximo = m;
+        } else if (agregado == CONSULTA_MINIMO) {
+            float m = minimo;
+            for (int i = 0; i < n; ++i) {
+                float x = static_cast<float>(v[i]);
+                m = x < m ? x : m;
+            }
+            minimo = m;
+        } else {
+            uint64_t c = 0;
+            if (mayor) {
+                for (int i = 0; i < n; ++i) c += static_cast<float>(v[i]) > umbral;
+            } else {
+                for (int i = 0; i < n; ++i) c += static_cast<float>(v[i]) < umbral;
+            }
+            contados += c;
+        }
+    }
+};
+
+/// Estado compartido por los hilos de la evaluación
+struct EvaluacionCompartida {
+    std::atomic<float> mejor;           ///< Mejor extremo encontrado hasta ahora
+    std::atomic<uint64_t> contados;
+    std::atomic<uint64_t> leidos;
+    std::atomic<size_t> recorridos;
+    std::atomic<size_t> podados;
+};
+
+static bool cumple(ComparacionConsulta c, double valor, float umbral) {
+    if (c == COMPARAR_MAYOR) return valor > umbral;
+    if (c == COMPARAR_MENOR) return valor < umbral;
+    return true;
+}
+
+static void evaluar(const Consulta& consulta, const std::vector<Superviviente>& supervivientes,
+                    size_t desde, size_t paso, EvaluacionCompartida& compartida) {
+    NucleoConsulta nucleo(consulta);
+    bool buscaMaximo = consulta.agregado == CONSULTA_MAXIMO;
+    bool buscaExtremo = buscaMaximo || consulta.agregado == CONSULTA_MINIMO;
+    size_t recorridos = 0;
+    size_t podados = 0;
+    for (size_t i = desde; i < supervivientes.size(); i += paso) {
+        const Superviviente& s = supervivientes[i];
+        if (buscaExtremo) {
+            // Si su cota no mejora lo ya encontrado, el sensor no puede cambiar el resultado
+            float mejor = compartida.mejor.load(std::memory_order_relaxed);
+            if (buscaMaximo ? s.cota <= mejor : s.cota >= mejor) {
+                ++podados;
+                continue;
+            }
+        }
+        s.foto->recorrerHistorial(nucleo);
+        ++recorridos;
+        if (buscaExtremo) {
+            float propio = buscaMaximo ? nucleo.maximo : nucleo.minimo;
+            float mejor = compartida.mejor.load(std::memory_order_relaxed);
+            while (buscaMaximo ? propio > mejor : propio < mejor) {
+                if (compartida.mejor.compare_exchange_weak(mejor, propio, std::memory_order_relaxed)) break;
+            }
+        }
+    }
+    compartida.contados.fetch_add(nucleo.contados);
+    compartida.leidos.fetch_add(nucleo.leidos);
+    compartida.recorridos.fetch_add(recorridos);
+    compartida.podados.fetch_add(podados);
+}
+
+MotorConsultas::MotorConsultas(const SistemaGestion& s, int hilosParam) : sistema(s), hilos(hilosParam) {
+    if (hilos <= 0) hilos = static_cast<int>(std::thread::hardware_concurrency());
+    if (hilos <= 0) hilos = 1;
+}
+
+ResultadoConsulta MotorConsultas::ejecutar(const Consulta& c) const {
+    std::chrono::steady_clock::time_point comienzo = std::chrono::steady_clock::now();
+    ResultadoConsulta r;
+    r.valido = true;
+    r.valor = 0.0;
+    r.lecturas = 0;
+    r.candidatos = r.resueltos = r.recorridos = 0;
+    r.valoresLeidos = 0;
+
+    bool conVentana = c.ventanaMinutos > 0;
+    bool buscaMaximo = c.agregado == CONSULTA_MAXIMO;
+    bool buscaExtremo = buscaMaximo || c.agregado == CONSULTA_MINIMO;
+    size_t largoPrefijo = c.prefijo ? std::strlen(c.prefijo) : 0;
+    uint32_t periodo = VentanaLecturas::periodoActual();
+
+    double suma = 0.0;
+    bool hayExtremo = false;
+    float extremo = 0.0f;
+    std::vector<Superviviente> supervivientes;
+
+    {
+        // Los sensores no pueden liberarse mientras se toman sus instantáneas
+        SistemaGestion::GuardiaLectura guardia(sistema);
+
+        // Etapa 1: plan sobre las estadísticas de cada sensor
+        sistema.paraCadaSensor([&](SensorBase* s) {
+            if (c.tipo != 0 && s->getTipo() != c.tipo) return;
+            if (largoPrefijo > 0 && std::strncmp(s->getId(), c.prefijo, largoPrefijo) != 0) return;
+            ++r.candidatos;
+
+            EstadisticasSensor e;
+            s->leerEstadisticas(c.ventanaMinutos, periodo, e);
+            uint64_t cantidad = conVentana ? e.ventana.cantidad : static_cast<uint64_t>(e.cantidad);
+            double sumaSensor = conVentana ? e.ventana.suma : e.suma;
+            float minimo = conVentana ? e.ventana.minimo : e.minimo;
+            float maximo = conVentana ? e.ventana.maximo : e.maximo;
+
+            if (cantidad == 0 || !cumple(c.filtroPromedio, sumaSensor / cantidad, c.umbralPromedio)) {
+                ++r.resueltos;
+                return;
+            }
+
+            switch (c.agregado) {
+            case CONSULTA_SENSORES:
+                r.sensores.push_back(s->getIdInterno());
+                r.lecturas += cantidad;
+                ++r.resueltos;
+                break;
+            case CONSULTA_PROMEDIO:
+                suma += sumaSensor;
+                r.lecturas += cantidad;
+                ++r.resueltos;
+                break;
+            case CONSULTA_MAXIMO:
+            case CONSULTA_MINIMO:
+                r.lecturas += cantidad;
+                if (conVentana) {
+                    // Los intervalos guardan sus extremos exactos
+                    float v = buscaMaximo ? maximo : minimo;
+                    if (!hayExtremo || (buscaMaximo ? v > extremo : v < extremo)) extremo = v;
+                    hayExtremo = true;
+                    ++r.resueltos;
+                } else {
+                    Superviviente sv = {s->tomarInstantanea(), buscaMaximo ? maximo : minimo};
+                    supervivientes.push_back(sv);
+                }
+                break;
+            case CONSULTA_CONTAR: {
+                bool ninguna = c.comparacion == COMPARAR_MAYOR ? maximo <= c.umbral : minimo >= c.umbral;
+                bool todas = c.comparacion == COMPARAR_MAYOR ? minimo > c.umbral : maximo < c.umbral;
+                r.lecturas += cantidad;
+                if (ninguna || todas) {
+                    if (todas) r.valor += static_cast<double>(cantidad);
+                    ++r.resueltos;
+                } else if (conVentana) {
+                    // Los valores del historial no dicen en qué intervalo llegaron
+                    r.valido = false;
+                } else {
+                    Superviviente sv = {s->tomarInstantanea(), 0.0f};
+                    supervivientes.push_back(sv);
+                }
+                break;
+            }
+            }
+        });
+    }
+
+    // Etapa 2: evaluación en paralelo de lo que el plan no resolvió
+    if (!supervivientes.empty() && r.valido) {
+        if (buscaExtremo) {
+            // Las cotas más prometedoras primero: encuentran pronto un extremo que poda al resto
+            std::sort(supervivientes.begin(), supervivientes.end(),
+                      [buscaMaximo](const Superviviente& a, const Superviviente& b) {
+                          return buscaMaximo ? a.cota > b.cota : a.cota < b.cota;
+                      });
+        }
+        EvaluacionCompartida compartida;
+        compartida.mejor.store(buscaMaximo ? -std::numeric_limits<float>::infinity()
+                                           : std::numeric_limits<float>::infinity());
+        compartida.contados.store(0);
+        compartida.leidos.store(0);
+        compartida.recorridos.store(0);
+        compartida.podados.store(0);
+
+        size_t n = static_cast<size_t>(hilos);
+        if (n > supervivientes.size()) n = supervivientes.size();
+        std::vector<std::thread> trabajadores;
+        for (size_t t = 1; t < n; ++t) {
+            trabajadores.push_back(std::thread(evaluar, std::cref(c), std::cref(supervivientes), t, n,
+                                               std::ref(compartida)));
+        }
+        evaluar(c, supervivientes, 0, n, compartida);
+        for (size_t i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+
+        r.recorridos = compartida.recorridos.load();
+        r.resueltos += compartida.podados.load();
+        r.valoresLeidos = compartida.leidos.load();
+        if (buscaExtremo) {
+            float v = compartida.mejor.load();
+            if (!hayExtremo || (buscaMaximo ? v > extremo : v < extremo)) extremo = v;
+            hayExtremo = true;
+        } else {
+            r.valor += static_cast<double>(compartida.contados.load());
+        }
+    }
+    for (size_t i = 0; i < supervivientes.size(); ++i) delete supervivientes[i].foto;
+
+    if (c.agregado == CONSULTA_SENSORES) {
+        r.valor = static_cast<double>(r.sensores.size());
+    } else if (c.agregado == CONSULTA_PROMEDIO) {
+        r.valor = r.lecturas > 0 ? suma / static_cast<double>(r.lecturas) : 0.0;
+    } else if (buscaExtremo) {
+        r.valor = hayExtremo ? extremo : 0.0;
+    }
+    r.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - comienzo).count();
+    return r;
+}
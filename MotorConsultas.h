@@ -0,0 +1,98 @@
+#ifndef MOTOR_CONSULTAS_H
+#define MOTOR_CONSULTAS_H
+
+/**
+ * @file MotorConsultas.h
+ * @brief Consultas agregadas sobre varios sensores
+ *
+ * Responde preguntas como "sensores T con promedio > 40", "máximo de P-* en
+ * la última hora" o "cuántas lecturas superan un umbral" en dos etapas:
+ *  1. Plan: por cada sensor que pasa el filtro de tipo y prefijo se leen sus
+ *     estadísticas (cantidad, suma, cotas del bosquejo y ventana reciente).
+ *     Con eso se resuelven directamente los agregados que no necesitan los
+ *     valores y se descartan los sensores que no pueden aportar.
+ *  2. Evaluación: los sensores que sobreviven se recorren desde una
+ *     instantánea, en paralelo y por bloques de valores contiguos.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SistemaGestion;
+
+/// Qué calcula una consulta
+enum AgregadoConsulta {
+    CONSULTA_SENSORES,   ///< Sensores que cumplen el filtro
+    CONSULTA_MAXIMO,     ///< Mayor lectura
+    CONSULTA_MINIMO,     ///< Menor lectura
+    CONSULTA_PROMEDIO,   ///< Promedio de todas las lecturas (ponderado por cantidad)
+    CONSULTA_CONTAR      ///< Lecturas que cumplen la comparación con el umbral
+};
+
+/// Comparación contra un umbral
+enum ComparacionConsulta {
+    COMPARAR_NADA,
+    COMPARAR_MAYOR,
+    COMPARAR_MENOR
+};
+
+/**
+ * @brief Descripción de una consulta
+ */
+struct Consulta {
+    char tipo;                       ///< 'T', 'P', 'V' o 0 para todos
+    const char* prefijo;             ///< Prefijo del id ("P-"), o nullptr para todos
+    int ventanaMinutos;              ///< 0 = historial completo; si no, últimos minutos (hasta 60)
+    AgregadoConsulta agregado;
+    ComparacionConsulta filtroPromedio; ///< Filtra sensores por su promedio
+    float umbralPromedio;
+    ComparacionConsulta comparacion; ///< Condición por lectura de CONSULTA_CONTAR
+    float umbral;
+
+    Consulta()
+        : tipo(0), prefijo(nullptr), ventanaMinutos(0), agregado(CONSULTA_SENSORES),
+          filtroPromedio(COMPARAR_NADA), umbralPromedio(0.0f), comparacion(COMPARAR_MAYOR), umbral(0.0f) {}
+};
+
+/**
+ * @brief Resultado de una consulta y cuánto trabajo evitó el plan
+ */
+struct ResultadoConsulta {
+    bool valido;                  ///< false si la consulta no se puede responder
+    double valor;                 ///< Agregado (cantidad de sensores en CONSULTA_SENSORES)
+    uint64_t lecturas;            ///< Lecturas que abarca el agregado
+    size_t candidatos;            ///< Sensores que pasaron tipo y prefijo
+    size_t resueltos;             ///< Resueltos o descartados solo con estadísticas
+    size_t recorridos;            ///< Sensores cuyo historial hubo que leer
+    uint64_t valoresLeidos;       ///< Lecturas leídas en la evaluación
+    std::vector<uint32_t> sensores; ///< Handles de los sensores de CONSULTA_SENSORES
+    double segundos;
+};
+
+/**
+ * @brief Ejecutor de consultas sobre un SistemaGestion
+ */
+class MotorConsultas {
+public:
+    /**
+     * @param sistema Sistema a consultar
+     * @param hilos Hilos de la evaluación (0 = los del equipo)
+     */
+    explicit MotorConsultas(const SistemaGestion& sistema, int hilos = 0);
+
+    /**
+     * @brief Ejecuta una consulta
+     *
+     * CONSULTA_CONTAR mira los valores del historial, que no guardan su
+     * instante: con ventana solo se responde si las cotas de la ventana
+     * deciden todos los sensores; si no, el resultado no es válido.
+     */
+    ResultadoConsulta ejecutar(const Consulta& consulta) const;
+
+private:
+    const SistemaGestion& sistema;
+    int hilos;
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "MotorCorrelacion.h"
+#include "SensorSystem.h"
+#include "Trazas.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+/**
+ * @brief Cubetas de un sensor leídas a demanda desde su instantánea
+ *
+ * Solo guarda un bloque de lecturas: avanza por el historial a medida que se
+ * piden cubetas.
+ */
+class SerieCubetas {
+public:
+    /// @param cubetas Cubetas a entregar; se saltean las lecturas más viejas que sobran
+    SerieCubetas(const InstantaneaSensor& f, int porCubeta, int cubetas)
+        : foto(f), porCubeta(porCubeta), disponibles(0), siguiente(0), leidos(0) {
+        foto.avanzar(cursor, foto.getCantidad() - porCubeta * cubetas);
+    }
+
+    /// Promedio de la próxima cubeta; false si el historial se terminó antes
+    bool leer(double& valor) {
+        double suma = 0.0;
+        for (int faltan = porCubeta; faltan > 0; ) {
+            if (siguiente == disponibles) {
+                disponibles = foto.leerValores(cursor, bloque, ArchivoDerrame::kValoresPorBloque);
+                siguiente = 0;
+                if (disponibles == 0) return false;
+                leidos += static_cast<uint64_t>(disponibles);
+            }
+            int n = disponibles - siguiente < faltan ? disponibles - siguiente : faltan;
+            for (int i = 0; i < n; ++i) suma += bloque[siguiente + i];
+            siguiente += n;
+            faltan -= n;
+        }
+        valor = suma / porCubeta;
+        return true;
+    }
+
+    uint64_t getLeidos() const { return leidos; }
+
+private:
+    const InstantaneaSensor& foto;
+    CursorHistorial cursor;
+    int porCubeta;
+    int disponibles;
+    int siguiente;
+    uint64_t leidos;
+    float bloque[ArchivoDerrame::kValoresPorBloque];
+};
+
+/**
+ * @brief Sumas de un conjunto de pares (x, y)
+ *
+ * Los valores llegan ya desplazados por la primera cubeta de cada serie:
+ * así las sumas de cuadrados no pierden precisión con lecturas grandes.
+ */
+struct SumasPares {
+    double n;
+    double x;
+    double y;
+    double xx;
+    double yy;
+    double xy;
+
+    SumasPares() : n(0), x(0), y(0), xx(0), yy(0), xy(0) {}
+
+    void agregar(double a, double b) {
+        n += 1;
+        x += a;
+        y += b;
+        xx += a * a;
+        yy += b * b;
+        xy += a * b;
+    }
+
+    void quitar(double a, double b) {
+        n -= 1;
+        x -= a;
+        y -= b;
+        xx -= a * a;
+        yy -= b * b;
+        xy -= a * b;
+    }
+
+    double covarianza() const {
+        return n > 1 ? (xy - x * y / n) / (n - 1) : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double correlacion() const {
+        double vx = n * xx - x * x;
+        double vy = n * yy - y * y;
+        // Lo que queda por debajo del error de redondeo de las sumas es una serie constante
+        if (vx <= 1e-12 * n * xx || vy <= 1e-12 * n * yy) return std::numeric_limits<double>::quiet_NaN();
+        double r = (n * xy - x * y) / std::sqrt(vx * vy);
+        return r > 1.0 ? 1.0 : (r < -1.0 ? -1.0 : r);
+    }
+};
+
+/// Recorre a la par las series de un par y completa su resultado
+static uint64_t correlacionarPar(const InstantaneaSensor& fa, const InstantaneaSensor& fb,
+                                 const ConsultaCorrelacion& c, ResultadoPar& r) {
+    TramoTraza traza("correlacionarPar");
+    int porCubeta = c.lecturasPorCubeta;
+    int retardo = c.retardoMaximo;
+    int ventana = c.ventanaMovil;
+    int cantidad = fa.getCantidad() < fb.getCantidad() ? fa.getCantidad() : fb.getCantidad();
+    int cubetas = cantidad / porCubeta;
+
+    SerieCubetas sa(fa, porCubeta, cubetas);
+    SerieCubetas sb(fb, porCubeta, cubetas);
+    SumasPares total;
+    SumasPares movil;
+    // adelante[k]: a[t - k] con b[t] (desfase +k); atras[k]: a[t] con b[t - k] (desfase -k)
+    std::vector<SumasPares> adelante(static_cast<size_t>(retardo) + 1);
+    std::vector<SumasPares> atras(static_cast<size_t>(retardo) + 1);
+    // Anillos con las últimas cubetas: lo único que se retiene de las series
+    std::vector<double> previasA(static_cast<size_t>(retardo) + 1);
+    std::vector<double> previasB(static_cast<size_t>(retardo) + 1);
+    std::vector<double> ventanaA(static_cast<size_t>(ventana));
+    std::vector<double> ventanaB(static_cast<size_t>(ventana));
+    if (ventana > 0 && cubetas >= ventana) r.movil.reserve(static_cast<size_t>(cubetas - ventana + 1));
+
+    double desplazamientoA = 0.0;
+    double desplazamientoB = 0.0;
+    int t = 0;
+    for (; t < cubetas; ++t) {
+        double x;
+        double y;
+        if (!sa.leer(x) || !sb.leer(y)) break;
+        if (t == 0) {
+            desplazamientoA = x;
+            desplazamientoB = y;
+        }
+        x -= desplazamientoA;
+        y -= desplazamientoB;
+        total.agregar(x, y);
+
+        previasA[t % (retardo + 1)] = x;
+        previasB[t % (retardo + 1)] = y;
+        for (int k = 0; k <= retardo && k <= t; ++k) {
+            adelante[k].agregar(previasA[(t - k) % (retardo + 1)], y);
+            if (k > 0) atras[k].agregar(x, previasB[(t - k) % (retardo + 1)]);
+        }
+
+        if (ventana > 0) {
+            if (t >= ventana) movil.quitar(ventanaA[t % ventana], ventanaB[t % ventana]);
+            ventanaA[t % ventana] = x;
+            ventanaB[t % ventana] = y;
+            movil.agregar(x, y);
+            if (t >= ventana - 1) r.movil.push_back(static_cast<float>(movil.correlacion()));
+        }
+    }
+
+    r.cubetas = t;
+    r.covarianza = total.covarianza();
+    r.correlacion = total.correlacion();
+    r.cruzada.assign(static_cast<size_t>(2 * retardo + 1), std::numeric_limits<double>::quiet_NaN());
+    r.mejorRetardo = 0;
+    double mejor = -1.0;
+    for (int k = -retardo; k <= retardo; ++k) {
+        double v = k >= 0 ? adelante[k].correlacion() : atras[-k].correlacion();
+        r.cruzada[k + retardo] = v;
+        if (std::fabs(v) > mejor) {
+            mejor = std::fabs(v);
+            r.mejorRetardo = k;
+        }
+    }
+    return sa.getLeidos() + sb.getLeidos();
+}
+
+static void correlacionar(const ConsultaCorrelacion& c, const std::vector<InstantaneaSensor*>& fotos,
+                          const std::vector<size_t>& primeros, const std::vector<size_t>& segundos,
+                          std::vector<ResultadoPar>& pares, size_t desde, size_t paso,
+                          std::atomic<uint64_t>& leidos) {
+    uint64_t propios = 0;
+    for (size_t i = desde; i < pares.size(); i += paso) {
+        propios += correlacionarPar(*fotos[primeros[i]], *fotos[segundos[i]], c, pares[i]);
+    }
+    leidos.fetch_add(propios);
+}
+
+MotorCorrelacion::MotorCorrelacion(const SistemaGestion& s, int hilosParam) : sistema(s), hilos(hilosParam) {
+    if (hilos <= 0) hilos = static_cast<int>(std::thread::hardware_concurrency());
+    if (hilos <= 0) hilos = 1;
+}
+
+ResultadoCorrelacion MotorCorrelacion::ejecutar(const ConsultaCorrelacion& c) const {
+    std::chrono::steady_clock::time_point comienzo = std::chrono::steady_clock::now();
+    ResultadoCorrelacion r;
+    r.valido = c.sensores.size() >= 2 && c.lecturasPorCubeta > 0 && c.ventanaMovil >= 0 && c.retardoMaximo >= 0;
+    r.valoresLeidos = 0;
+
+    std::vector<InstantaneaSensor*> fotos;
+    if (r.valido) {
+        // Todas las vistas se toman juntas: las series quedan alineadas en el mismo instante
+        SistemaGestion::GuardiaLectura guardia(sistema);
+        for (size_t i = 0; i < c.sensores.size(); ++i) {
+            SensorBase* s = sistema.buscarSensor(c.sensores[i]);
+            if (s == nullptr) {
+                r.valido = false;
+                break;
+            }
+            fotos.push_back(s->tomarInstantanea());
+        }
+    }
+
+    if (r.valido) {
+        std::vector<size_t> primeros;
+        std::vector<size_t> segundos;
+        for (size_t i = 0; i < fotos.size(); ++i) {
+            for (size_t j = i + 1; j < fotos.size(); ++j) {
+                primeros.push_back(i);
+                segundos.push_back(j);
+                ResultadoPar p;
+                p.a = c.sensores[i];
+                p.b = c.sensores[j];
+                r.pares.push_back(p);
+            }
+        }
+
+        std::atomic<uint64_t> leidos(0);
+        size_t n = static_cast<size_t>(hilos);
+        if (n > r.pares.size()) n = r.pares.size();
+        std::vector<std::thread> trabajadores;
+        for (size_t t = 1; t < n; ++t) {
+            trabajadores.push_back(std::thread(correlacionar, std::cref(c), std::cref(fotos), std::cref(primeros),
+                                               std::cref(segundos), std::ref(r.pares), t, n, std::ref(leidos)));
+        }
+        correlacionar(c, fotos, primeros, segundos, r.pares, 0, n, leidos);
+        for (size_t i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+        r.valoresLeidos = leidos.load();
+    }
+    for (size_t i = 0; i < fotos.size(); ++i) delete fotos[i];
+
+    r.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - comienzo).count();
+    return r;
+}
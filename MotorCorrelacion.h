@@ -0,0 +1,85 @@
+#ifndef MOTOR_CORRELACION_H
+#define MOTOR_CORRELACION_H
+
+/**
+ * @file MotorCorrelacion.h
+ * @brief Correlación entre sensores alineados en cubetas
+ *
+ * Las lecturas del historial no guardan su instante, así que las series se
+ * alinean por posición desde la más reciente: la última lectura de cada
+ * sensor cae en la misma cubeta, la anterior en la misma que la anterior, y
+ * así hacia atrás (un as-of join para sensores que reportan con la misma
+ * cadencia). Cada cubeta promedia lecturasPorCubeta lecturas consecutivas,
+ * lo que compensa pequeñas diferencias de ritmo entre equipos.
+ *
+ * Sobre cada par de sensores se calculan covarianza y correlación de Pearson
+ * de toda la serie, la correlación móvil por ventanas y la correlación
+ * cruzada con desfase. Los historiales se recorren desde instantáneas con
+ * cursores, a la par y por bloques, sin copiarlos; los pares se reparten
+ * entre hilos.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SistemaGestion;
+
+/**
+ * @brief Qué sensores correlacionar y cómo
+ */
+struct ConsultaCorrelacion {
+    std::vector<uint32_t> sensores;   ///< Handles en TablaIds; al menos dos
+    int lecturasPorCubeta;            ///< Lecturas consecutivas promediadas en cada cubeta
+    int ventanaMovil;                 ///< Cubetas de cada ventana de la correlación móvil (0 = no calcularla)
+    int retardoMaximo;                ///< Desfases de la correlación cruzada: de -r a r cubetas
+
+    ConsultaCorrelacion() : lecturasPorCubeta(1), ventanaMovil(0), retardoMaximo(0) {}
+};
+
+/**
+ * @brief Resultado para un par de sensores
+ *
+ * Las correlaciones valen NaN cuando alguna de las series es constante en
+ * el tramo considerado.
+ */
+struct ResultadoPar {
+    uint32_t a;                     ///< Handle del primer sensor
+    uint32_t b;                     ///< Handle del segundo sensor
+    int cubetas;                    ///< Cubetas alineadas
+    double covarianza;              ///< Covarianza muestral de las cubetas
+    double correlacion;             ///< Pearson sobre todas las cubetas
+    std::vector<float> movil;       ///< Una por ventana, de la más vieja a la más reciente
+    std::vector<double> cruzada;    ///< cruzada[k + r]: correlación de a[t] con b[t + k]
+    int mejorRetardo;               ///< k con mayor |correlación| (b va k cubetas detrás de a)
+};
+
+/**
+ * @brief Resultado de una consulta de correlación
+ */
+struct ResultadoCorrelacion {
+    bool valido;                    ///< false si falta algún sensor o hay menos de dos
+    std::vector<ResultadoPar> pares; ///< En el orden (0,1), (0,2)... de consulta.sensores
+    uint64_t valoresLeidos;         ///< Lecturas leídas de los historiales
+    double segundos;
+};
+
+/**
+ * @brief Ejecutor de correlaciones sobre un SistemaGestion
+ */
+class MotorCorrelacion {
+public:
+    /**
+     * @param sistema Sistema a consultar
+     * @param hilos Hilos entre los que se reparten los pares (0 = los del equipo)
+     */
+    explicit MotorCorrelacion(const SistemaGestion& sistema, int hilos = 0);
+
+    ResultadoCorrelacion ejecutar(const ConsultaCorrelacion& consulta) const;
+
+private:
+    const SistemaGestion& sistema;
+    int hilos;
+};
+
+#endif
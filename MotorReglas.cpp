@@ -0,0 +1,274 @@
+#include "MotorReglas.h"
+#include "TablaIds.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+
+typedef std::unordered_map<std::string_view, std::vector<uint32_t> > IndiceReglas;
+
+/// Reglas de un tipo de sensor, indexadas por id exacto y por prefijo
+struct TablaReglasTipo {
+    IndiceReglas exactas;    ///< Índices en compiladas
+    IndiceReglas prefijos;   ///< Prefijo sin el '*'
+};
+
+/// Compilación inmutable de todas las reglas
+struct TablaReglas {
+    uint32_t version;
+    std::vector<ReglaCompilada> compiladas;
+    std::deque<std::string> patrones;   ///< Dueños del texto de las claves de los índices
+    TablaReglasTipo porTipo[3];
+};
+
+static int indiceTipo(char tipo) {
+    return tipo == 'T' ? 0 : (tipo == 'P' ? 1 : (tipo == 'V' ? 2 : -1));
+}
+
+static uint32_t segundosActuales() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint32_t>(ts.tv_sec);
+}
+
+static const char* saltarEspacios(const char* p) {
+    while (*p == ' ' || *p == '\t') ++p;
+    return p;
+}
+
+bool parsearRegla(const char* texto, Regla& regla) {
+    // "<patrón> [avg(<N>[s|m|h])] <'>'|'<'> <umbral> [for <N>]"
+    Regla r;
+    const char* p = saltarEspacios(texto);
+    const char* fin = p;
+    while (*fin != '\0' && *fin != ' ' && *fin != '\t') ++fin;
+    if (fin == p) return false;
+    r.patron.assign(p, fin);
+    // Un '*' solo vale al final del patrón
+    size_t asterisco = r.patron.find('*');
+    if (asterisco != std::string::npos && asterisco + 1 != r.patron.size()) return false;
+    if (r.patron.size() >= 2 && r.patron[1] == '-' && indiceTipo(r.patron[0]) >= 0) r.tipo = r.patron[0];
+
+    p = saltarEspacios(fin);
+    if (std::strncmp(p, "avg(", 4) == 0) {
+        char* resto;
+        long n = std::strtol(p + 4, &resto, 10);
+        long escala = 1;
+        if (*resto == 's') {
+            ++resto;
+        } else if (*resto == 'm') {
+            escala = 60;
+            ++resto;
+        } else if (*resto == 'h') {
+            escala = 3600;
+            ++resto;
+        }
+        if (resto == p + 4 || *resto != ')' || n <= 0 || n > 86400 / escala) return false;
+        r.ventanaSegundos = static_cast<uint32_t>(n * escala);
+        p = saltarEspacios(resto + 1);
+    }
+
+    if (*p != '>' && *p != '<') return false;
+    r.mayor = (*p == '>');
+    p = saltarEspacios(p + 1);
+    char* resto;
+    r.umbral = std::strtof(p, &resto);
+    if (resto == p) return false;
+    p = saltarEspacios(resto);
+
+    if (std::strncmp(p, "for", 3) == 0 && (p[3] == ' ' || p[3] == '\t')) {
+        const char* numero = saltarEspacios(p + 3);
+        long n = std::strtol(numero, &resto, 10);
+        if (resto == numero || n <= 0 || n > 1000000) return false;
+        r.consecutivas = static_cast<uint32_t>(n);
+        p = saltarEspacios(resto);
+    }
+    if (*p != '\0' && *p != '\r' && *p != '\n') return false;
+    regla = r;
+    return true;
+}
+
+MotorReglas::MotorReglas()
+    : siguienteClave(0), version(0), alertas(kCapacidadAlertas), descartadas(0), emitidas(0) {}
+
+int MotorReglas::agregar(const char* texto) {
+    Regla r;
+    if (!parsearRegla(texto, r)) return -1;
+    std::lock_guard<std::mutex> lock(mtx);
+    reglas.push_back(r);
+    textos.push_back(texto);
+    claves.push_back(siguienteClave++);
+    return static_cast<int>(reglas.size() - 1);
+}
+
+long MotorReglas::cargarArchivo(const char* ruta, size_t& invalidas) {
+    invalidas = 0;
+    std::ifstream archivo(ruta);
+    if (!archivo) return -1;
+    long agregadas = 0;
+    std::string linea;
+    while (std::getline(archivo, linea)) {
+        if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+        size_t inicio = linea.find_first_not_of(" \t");
+        if (inicio == std::string::npos || linea[inicio] == '#') continue;
+        if (agregar(linea.c_str() + inicio) < 0) {
+            ++invalidas;
+        } else {
+            ++agregadas;
+        }
+    }
+    compilar();
+    return agregadas;
+}
+
+void MotorReglas::compilar() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::shared_ptr<TablaReglas> tabla = std::make_shared<TablaReglas>();
+    tabla->compiladas.resize(reglas.size());
+    for (size_t i = 0; i < reglas.size(); ++i) {
+        const Regla& r = reglas[i];
+        ReglaCompilada& c = tabla->compiladas[i];
+        c.numero = static_cast<uint32_t>(i);
+        c.clave = claves[i];
+        c.mayor = r.mayor;
+        c.umbral = r.umbral;
+        c.ventanaSegundos = r.ventanaSegundos;
+        c.consecutivas = r.consecutivas;
+
+        bool prefijo = !r.patron.empty() && r.patron.back() == '*';
+        tabla->patrones.push_back(prefijo ? r.patron.substr(0, r.patron.size() - 1) : r.patron);
+        std::string_view clave = tabla->patrones.back();
+        for (int t = 0; t < 3; ++t) {
+            if (r.tipo != 0 && indiceTipo(r.tipo) != t) continue;
+            TablaReglasTipo& tt = tabla->porTipo[t];
+            (prefijo ? tt.prefijos : tt.exactas)[clave].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    publicar(tabla);
+}
+
+void MotorReglas::eliminarTodas() {
+    std::lock_guard<std::mutex> lock(mtx);
+    reglas.clear();
+    textos.clear();
+    claves.clear();
+    publicar(std::make_shared<TablaReglas>());
+}
+
+void MotorReglas::publicar(std::shared_ptr<TablaReglas> tabla) {
+    // Se llama con mtx tomado; la versión se publica después de la tabla
+    uint32_t nueva = version.load(std::memory_order_relaxed) + 1;
+    if (nueva == 0) nueva = 1;
+    tabla->version = nueva;
+    actual.store(tabla, std::memory_order_release);
+    version.store(nueva, std::memory_order_release);
+}
+
+size_t MotorReglas::getCantidad() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return reglas.size();
+}
+
+std::string MotorReglas::getTexto(uint32_t numero) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return numero < textos.size() ? textos[numero] : std::string();
+}
+
+void MotorReglas::resolver(EstadoReglasSensor& estado, char tipo, uint32_t sensorId) {
+    // Sin cerrojo: corre con el del sensor tomado, en plena ingesta
+    std::shared_ptr<const TablaReglas> tabla = actual.load(std::memory_order_acquire);
+    int t = indiceTipo(tipo);
+    std::vector<uint32_t> indices;
+    if (tabla && t >= 0) {
+        const TablaReglasTipo& tt = tabla->porTipo[t];
+        const TablaIds& ids = TablaIds::global();
+        std::string_view id(ids.texto(sensorId), ids.largo(sensorId));
+        IndiceReglas::const_iterator it = tt.exactas.find(id);
+        if (it != tt.exactas.end()) indices.insert(indices.end(), it->second.begin(), it->second.end());
+        // Un prefijo que aplica es un prefijo del id: se prueban todos sus largos
+        if (!tt.prefijos.empty()) {
+            for (size_t largo = 0; largo <= id.size(); ++largo) {
+                it = tt.prefijos.find(id.substr(0, largo));
+                if (it != tt.prefijos.end()) indices.insert(indices.end(), it->second.begin(), it->second.end());
+            }
+        }
+        std::sort(indices.begin(), indices.end());
+    }
+
+    // Las reglas que siguen compiladas conservan racha y cubetas; las claves
+    // crecen con el número de regla, así que ambas listas están ordenadas por clave
+    std::vector<EstadoRegla> anteriores;
+    anteriores.swap(estado.reglas);
+    uint32_t ahora = segundosActuales();
+    estado.reglas.resize(indices.size());
+    estado.conPromedios = false;
+    size_t j = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const ReglaCompilada* regla = &tabla->compiladas[indices[i]];
+        while (j < anteriores.size() && anteriores[j].regla->clave < regla->clave) ++j;
+        EstadoRegla& e = estado.reglas[i];
+        if (j < anteriores.size() && anteriores[j].regla->clave == regla->clave) {
+            e = anteriores[j];
+        } else {
+            e.racha = 0;
+            e.inicioCubeta = ahora;
+            e.cantidadActual = e.cantidadPrevia = 0;
+            e.sumaActual = e.sumaPrevia = 0.0;
+        }
+        e.regla = regla;
+        if (regla->ventanaSegundos > 0) estado.conPromedios = true;
+    }
+    // Recién ahora puede soltarse la tabla anterior, a la que apuntaban los estados viejos
+    estado.version = tabla ? tabla->version : 0;
+    estado.tabla = tabla;
+}
+
+/// Suma la lectura a las cubetas de la regla y devuelve el promedio de la ventana
+static float promediarVentana(EstadoRegla& e, uint32_t ventana, float valor, uint32_t ahora) {
+    uint32_t transcurrido = ahora - e.inicioCubeta;
+    if (transcurrido >= 2 * ventana) {
+        e.cantidadPrevia = 0;
+        e.sumaPrevia = 0.0;
+        e.cantidadActual = 0;
+        e.sumaActual = 0.0;
+        e.inicioCubeta = ahora;
+        transcurrido = 0;
+    } else if (transcurrido >= ventana) {
+        e.cantidadPrevia = e.cantidadActual;
+        e.sumaPrevia = e.sumaActual;
+        e.cantidadActual = 0;
+        e.sumaActual = 0.0;
+        e.inicioCubeta += ventana;
+        transcurrido -= ventana;
+    }
+    ++e.cantidadActual;
+    e.sumaActual += valor;
+    double peso = 1.0 - static_cast<double>(transcurrido) / ventana;
+    return static_cast<float>((e.sumaPrevia * peso + e.sumaActual) / (e.cantidadPrevia * peso + e.cantidadActual));
+}
+
+void MotorReglas::evaluarResueltas(EstadoReglasSensor& estado, char tipo, uint32_t sensorId, float valor) {
+    uint32_t ahora = estado.conPromedios ? segundosActuales() : 0;
+    for (size_t i = 0; i < estado.reglas.size(); ++i) {
+        EstadoRegla& e = estado.reglas[i];
+        const ReglaCompilada& r = *e.regla;
+        float x = r.ventanaSegundos > 0 ? promediarVentana(e, r.ventanaSegundos, valor, ahora) : valor;
+        if (r.mayor ? !(x > r.umbral) : !(x < r.umbral)) {
+            e.racha = 0;
+            continue;
+        }
+        // Se emite al completar la racha; mientras siga cumpliéndose no se repite
+        if (e.racha < r.consecutivas && ++e.racha == r.consecutivas) {
+            AlertaRegla alerta;
+            alerta.regla = r.numero;
+            alerta.sensorId = sensorId;
+            alerta.tipoSensor = tipo;
+            alerta.valor = x;
+            emitidas.fetch_add(1, std::memory_order_relaxed);
+            if (!alertas.tryPush(alerta)) descartadas.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#ifndef MOTOR_REGLAS_H
+#define MOTOR_REGLAS_H
+
+/**
+ * @file MotorReglas.h
+ * @brief Reglas de alerta evaluadas en cada lectura, sin recorrer historiales
+ *
+ * Una regla se escribe como texto:
+ * @code
+ *   T-* > 48 for 3          (3 lecturas seguidas de un T-* por encima de 48)
+ *   P-105 avg(1m) < 72      (promedio del último minuto de P-105 por debajo de 72)
+ *   * > 1000                (cualquier sensor)
+ * @endcode
+ * El patrón es un id exacto o un prefijo terminado en '*'; si empieza con
+ * la letra de un tipo y un guion (la convención "T-001") la regla solo va a
+ * la tabla de ese tipo. La expresión es la lectura o avg(N) con N en s, m
+ * o h. "for N" exige N evaluaciones seguidas que cumplan; la alerta se
+ * emite una vez al completarlas y no se repite hasta que la condición deje
+ * de cumplirse.
+ *
+ * compilar() arma tablas por tipo de sensor ('T', 'P', 'V') con dos índices
+ * hash, de ids exactos y de prefijos. Cada sensor resuelve una
+ * sola vez qué reglas le tocan y guarda, junto al sensor, el estado mínimo de
+ * cada una (una racha y, para los promedios, dos cubetas). Una lectura cuesta
+ * una comparación de versión más O(1) por regla que le corresponde; los
+ * sensores sin reglas pagan solo la comparación. Cargar reglas nuevas no
+ * frena la ingesta: la tabla se compila aparte, se publica con un puntero
+ * atómico (la ingesta no toma el cerrojo del motor) y cada sensor se
+ * resuelve de nuevo en su próxima lectura. Las reglas que siguen en la tabla
+ * conservan su estado (racha y cubetas): agregar una regla no reinicia los
+ * "for N" ni los promedios de las demás.
+ */
+
+#include "ColaAcotada.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Una regla ya interpretada
+ */
+struct Regla {
+    std::string patron;          ///< Id exacto, prefijo terminado en '*', o "*"
+    char tipo;                   ///< Tipo de sensor al que aplica; 0 = todos
+    bool mayor;                  ///< true: '>'; false: '<'
+    float umbral;
+    uint32_t ventanaSegundos;    ///< 0 = la lectura; si no, promedio de la ventana
+    uint32_t consecutivas;       ///< Evaluaciones seguidas que deben cumplirse (al menos 1)
+
+    Regla() : tipo(0), mayor(true), umbral(0.0f), ventanaSegundos(0), consecutivas(1) {}
+};
+
+/**
+ * @brief Interpreta el texto de una regla
+ * @return false si el texto no respeta la sintaxis
+ */
+bool parsearRegla(const char* texto, Regla& regla);
+
+/**
+ * @brief Una regla tal como la evalúa la ingesta
+ */
+struct ReglaCompilada {
+    uint32_t numero;             ///< Posición en MotorReglas (la que informa la alerta)
+    uint32_t clave;              ///< Única por regla agregada; no se repite tras eliminarTodas()
+    bool mayor;
+    float umbral;
+    uint32_t ventanaSegundos;
+    uint32_t consecutivas;
+};
+
+/**
+ * @brief Alerta emitida por una regla
+ */
+struct AlertaRegla {
+    uint32_t regla;              ///< Número de la regla en MotorReglas
+    uint32_t sensorId;           ///< Handle del sensor en TablaIds
+    char tipoSensor;
+    float valor;                 ///< Lectura, o promedio de la ventana, que completó la condición
+
+    AlertaRegla() : regla(0), sensorId(0xFFFFFFFFu), tipoSensor(0), valor(0.0f) {}
+};
+
+struct TablaReglas;
+
+/**
+ * @brief Estado de una regla para un sensor
+ *
+ * Los promedios usan dos cubetas del largo de la ventana: la actual y la
+ * anterior, esta última ponderada por la parte de la ventana que aún cubre.
+ */
+struct EstadoRegla {
+    const ReglaCompilada* regla;
+    uint32_t racha;              ///< Evaluaciones seguidas que cumplieron
+    uint32_t inicioCubeta;       ///< Segundo en que empezó la cubeta actual
+    uint32_t cantidadActual;
+    uint32_t cantidadPrevia;
+    double sumaActual;
+    double sumaPrevia;
+};
+
+/**
+ * @brief Reglas resueltas de un sensor; vive en el sensor y se usa con su cerrojo
+ */
+struct EstadoReglasSensor {
+    uint32_t version;                          ///< Versión de la tabla con la que se resolvió
+    bool conPromedios;                         ///< Alguna regla necesita el reloj
+    std::shared_ptr<const TablaReglas> tabla;  ///< Mantiene vivas las reglas apuntadas
+    std::vector<EstadoRegla> reglas;
+
+    EstadoReglasSensor() : version(0), conPromedios(false) {}
+};
+
+/**
+ * @brief Reglas cargadas, su compilación y las alertas pendientes
+ */
+class MotorReglas {
+public:
+    static const size_t kCapacidadAlertas = 4096;   ///< Alertas retenidas sin consumir
+
+    MotorReglas();
+
+    MotorReglas(const MotorReglas&) = delete;
+    MotorReglas& operator=(const MotorReglas&) = delete;
+
+    /**
+     * @brief Agrega una regla; no rige hasta el próximo compilar()
+     * @return Número de la regla, o -1 si el texto no es válido
+     */
+    int agregar(const char* texto);
+
+    /**
+     * @brief Agrega las reglas de un archivo (una por línea; '#' comenta) y compila
+     * @param invalidas Recibe las líneas que no pudieron interpretarse
+     * @return Reglas agregadas, o -1 si no se pudo abrir
+     */
+    long cargarArchivo(const char* ruta, size_t& invalidas);
+
+    /// Publica las reglas agregadas hasta ahora
+    void compilar();
+
+    /// Quita todas las reglas (rige de inmediato)
+    void eliminarTodas();
+
+    size_t getCantidad() const;
+
+    /// Texto con el que se agregó una regla
+    std::string getTexto(uint32_t numero) const;
+
+    /**
+     * @brief Evalúa las reglas de un sensor con una lectura nueva
+     *
+     * La llama SensorBase::notificarLectura() con el cerrojo del sensor.
+     */
+    void evaluar(EstadoReglasSensor& estado, char tipo, uint32_t sensorId, float valor) {
+        if (estado.version != version.load(std::memory_order_acquire)) resolver(estado, tipo, sensorId);
+        if (!estado.reglas.empty()) evaluarResueltas(estado, tipo, sensorId, valor);
+    }
+
+    /// Pasa a destino las alertas pendientes
+    size_t extraerAlertas(std::vector<AlertaRegla>& destino, size_t maximo = kCapacidadAlertas) {
+        return alertas.tryPopLote(destino, maximo);
+    }
+
+    /// Alertas perdidas porque nadie consumía la cola
+    unsigned long getAlertasDescartadas() const { return descartadas.load(); }
+
+    /// Alertas emitidas desde el arranque
+    unsigned long getAlertasEmitidas() const { return emitidas.load(); }
+
+private:
+    mutable std::mutex mtx;                       ///< Protege reglas, textos y claves
+    std::vector<Regla> reglas;
+    std::vector<std::string> textos;
+    std::vector<uint32_t> claves;                 ///< ReglaCompilada::clave de cada regla
+    uint32_t siguienteClave;
+    std::atomic<std::shared_ptr<const TablaReglas> > actual;   ///< Última tabla compilada
+    std::atomic<uint32_t> version;                ///< Versión de actual; 0 = sin reglas
+    ColaAcotada<AlertaRegla> alertas;
+    std::atomic<unsigned long> descartadas;
+    std::atomic<unsigned long> emitidas;
+
+    void resolver(EstadoReglasSensor& estado, char tipo, uint32_t sensorId);
+    void evaluarResueltas(EstadoReglasSensor& estado, char tipo, uint32_t sensorId, float valor);
+    void publicar(std::shared_ptr<TablaReglas> tabla);
+};
+
+#endif
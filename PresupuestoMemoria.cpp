@@ -0,0 +1,101 @@
+#include "PresupuestoMemoria.h"
+#include <algorithm>
+#include <chrono>
+
+PresupuestoMemoria::PresupuestoMemoria(SistemaGestion& s)
+    : sistema(s), presupuesto(0), residentes(0), derrames(0), activo(false), enMarcha(false),
+      periodoMs(200) {}
+
+PresupuestoMemoria::~PresupuestoMemoria() {
+    detener();
+}
+
+bool PresupuestoMemoria::configurar(size_t bytes, const char* directorioDerrame) {
+    if (bytes > 0 && !sistema.getArchivoDerrame().abrir(directorioDerrame)) return false;
+    presupuesto.store(bytes);
+    return true;
+}
+
+void PresupuestoMemoria::iniciar(int periodo) {
+    if (enMarcha) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        activo = true;
+        periodoMs = periodo > 0 ? periodo : 1;
+    }
+    hilo = std::thread(&PresupuestoMemoria::bucle, this);
+    enMarcha = true;
+}
+
+void PresupuestoMemoria::detener() {
+    if (!enMarcha) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        activo = false;
+        despertar.notify_all();
+    }
+    hilo.join();
+    enMarcha = false;
+}
+
+size_t PresupuestoMemoria::aplicar() {
+    std::lock_guard<std::mutex> lockPasada(mtxPasada);
+    // Los sensores que registren a partir de aquí quedan como los más recientes
+    sistema.avanzarRelojAcceso();
+
+    SistemaGestion::GuardiaLectura guardia(sistema);
+    candidatos.clear();
+    size_t total = 0;
+    sistema.paraCadaSensor([this, &total](SensorBase* s) {
+        size_t bytes = s->getBytesResidentes();
+        if (bytes == 0) return;
+        total += bytes;
+        Candidato c = {s->getUltimoAcceso(), bytes, s};
+        candidatos.push_back(c);
+    });
+    residentes.store(total);
+
+    size_t limite = presupuesto.load();
+    ArchivoDerrame& archivo = sistema.getArchivoDerrame();
+    if (limite == 0 || total <= limite || !archivo.estaAbierto()) return 0;
+
+    // Menos recientes primero; a igual antigüedad, los más grandes liberan más por escritura
+    std::sort(candidatos.begin(), candidatos.end(), [](const Candidato& a, const Candidato& b) {
+        if (a.acceso != b.acceso) return a.acceso < b.acceso;
+        return a.bytes > b.bytes;
+    });
+    size_t objetivo = limite - limite / 10;
+    size_t liberados = 0;
+    for (size_t i = 0; i < candidatos.size() && total - liberados > objetivo; ++i) {
+        size_t bytes = candidatos[i].sensor->derramarHistorial(archivo);
+        if (bytes > 0) {
+            liberados += bytes;
+            derrames.fetch_add(1);
+        }
+    }
+    residentes.store(total - liberados);
+    return liberados;
+}
+
+EstadoMemoria PresupuestoMemoria::getEstado() const {
+    const ArchivoDerrame& archivo = sistema.getArchivoDerrame();
+    EstadoMemoria e;
+    e.presupuesto = presupuesto.load();
+    e.residentes = residentes.load();
+    e.derrames = derrames.load();
+    e.recuperaciones = archivo.getRecuperaciones();
+    e.bytesArchivo = archivo.getTamano();
+    e.bytesDerramados = archivo.getBytes();
+    return e;
+}
+
+void PresupuestoMemoria::bucle() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (activo) {
+        despertar.wait_for(lock, std::chrono::milliseconds(periodoMs));
+        if (!activo) break;
+        lock.unlock();
+        aplicar();
+        lock.lock();
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef PRESUPUESTO_MEMORIA_H
+#define PRESUPUESTO_MEMORIA_H
+
+/**
+ * @file PresupuestoMemoria.h
+ * @brief Límite global de memoria para los historiales de los sensores
+ *
+ * Los historiales crecen sin tope y viven enteros en RAM: un sensor ruidoso
+ * puede dejar sin memoria al gateway. Un hilo suma periódicamente los bytes
+ * de nodos de cada sensor y, si el total pasa del presupuesto, derrama al
+ * ArchivoDerrame los historiales de los sensores que hace más tiempo no
+ * reciben lecturas, hasta bajar del 90 % del presupuesto. Un historial
+ * derramado vuelve a memoria en cuanto se le agrega o elimina una lectura.
+ *
+ * El límite es blando: entre dos pasadas la ingesta puede superarlo. Cuenta
+ * bytes de nodos, no memoria residente: los tramos de ArenaNodos no vuelven
+ * al sistema, así que un derrame hace lugar para nodos nuevos sin bajar el
+ * RSS del proceso.
+ */
+
+#include "SensorSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Totales de la última pasada y acumulados
+ */
+struct EstadoMemoria {
+    size_t presupuesto;           ///< Bytes permitidos (0 = sin límite)
+    size_t residentes;            ///< Bytes de nodos en memoria en la última pasada
+    unsigned long derrames;       ///< Historiales derramados desde el arranque
+    unsigned long recuperaciones; ///< Historiales vueltos a cargar desde el archivo
+    uint64_t bytesArchivo;        ///< Tamaño del archivo de derrame (regiones vivas y huecos)
+    uint64_t bytesDerramados;     ///< Bytes de las regiones que siguen en uso
+};
+
+/**
+ * @brief Hilo que mantiene los historiales dentro del presupuesto
+ */
+class PresupuestoMemoria {
+public:
+    explicit PresupuestoMemoria(SistemaGestion& sistema);
+    ~PresupuestoMemoria();
+
+    PresupuestoMemoria(const PresupuestoMemoria&) = delete;
+    PresupuestoMemoria& operator=(const PresupuestoMemoria&) = delete;
+
+    /**
+     * @brief Fija el presupuesto y el directorio del archivo de derrame
+     * @param bytes Bytes de historial permitidos en memoria (0 = sin límite)
+     * @param directorioDerrame Donde crear el archivo (sin nombre); se ignora si el
+     *        sistema ya tiene uno abierto
+     * @return false si no se pudo crear el archivo
+     */
+    bool configurar(size_t bytes, const char* directorioDerrame);
+
+    /// Arranca el hilo de vigilancia
+    void iniciar(int periodoMs = 200);
+
+    /// Detiene el hilo; la pasada en curso termina antes de volver
+    void detener();
+
+    bool estaEnMarcha() const { return enMarcha; }
+
+    /**
+     * @brief Ejecuta una pasada ahora
+     *
+     * No debe llamarse con el cerrojo de un sensor tomado.
+     * @return Bytes liberados
+     */
+    size_t aplicar();
+
+    EstadoMemoria getEstado() const;
+
+private:
+    /// Sensor con memoria residente, ordenable por antigüedad de uso
+    struct Candidato {
+        uint32_t acceso;
+        size_t bytes;
+        SensorBase* sensor;
+    };
+
+    SistemaGestion& sistema;
+    std::atomic<size_t> presupuesto;
+    std::atomic<size_t> residentes;
+    std::atomic<unsigned long> derrames;
+    std::mutex mtxPasada;              ///< Serializa las pasadas (hilo y llamadas directas)
+    std::vector<Candidato> candidatos; ///< Reutilizado entre pasadas
+    std::thread hilo;
+    std::mutex mtx;
+    std::condition_variable despertar;
+    bool activo;
+    bool enMarcha;
+    int periodoMs;
+
+    void bucle();
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "ProgramadorProcesamiento.h"
+#include "Afinidad.h"
+#include <chrono>
+
+static int64_t ahoraMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ProgramadorProcesamiento::ProgramadorProcesamiento(SistemaGestion& s)
+    : sistema(s), activo(false), enMarcha(false), visitados(0) {}
+
+ProgramadorProcesamiento::~ProgramadorProcesamiento() {
+    detener();
+}
+
+void ProgramadorProcesamiento::setPeriodo(char tipo, int periodoMs) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < cadencias.size(); ++i) {
+        if (cadencias[i].tipo == tipo) {
+            if (periodoMs <= 0) {
+                cadencias.erase(cadencias.begin() + i);
+            } else {
+                cadencias[i].periodoMs = periodoMs;
+                cadencias[i].proxima = ahoraMs() + periodoMs;
+            }
+            despertar.notify_all();
+            return;
+        }
+    }
+    if (periodoMs > 0) {
+        Cadencia c;
+        c.tipo = tipo;
+        c.periodoMs = periodoMs;
+        c.proxima = ahoraMs() + periodoMs;
+        cadencias.push_back(c);
+        despertar.notify_all();
+    }
+}
+
+void ProgramadorProcesamiento::iniciar() {
+    if (enMarcha) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        activo = true;
+    }
+    hilo = std::thread(&ProgramadorProcesamiento::bucle, this);
+    enMarcha = true;
+}
+
+void ProgramadorProcesamiento::detener() {
+    if (!enMarcha) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        activo = false;
+        despertar.notify_all();
+    }
+    hilo.join();
+    enMarcha = false;
+}
+
+size_t ProgramadorProcesamiento::procesarPendientes(char tipo) {
+    SistemaGestion::GuardiaLectura guardia(sistema);
+    std::vector<SensorBase*> sensores;
+    sistema.tomarPendientes(tipo, sensores);
+    for (size_t i = 0; i < sensores.size(); ++i) {
+        sensores[i]->procesarIncremental();
+    }
+    visitados.fetch_add(sensores.size());
+    return sensores.size();
+}
+
+void ProgramadorProcesamiento::bucle() {
+    AfinidadHilos::global().aplicar(HILO_PROCESAMIENTO, 0);
+    std::unique_lock<std::mutex> lock(mtx);
+    while (activo) {
+        if (cadencias.empty()) {
+            despertar.wait(lock);
+            continue;
+        }
+
+        int64_t proxima = cadencias[0].proxima;
+        for (size_t i = 1; i < cadencias.size(); ++i) {
+            if (cadencias[i].proxima < proxima) proxima = cadencias[i].proxima;
+        }
+        int64_t ahora = ahoraMs();
+        if (proxima > ahora) {
+            despertar.wait_for(lock, std::chrono::milliseconds(proxima - ahora));
+            continue;
+        }
+
+        std::vector<char> vencidos;
+        for (size_t i = 0; i < cadencias.size(); ++i) {
+            if (cadencias[i].proxima <= ahora) {
+                vencidos.push_back(cadencias[i].tipo);
+                // Sin acumular atrasos: si una pasada tardó más que el periodo, se salta
+                while (cadencias[i].proxima <= ahora) cadencias[i].proxima += cadencias[i].periodoMs;
+            }
+        }
+
+        lock.unlock();
+        for (size_t i = 0; i < vencidos.size(); ++i) {
+            procesarPendientes(vencidos[i]);
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef PROGRAMADOR_PROCESAMIENTO_H
+#define PROGRAMADOR_PROCESAMIENTO_H
+
+/**
+ * @file ProgramadorProcesamiento.h
+ * @brief Procesamiento periódico e incremental por tipo de sensor
+ *
+ * En lugar de esperar a que el usuario elija la opción 5 del menú, un hilo
+ * ejecuta procesarIncremental() con una cadencia propia para cada tipo de
+ * sensor. Solo visita los sensores que recibieron lecturas desde la pasada
+ * anterior (el conjunto de pendientes que mantiene registrarLectura()).
+ */
+
+#include "SensorSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Programador de pasadas de procesamiento incremental
+ */
+class ProgramadorProcesamiento {
+public:
+    explicit ProgramadorProcesamiento(SistemaGestion& sistema);
+    ~ProgramadorProcesamiento();
+
+    ProgramadorProcesamiento(const ProgramadorProcesamiento&) = delete;
+    ProgramadorProcesamiento& operator=(const ProgramadorProcesamiento&) = delete;
+
+    /**
+     * @brief Define cada cuánto se procesan los sensores de un tipo
+     * @param tipo Letra del tipo ('T', 'P' o 'V')
+     * @param periodoMs Periodo en milisegundos; 0 desactiva el tipo
+     */
+    void setPeriodo(char tipo, int periodoMs);
+
+    /// Arranca el hilo del programador
+    void iniciar();
+
+    /// Detiene el hilo; la pasada en curso termina antes de volver
+    void detener();
+
+    bool estaEnMarcha() const { return enMarcha; }
+
+    /**
+     * @brief Procesa ahora los sensores pendientes de un tipo
+     * @return Cantidad de sensores visitados
+     */
+    size_t procesarPendientes(char tipo);
+
+    /// Sensores visitados desde la creación del programador
+    unsigned long getVisitados() const { return visitados.load(); }
+
+private:
+    struct Cadencia {
+        char tipo;
+        int periodoMs;
+        int64_t proxima;   ///< Instante (ms monotónicos) de la próxima pasada
+    };
+
+    SistemaGestion& sistema;
+    std::vector<Cadencia> cadencias;
+    std::thread hilo;
+    std::mutex mtx;
+    std::condition_variable despertar;
+    bool activo;
+    bool enMarcha;
+    std::atomic<unsigned long> visitados;
+
+    void bucle();
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "ProtocoloBinario.h"
+
+/// Tabla de CRC-16/CCITT por byte, generada en compilación
+struct TablaCrc16 {
+    uint16_t v[256];
+    constexpr TablaCrc16() : v() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t c = static_cast<uint16_t>(i << 8);
+            for (int b = 0; b < 8; ++b) c = (c & 0x8000) ? static_cast<uint16_t>((c << 1) ^ 0x1021) : static_cast<uint16_t>(c << 1);
+            v[i] = c;
+        }
+    }
+};
+
+static constexpr TablaCrc16 kTablaCrc16;
+
+uint16_t crc16(const uint8_t* datos, size_t n, uint16_t crc) {
+    for (size_t i = 0; i < n; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ kTablaCrc16.v[((crc >> 8) ^ datos[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+static bool hostLittleEndian() {
+    const uint16_t prueba = 1;
+    return *reinterpret_cast<const uint8_t*>(&prueba) == 1;
+}
+
+size_t decodificarLote(const uint8_t* carga, size_t cantidad, RegistroTrama* destino) {
+    std::memcpy(destino, carga, cantidad * sizeof(RegistroTrama));
+    if (!hostLittleEndian()) {
+        for (size_t i = 0; i < cantidad; ++i) {
+            const uint8_t* p = carga + i * sizeof(RegistroTrama);
+            destino[i].sensor = static_cast<uint16_t>(p[0] | (p[1] << 8));
+            destino[i].valor = static_cast<uint32_t>(p[4]) | (static_cast<uint32_t>(p[5]) << 8) |
+                               (static_cast<uint32_t>(p[6]) << 16) | (static_cast<uint32_t>(p[7]) << 24);
+        }
+    }
+    return cantidad;
+}
+
+void valoresLote(const RegistroTrama* registros, size_t n, float* destino) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t bits = registros[i].valor;
+        float comoFloat;
+        std::memcpy(&comoFloat, &bits, sizeof(comoFloat));
+        float comoEntero = static_cast<float>(static_cast<int32_t>(bits));
+        destino[i] = registros[i].formato == VALOR_ENTERO ? comoEntero : comoFloat;
+    }
+}
+
+bool SesionBinaria::saludar(const uint8_t* carga, size_t largo) {
+    if (largo < 1 || carga[0] == 0) return false;
+    version = carga[0];
+    return true;
+}
+
+bool SesionBinaria::declarar(const uint8_t* carga, size_t largo) {
+    if (largo < 4) return false;
+    uint16_t sensor = static_cast<uint16_t>(carga[0] | (carga[1] << 8));
+    size_t largoId = carga[3];
+    if (largoId == 0 || largo != 4 + largoId) return false;
+    uint32_t id = TablaIds::global().internar(reinterpret_cast<const char*>(carga + 4), largoId);
+    if (id == TablaIds::kInvalido) return false;
+    if (sensor >= handles.size()) handles.resize(static_cast<size_t>(sensor) + 1, TablaIds::kInvalido);
+    handles[sensor] = id;
+    return true;
+}
+
+size_t armarTrama(uint8_t tipo, uint8_t cantidad, const void* carga, size_t largo, uint8_t* destino) {
+    if (largo > kCargaMaximaTrama) return 0;
+    destino[0] = kSincroniaTrama;
+    destino[1] = tipo;
+    destino[2] = cantidad;
+    destino[3] = static_cast<uint8_t>(largo & 0xFF);
+    destino[4] = static_cast<uint8_t>(largo >> 8);
+    if (largo > 0) std::memcpy(destino + kCabeceraTrama, carga, largo);
+    uint16_t crc = crc16(destino + 1, kCabeceraTrama - 1 + largo);
+    destino[kCabeceraTrama + largo] = static_cast<uint8_t>(crc & 0xFF);
+    destino[kCabeceraTrama + largo + 1] = static_cast<uint8_t>(crc >> 8);
+    return kCabeceraTrama + largo + 2;
+}
+
+size_t armarDeclaracion(uint16_t sensor, char tipo, const char* id, uint8_t* destino) {
+    uint8_t carga[4 + 255];
+    size_t largoId = std::strlen(id);
+    if (largoId > 255) largoId = 255;
+    carga[0] = static_cast<uint8_t>(sensor & 0xFF);
+    carga[1] = static_cast<uint8_t>(sensor >> 8);
+    carga[2] = static_cast<uint8_t>(tipo);
+    carga[3] = static_cast<uint8_t>(largoId);
+    std::memcpy(carga + 4, id, largoId);
+    return armarTrama(TRAMA_DECLARAR, 1, carga, 4 + largoId, destino);
+}
+
+size_t armarLote(const RegistroTrama* registros, size_t n, uint8_t* destino) {
+    if (n == 0 || n > 255) return 0;
+    uint8_t carga[kCargaMaximaTrama];
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t* p = carga + i * sizeof(RegistroTrama);
+        p[0] = static_cast<uint8_t>(registros[i].sensor & 0xFF);
+        p[1] = static_cast<uint8_t>(registros[i].sensor >> 8);
+        p[2] = registros[i].tipo;
+        p[3] = registros[i].formato;
+        p[4] = static_cast<uint8_t>(registros[i].valor & 0xFF);
+        p[5] = static_cast<uint8_t>((registros[i].valor >> 8) & 0xFF);
+        p[6] = static_cast<uint8_t>((registros[i].valor >> 16) & 0xFF);
+        p[7] = static_cast<uint8_t>(registros[i].valor >> 24);
+    }
+    return armarTrama(TRAMA_LOTE, static_cast<uint8_t>(n), carga, n * sizeof(RegistroTrama), destino);
+}
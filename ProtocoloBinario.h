@@ -0,0 +1,133 @@
+#ifndef PROTOCOLO_BINARIO_H
+#define PROTOCOLO_BINARIO_H
+
+/**
+ * @file ProtocoloBinario.h
+ * @brief Tramas binarias con CRC para dispositivos seriales, junto al formato de texto
+ *
+ * Una línea "T,T-001,27.8\n" gasta unos 14 bytes en un valor de 4 y hay que
+ * analizarla como texto; a 115200 baudios (11520 bytes/s) eso da unas 800
+ * lecturas por segundo por dispositivo. En binario cada lectura ocupa 8 bytes
+ * de tamaño fijo y un lote de hasta 255 lecturas comparte cabecera y CRC:
+ * unas 1400 lecturas por segundo, sin análisis de texto.
+ *
+ * Formato de una trama (enteros en little-endian):
+ * @code
+ *   0xA5 | tipo (u8) | cantidad (u8) | largo (u16) | carga[largo] | crc (u16)
+ * @endcode
+ * El CRC es CRC-16/CCITT-FALSE sobre todo lo que sigue a la sincronía
+ * (tipo, cantidad, largo y carga). Tipos de trama:
+ *  - 'H' (hola): el dispositivo confirma que pasó a binario; carga = versión (u8).
+ *  - 'D' (declarar): asocia un handle local del dispositivo con un id de texto;
+ *    carga = handle (u16), tipo de sensor (u8), largo del id (u8), id.
+ *  - 'L' (lote): cantidad registros de 8 bytes (RegistroTrama).
+ *
+ * Negociación: al conectar, el host envía la línea "#FORMATO BIN\n". Un
+ * dispositivo que la entiende responde con 'H', declara sus sensores y
+ * envía lotes; uno que no, sigue enviando texto y todo funciona igual. El
+ * byte 0xA5 no aparece en texto ASCII, así que ambos formatos pueden
+ * mezclarse en el mismo flujo: una trama solo empieza donde empezaría una línea.
+ */
+
+#include "TablaIds.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static const uint8_t kSincroniaTrama = 0xA5;
+static const size_t kCabeceraTrama = 5;        ///< Sincronía, tipo, cantidad y largo
+static const size_t kCargaMaximaTrama = 2040;  ///< 255 registros de 8 bytes
+static const uint8_t kVersionProtocolo = 1;
+
+/// Línea con la que el host pide el formato binario
+static const char kPedidoBinario[] = "#FORMATO BIN\n";
+
+enum TipoTrama {
+    TRAMA_HOLA = 'H',
+    TRAMA_DECLARAR = 'D',
+    TRAMA_LOTE = 'L'
+};
+
+/// Codificación del campo valor de RegistroTrama
+enum FormatoValor {
+    VALOR_FLOAT = 0,   ///< IEEE-754 de 32 bits
+    VALOR_ENTERO = 1   ///< Entero con signo de 32 bits
+};
+
+/**
+ * @brief Una lectura dentro de un lote, con la disposición exacta del cable
+ */
+struct RegistroTrama {
+    uint16_t sensor;   ///< Handle local del dispositivo (declarado con 'D')
+    uint8_t tipo;      ///< 'T', 'P' o 'V'
+    uint8_t formato;   ///< FormatoValor
+    uint32_t valor;    ///< Bits del valor
+};
+
+static_assert(sizeof(RegistroTrama) == 8, "RegistroTrama debe ocupar 8 bytes sin relleno");
+
+/// CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+uint16_t crc16(const uint8_t* datos, size_t n, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Copia los registros de la carga de un lote
+ *
+ * Los registros son de tamaño fijo y no hay que buscar separadores: en un
+ * host little-endian la carga se copia tal cual.
+ * @return Cantidad de registros copiados
+ */
+size_t decodificarLote(const uint8_t* carga, size_t cantidad, RegistroTrama* destino);
+
+/**
+ * @brief Convierte los valores de un lote a float
+ *
+ * Sin saltos que dependan del formato de cada registro: el compilador
+ * puede vectorizar el bucle.
+ */
+void valoresLote(const RegistroTrama* registros, size_t n, float* destino);
+
+/**
+ * @brief Arma una trama completa
+ * @param destino Al menos kCabeceraTrama + largo + 2 bytes
+ * @return Bytes escritos, o 0 si la carga es demasiado grande
+ */
+size_t armarTrama(uint8_t tipo, uint8_t cantidad, const void* carga, size_t largo, uint8_t* destino);
+
+/// Trama 'D' de un sensor; destino de al menos kCabeceraTrama + 4 + 255 + 2 bytes
+size_t armarDeclaracion(uint16_t sensor, char tipo, const char* id, uint8_t* destino);
+
+/// Trama 'L' con n registros (1 a 255)
+size_t armarLote(const RegistroTrama* registros, size_t n, uint8_t* destino);
+
+/**
+ * @brief Estado binario de una conexión: versión y handles declarados
+ *
+ * Los handles son locales a cada dispositivo; la sesión los traduce a los
+ * handles de TablaIds. Un dispositivo que se reconecta vuelve a declarar
+ * sus sensores, y una declaración repetida reemplaza a la anterior.
+ */
+class SesionBinaria {
+public:
+    SesionBinaria() : version(0) {}
+
+    /// Carga de una trama 'H'
+    bool saludar(const uint8_t* carga, size_t largo);
+
+    /// Carga de una trama 'D'; interna el id
+    bool declarar(const uint8_t* carga, size_t largo);
+
+    /// Handle de TablaIds del sensor local, o TablaIds::kInvalido si no se declaró
+    uint32_t resolver(uint16_t sensor) const {
+        return sensor < handles.size() ? handles[sensor] : TablaIds::kInvalido;
+    }
+
+    /// Versión anunciada por el dispositivo (0 = todavía en texto)
+    uint8_t getVersion() const { return version; }
+
+private:
+    std::vector<uint32_t> handles;
+    uint8_t version;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "PublicadorMemoria.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+static uint64_t instanteNs() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static RanuraEvento* ranuras(char* base) {
+    const CabeceraPublicacion* c = reinterpret_cast<const CabeceraPublicacion*>(base);
+    return reinterpret_cast<RanuraEvento*>(base + c->desplazamientoEventos);
+}
+
+PublicadorMemoria::~PublicadorMemoria() {
+    char* base = region.load();
+    if (base != nullptr) munmap(base, bytes);
+    if (fd >= 0) close(fd);
+}
+
+bool PublicadorMemoria::abrir(const char* nombre, uint32_t capacidadSensores, uint32_t capacidadEventos) {
+    if (region.load() != nullptr || capacidadSensores == 0 || capacidadEventos == 0) return false;
+    uint32_t eventos = 1;
+    while (eventos < capacidadEventos) eventos <<= 1;
+
+    size_t desplazamientoSensores = (sizeof(CabeceraPublicacion) + 63) & ~static_cast<size_t>(63);
+    size_t desplazamientoEventos = desplazamientoSensores + capacidadSensores * sizeof(EntradaPublicada);
+    size_t total = desplazamientoEventos + eventos * sizeof(RanuraEvento);
+
+    int nuevo = nombre ? shm_open(nombre, O_CREAT | O_RDWR | O_CLOEXEC, 0600)
+                       : memfd_create("sensores", MFD_CLOEXEC);
+    if (nuevo < 0) return false;
+    // Vaciar primero: una región vieja con el mismo nombre no debe dejar restos
+    if (ftruncate(nuevo, 0) < 0 || ftruncate(nuevo, static_cast<off_t>(total)) < 0) {
+        close(nuevo);
+        return false;
+    }
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, nuevo, 0);
+    if (p == MAP_FAILED) {
+        close(nuevo);
+        return false;
+    }
+
+    char* base = static_cast<char*>(p);
+    CabeceraPublicacion* c = new (base) CabeceraPublicacion();
+    c->version = kVersionPublicacion;
+    c->capacidadSensores = capacidadSensores;
+    c->capacidadEventos = eventos;
+    c->desplazamientoSensores = desplazamientoSensores;
+    c->desplazamientoEventos = desplazamientoEventos;
+    c->sensoresUsados.store(0, std::memory_order_relaxed);
+    c->eventosEscritos.store(0, std::memory_order_relaxed);
+    // Las páginas nuevas ya están en cero: alcanza con construir los atómicos
+    for (uint32_t i = 0; i < capacidadSensores; ++i) {
+        new (base + desplazamientoSensores + i * sizeof(EntradaPublicada)) EntradaPublicada();
+    }
+    for (uint32_t i = 0; i < eventos; ++i) {
+        new (base + desplazamientoEventos + i * sizeof(RanuraEvento)) RanuraEvento();
+    }
+    c->magia.store(kMagiaPublicacion, std::memory_order_release);
+
+    fd = nuevo;
+    bytes = total;
+    region.store(base, std::memory_order_release);
+    return true;
+}
+
+EntradaPublicada* PublicadorMemoria::entrada(char* base, uint32_t sensor) {
+    CabeceraPublicacion* c = reinterpret_cast<CabeceraPublicacion*>(base);
+    if (sensor >= c->capacidadSensores) return nullptr;
+    return reinterpret_cast<EntradaPublicada*>(base + c->desplazamientoSensores) + sensor;
+}
+
+void PublicadorMemoria::escribir(char* base, uint32_t sensor, char tipo, const char* id, float valor,
+                                 float promedio, float minimo, float maximo, uint64_t lecturas) {
+    EntradaPublicada* e = entrada(base, sensor);
+    if (e == nullptr) {
+        sinLugar.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    CabeceraPublicacion* c = reinterpret_cast<CabeceraPublicacion*>(base);
+    uint64_t ahora = instanteNs();
+
+    uint32_t s = e->secuencia.load(std::memory_order_relaxed);
+    e->secuencia.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    DatosSensorPublicados& d = e->datos;
+    if (d.tipo != tipo) {
+        std::strncpy(d.id, id, kLargoIdPublicado - 1);
+        d.id[kLargoIdPublicado - 1] = '\0';
+        d.tipo = tipo;
+    }
+    d.ultima = valor;
+    d.promedio = promedio;
+    d.minimo = minimo;
+    d.maximo = maximo;
+    d.lecturas = lecturas;
+    d.instanteNs = ahora;
+    e->secuencia.store(s + 2, std::memory_order_release);
+
+    uint32_t usados = c->sensoresUsados.load(std::memory_order_relaxed);
+    while (usados <= sensor &&
+           !c->sensoresUsados.compare_exchange_weak(usados, sensor + 1, std::memory_order_release)) {
+    }
+
+    // Anillo: cada escritor reserva su posición; la ranura queda impar mientras la llena
+    uint64_t posicion = c->eventosEscritos.fetch_add(1, std::memory_order_relaxed);
+    RanuraEvento& r = ranuras(base)[posicion & (c->capacidadEventos - 1)];
+    r.secuencia.store(2 * posicion + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.evento.sensor = sensor;
+    r.evento.tipo = tipo;
+    r.evento.valor = valor;
+    r.evento.instanteNs = ahora;
+    r.secuencia.store(2 * posicion + 2, std::memory_order_release);
+}
+
+void PublicadorMemoria::publicarPromedio(uint32_t sensor, float promedio) {
+    char* base = region.load(std::memory_order_acquire);
+    if (base == nullptr) return;
+    EntradaPublicada* e = entrada(base, sensor);
+    if (e == nullptr || e->datos.tipo == 0) return;
+    uint32_t s = e->secuencia.load(std::memory_order_relaxed);
+    e->secuencia.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e->datos.promedio = promedio;
+    e->secuencia.store(s + 2, std::memory_order_release);
+}
+
+void PublicadorMemoria::retirar(uint32_t sensor) {
+    char* base = region.load(std::memory_order_acquire);
+    if (base == nullptr) return;
+    EntradaPublicada* e = entrada(base, sensor);
+    if (e == nullptr || e->datos.tipo == 0) return;
+    uint32_t s = e->secuencia.load(std::memory_order_relaxed);
+    e->secuencia.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memset(&e->datos, 0, sizeof(e->datos));
+    e->secuencia.store(s + 2, std::memory_order_release);
+}
+
+LectorPublicacion::~LectorPublicacion() {
+    if (region != nullptr) munmap(const_cast<char*>(region), bytes);
+}
+
+bool LectorPublicacion::abrir(const char* nombre) {
+    int fd = shm_open(nombre, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return false;
+    bool ok = abrirDescriptor(fd);
+    close(fd);
+    return ok;
+}
+
+bool LectorPublicacion::abrirDescriptor(int fd) {
+    if (region != nullptr) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(CabeceraPublicacion)) return false;
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return false;
+    const CabeceraPublicacion* c = static_cast<const CabeceraPublicacion*>(p);
+    if (c->magia.load(std::memory_order_acquire) != kMagiaPublicacion || c->version != kVersionPublicacion ||
+        c->desplazamientoEventos + c->capacidadEventos * sizeof(RanuraEvento) > static_cast<size_t>(st.st_size)) {
+        munmap(p, static_cast<size_t>(st.st_size));
+        return false;
+    }
+    region = static_cast<const char*>(p);
+    bytes = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+uint32_t LectorPublicacion::getSensores() const {
+    return region ? cabecera()->sensoresUsados.load(std::memory_order_acquire) : 0;
+}
+
+bool LectorPublicacion::leerSensor(uint32_t sensor, DatosSensorPublicados& destino) const {
+    if (region == nullptr || sensor >= cabecera()->capacidadSensores) return false;
+    const EntradaPublicada* e =
+        reinterpret_cast<const EntradaPublicada*>(region + cabecera()->desplazamientoSensores) + sensor;
+    for (;;) {
+        uint32_t antes = e->secuencia.load(std::memory_order_acquire);
+        if (antes & 1) continue;  // El escritor está a mitad de camino
+        std::memcpy(&destino, &e->datos, sizeof(destino));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e->secuencia.load(std::memory_order_relaxed) == antes) return destino.tipo != 0;
+    }
+}
+
+uint64_t LectorPublicacion::getEventosEscritos() const {
+    return region ? cabecera()->eventosEscritos.load(std::memory_order_acquire) : 0;
+}
+
+size_t LectorPublicacion::leerEventos(uint64_t& cursor, EventoPublicado* destino, size_t maximo,
+                                      uint64_t& perdidos) const {
+    if (region == nullptr) return 0;
+    const CabeceraPublicacion* c = cabecera();
+    const RanuraEvento* anillo = reinterpret_cast<const RanuraEvento*>(region + c->desplazamientoEventos);
+    uint64_t escritos = c->eventosEscritos.load(std::memory_order_acquire);
+    if (escritos - cursor > c->capacidadEventos) {
+        perdidos += escritos - c->capacidadEventos - cursor;
+        cursor = escritos - c->capacidadEventos;
+    }
+    size_t n = 0;
+    while (n < maximo && cursor < escritos) {
+        const RanuraEvento& r = anillo[cursor & (c->capacidadEventos - 1)];
+        uint64_t esperada = 2 * cursor + 2;
+        uint64_t antes = r.secuencia.load(std::memory_order_acquire);
+        if (antes < esperada) break;  // Todavía se está escribiendo
+        if (antes == esperada) {
+            EventoPublicado copia;
+            std::memcpy(&copia, &r.evento, sizeof(copia));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (r.secuencia.load(std::memory_order_relaxed) == antes) {
+                destino[n++] = copia;
+                ++cursor;
+                continue;
+            }
+        }
+        // Un escritor de una vuelta posterior la pisó
+        ++perdidos;
+        ++cursor;
+    }
+    return n;
+}
@@ -0,0 +1,200 @@
+#ifndef PUBLICADOR_MEMORIA_H
+#define PUBLICADOR_MEMORIA_H
+
+/**
+ * @file PublicadorMemoria.h
+ * @brief Publicación del estado de los sensores en memoria compartida
+ *
+ * Procesos locales (tablero, alertas) leen la última lectura y las
+ * estadísticas de cada sensor sin llamadas al sistema ni copias por el
+ * kernel: mapean una región de shm_open (o un memfd heredado) y leen de ella.
+ *
+ * Disposición de la región:
+ * @code
+ *   CabeceraPublicacion | EntradaPublicada[capacidadSensores] | RanuraEvento[capacidadEventos]
+ * @endcode
+ *  - La tabla se indexa por el handle del sensor en TablaIds. Cada entrada
+ *    está protegida por un seqlock: el escritor pone la secuencia en impar,
+ *    escribe y la deja en par; el lector copia y reintenta si la secuencia
+ *    cambió o era impar. Nunca se bloquea al escritor.
+ *  - El anillo de eventos recibe cada lectura nueva. Si un consumidor se
+ *    atrasa más que la capacidad, los eventos más viejos se pisan y el
+ *    consumidor los cuenta como perdidos.
+ *
+ * Solo valen los tipos atómicos libres de cerrojo (uint32_t y uint64_t),
+ * que funcionan igual entre procesos que entre hilos.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+static const uint32_t kMagiaPublicacion = 0x534E5331;   ///< "SNS1"
+static const uint32_t kVersionPublicacion = 1;
+static const size_t kLargoIdPublicado = 32;
+
+/**
+ * @brief Estado de un sensor tal como lo ven los consumidores
+ */
+struct DatosSensorPublicados {
+    char id[kLargoIdPublicado];   ///< Terminado en '\0'; se trunca si es más largo
+    char tipo;                    ///< 'T', 'P' o 'V'; 0 = ranura libre
+    uint8_t relleno[3];
+    float ultima;                 ///< Última lectura
+    float promedio;               ///< Promedio del historial actual
+    float minimo;                 ///< Menor lectura registrada
+    float maximo;                 ///< Mayor lectura registrada
+    uint64_t lecturas;            ///< Lecturas registradas desde el alta
+    uint64_t instanteNs;          ///< CLOCK_REALTIME de la última actualización
+};
+
+/// Entrada de la tabla: seqlock más datos, en su propia línea de caché
+struct alignas(64) EntradaPublicada {
+    std::atomic<uint32_t> secuencia;   ///< Impar mientras se escribe
+    uint32_t relleno;
+    DatosSensorPublicados datos;
+};
+
+/**
+ * @brief Una lectura nueva en el anillo de eventos
+ */
+struct EventoPublicado {
+    uint32_t sensor;              ///< Handle en TablaIds = índice en la tabla
+    char tipo;
+    uint8_t relleno[3];
+    float valor;
+    uint32_t relleno2;
+    uint64_t instanteNs;
+};
+
+/// Ranura del anillo; secuencia = 2 * posición + 2 cuando el evento está completo
+struct RanuraEvento {
+    std::atomic<uint64_t> secuencia;
+    EventoPublicado evento;
+};
+
+/**
+ * @brief Cabecera al inicio de la región
+ */
+struct CabeceraPublicacion {
+    std::atomic<uint32_t> magia;          ///< Se escribe al final: la región ya está lista
+    uint32_t version;
+    uint32_t capacidadSensores;
+    uint32_t capacidadEventos;            ///< Potencia de 2
+    uint64_t desplazamientoSensores;      ///< Bytes desde el inicio de la región
+    uint64_t desplazamientoEventos;
+    std::atomic<uint32_t> sensoresUsados; ///< Cota superior de los índices ocupados
+    uint32_t relleno;
+    alignas(64) std::atomic<uint64_t> eventosEscritos;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "la región compartida necesita atómicos libres de cerrojo");
+
+/**
+ * @brief Escritor de la región; lo usa SistemaGestion
+ *
+ * abrir() se llama una sola vez. Hasta entonces publicar() no hace nada.
+ * Las escrituras de una misma entrada deben estar serializadas (los sensores
+ * publican bajo su cerrojo); el anillo admite varios escritores.
+ */
+class PublicadorMemoria {
+public:
+    PublicadorMemoria() : region(nullptr), bytes(0), fd(-1), sinLugar(0) {}
+    ~PublicadorMemoria();
+
+    PublicadorMemoria(const PublicadorMemoria&) = delete;
+    PublicadorMemoria& operator=(const PublicadorMemoria&) = delete;
+
+    /**
+     * @brief Crea la región y empieza a publicar
+     * @param nombre Nombre para shm_open ("/sensores"); nullptr = memfd anónimo,
+     *               que se comparte pasando getDescriptor() a un proceso hijo
+     * @param capacidadSensores Handles publicables (los mayores se ignoran)
+     * @param capacidadEventos Se redondea a potencia de 2
+     * @return false si ya estaba abierta o no pudo crearse
+     */
+    bool abrir(const char* nombre, uint32_t capacidadSensores = 4096, uint32_t capacidadEventos = 65536);
+
+    bool estaAbierto() const { return region.load(std::memory_order_acquire) != nullptr; }
+
+    /// Descriptor de la región (-1 si no está abierta)
+    int getDescriptor() const { return fd; }
+
+    /**
+     * @brief Publica una lectura: actualiza la entrada del sensor y agrega un evento
+     * @param sensor Handle en TablaIds
+     * @param id Texto del id (se copia solo la primera vez)
+     */
+    void publicar(uint32_t sensor, char tipo, const char* id, float valor, float promedio,
+                  float minimo, float maximo, uint64_t lecturas) {
+        char* base = region.load(std::memory_order_acquire);
+        if (base != nullptr) escribir(base, sensor, tipo, id, valor, promedio, minimo, maximo, lecturas);
+    }
+
+    /// Actualiza solo el promedio (tras eliminar lecturas del historial)
+    void publicarPromedio(uint32_t sensor, float promedio);
+
+    /// Libera la entrada de un sensor dado de baja
+    void retirar(uint32_t sensor);
+
+    /// Lecturas que no se publicaron por tener un handle mayor que la capacidad
+    unsigned long getSinLugar() const { return sinLugar.load(); }
+
+private:
+    std::atomic<char*> region;
+    size_t bytes;
+    int fd;
+    std::atomic<unsigned long> sinLugar;
+
+    void escribir(char* base, uint32_t sensor, char tipo, const char* id, float valor, float promedio,
+                  float minimo, float maximo, uint64_t lecturas);
+    EntradaPublicada* entrada(char* base, uint32_t sensor);
+};
+
+/**
+ * @brief Lector para los procesos consumidores
+ *
+ * Después de abrir(), ninguna lectura hace llamadas al sistema.
+ */
+class LectorPublicacion {
+public:
+    LectorPublicacion() : region(nullptr), bytes(0) {}
+    ~LectorPublicacion();
+
+    LectorPublicacion(const LectorPublicacion&) = delete;
+    LectorPublicacion& operator=(const LectorPublicacion&) = delete;
+
+    /// Mapea en solo lectura una región creada con un nombre
+    bool abrir(const char* nombre);
+
+    /// Mapea una región a partir de su descriptor (p. ej. un memfd heredado)
+    bool abrirDescriptor(int fd);
+
+    /// Índices de la tabla que pueden estar ocupados: [0, getSensores())
+    uint32_t getSensores() const;
+
+    /**
+     * @brief Copia consistente de una entrada
+     * @return false si la ranura está libre o fuera de rango
+     */
+    bool leerSensor(uint32_t sensor, DatosSensorPublicados& destino) const;
+
+    /// Posición del próximo evento que se escribirá; sirve de cursor inicial
+    uint64_t getEventosEscritos() const;
+
+    /**
+     * @brief Copia los eventos desde cursor y lo avanza
+     * @param perdidos Se le suman los eventos pisados antes de leerlos
+     * @return Eventos copiados
+     */
+    size_t leerEventos(uint64_t& cursor, EventoPublicado* destino, size_t maximo, uint64_t& perdidos) const;
+
+private:
+    const char* region;
+    size_t bytes;
+
+    const CabeceraPublicacion* cabecera() const { return reinterpret_cast<const CabeceraPublicacion*>(region); }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef PUNTO_FIJO_H
+#define PUNTO_FIJO_H
+
+/**
+ * @file PuntoFijo.h
+ * @brief Valores de punto fijo con escala de compilación para los historiales
+ *
+ * Las lecturas reales caben en 16 bits con un factor de escala (temperatura
+ * de -40.0 a 125.0 °C en décimas, presión y vibración como enteros chicos).
+ * Guardarlas así reduce a la mitad lo que ocupa cada valor en el archivo de
+ * derrame, en las instantáneas por bloques y en los recorridos. Los nodos de
+ * ListaSensor no se achican: el puntero al siguiente fija su tamaño y
+ * alineación (16 bytes tanto con float como con 16 bits), así que la memoria
+ * residente de un historial no cambia. Las sumas se llevan en enteros de 64
+ * bits: agregar y quitar lecturas no acumula error y el promedio es exacto
+ * respecto de los valores guardados.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * @brief Número guardado como Entero = round(valor * Escala)
+ * @tparam Entero Tipo entero con signo del valor crudo
+ * @tparam Escala Unidades crudas por unidad real (10 = décimas)
+ *
+ * Se construye implícitamente desde float, double o int (redondeando y
+ * saturando al rango de Entero) y se lee como float, de modo que puede
+ * usarse como T en ListaSensor sin cambiar a quienes insertan o recorren.
+ */
+template <typename Entero, int Escala>
+class PuntoFijo {
+    static_assert(std::is_integral<Entero>::value && std::is_signed<Entero>::value,
+                  "PuntoFijo necesita un entero con signo");
+    static_assert(Escala > 0, "la escala debe ser positiva");
+
+public:
+    typedef Entero Crudo;
+    static constexpr int kEscala = Escala;
+
+    PuntoFijo() : crudo(0) {}
+    PuntoFijo(double valor) : crudo(convertir(valor)) {}
+
+    /// Valor real; la única conversión de lectura
+    operator float() const { return static_cast<float>(crudo) / Escala; }
+
+    Entero getCrudo() const { return crudo; }
+
+    /// true si valor no es representable (NaN o fuera de rango) y se guardaría recortado
+    static bool satura(double valor) {
+        double escalado = std::nearbyint(valor * Escala);
+        return !(escalado == escalado) || escalado < static_cast<double>(std::numeric_limits<Entero>::min()) ||
+               escalado > static_cast<double>(std::numeric_limits<Entero>::max());
+    }
+
+    static PuntoFijo desdeCrudo(Entero c) {
+        PuntoFijo p;
+        p.crudo = c;
+        return p;
+    }
+
+    /// Menor valor representable
+    static float minimo() { return static_cast<float>(std::numeric_limits<Entero>::min()) / Escala; }
+
+    /// Mayor valor representable
+    static float maximo() { return static_cast<float>(std::numeric_limits<Entero>::max()) / Escala; }
+
+    bool operator<(PuntoFijo otro) const { return crudo < otro.crudo; }
+    bool operator>(PuntoFijo otro) const { return crudo > otro.crudo; }
+    bool operator==(PuntoFijo otro) const { return crudo == otro.crudo; }
+    bool operator!=(PuntoFijo otro) const { return crudo != otro.crudo; }
+
+private:
+    Entero crudo;
+
+    static Entero convertir(double valor) {
+        double escalado = std::nearbyint(valor * Escala);
+        // Los NaN quedan en 0; fuera de rango se satura
+        if (!(escalado == escalado)) return 0;
+        if (escalado <= static_cast<double>(std::numeric_limits<Entero>::min())) return std::numeric_limits<Entero>::min();
+        if (escalado >= static_cast<double>(std::numeric_limits<Entero>::max())) return std::numeric_limits<Entero>::max();
+        return static_cast<Entero>(escalado);
+    }
+};
+
+template <typename Entero, int Escala>
+std::ostream& operator<<(std::ostream& os, PuntoFijo<Entero, Escala> valor) {
+    return os << static_cast<float>(valor);
+}
+
+/**
+ * @brief Suma exacta de valores PuntoFijo en crudo
+ *
+ * Sirve de Acumulador en ListaSensor: admite += y -= de valores y se lee
+ * como double ya dividido por la escala.
+ */
+template <typename Entero, int Escala>
+class SumaPuntoFijo {
+public:
+    SumaPuntoFijo(int cero = 0) : crudo(cero) {}
+
+    SumaPuntoFijo& operator+=(PuntoFijo<Entero, Escala> valor) {
+        crudo += valor.getCrudo();
+        return *this;
+    }
+
+    SumaPuntoFijo& operator-=(PuntoFijo<Entero, Escala> valor) {
+        crudo -= valor.getCrudo();
+        return *this;
+    }
+
+    explicit operator double() const { return static_cast<double>(crudo) / Escala; }
+
+    int64_t getCrudo() const { return crudo; }
+
+private:
+    int64_t crudo;
+};
+
+/// Temperatura en décimas de grado: -3276.8 a 3276.7
+typedef PuntoFijo<int16_t, 10> TemperaturaFija;
+
+/// Entero de 16 bits (presión, conteos de vibración): -32768 a 32767
+typedef PuntoFijo<int16_t, 1> EnteroFijo;
+
+#endif
@@ -1,15 +1,97 @@
 #include "SensorSystem.h"
 
 // Implementación de SensorBase
-SensorBase::SensorBase(const char* sensorId) {
-    strncpy(id, sensorId, sizeof(id) - 1);
-    id[sizeof(id) - 1] = '\0';
+SensorBase::SensorBase(const char* sensorId)
+    : idInterno(TablaIds::global().internar(sensorId)), sistema(nullptr), pendiente(false), retirado(false),
+      // Semilla por id: las monedas de las compactaciones no se repiten entre sensores
+      bosquejo(200, idInterno != TablaIds::kInvalido ? TablaIds::global().hash(idInterno) : BosquejoKLL::kSemillaFija),
+      ultimoAcceso(0), saturadas(0) {
+    id = idInterno != TablaIds::kInvalido ? TablaIds::global().texto(idInterno) : "";
 }
 
 SensorBase::~SensorBase() {
     // Destructor virtual puro - implementación requerida
 }
 
+void SensorBase::imprimirSaturadas() const {
+    unsigned long n = saturadas.load(std::memory_order_relaxed);
+    if (n > 0) std::cout << "  [WARN] " << n << " lecturas fuera de rango guardadas recortadas\n";
+}
+
 const char* SensorBase::getId() const {
     return id;
+}
+
+float SensorBase::cuantil(double q) const {
+    std::lock_guard<std::mutex> lock(cerrojo);
+    return bosquejo.cuantil(q);
+}
+
+void SensorBase::resumirBosquejo(ResumenSensor& resumen) const {
+    static const double fracciones[3] = {0.50, 0.95, 0.99};
+    float valores[3];
+    bosquejo.cuantiles(fracciones, valores, 3);
+    resumen.id = id;
+    resumen.tipo = getTipo();
+    resumen.p50 = valores[0];
+    resumen.p95 = valores[1];
+    resumen.p99 = valores[2];
+    resumen.saturadas = saturadas.load(std::memory_order_relaxed);
+}
+
+void SensorBase::fusionarBosquejoEn(BosquejoKLL& destino) const {
+    std::lock_guard<std::mutex> lock(cerrojo);
+    destino.fusionar(bosquejo);
+}
+
+void SensorBase::leerEstadisticas(int minutos, uint32_t periodo, EstadisticasSensor& e) const {
+    std::lock_guard<std::mutex> lock(cerrojo);
+    totalesHistorial(e.cantidad, e.suma);
+    e.minimo = bosquejo.getMinimo();
+    e.maximo = bosquejo.getMaximo();
+    if (minutos > 0) {
+        ventana.resumir(minutos, periodo, e.ventana);
+    } else {
+        e.ventana.periodo = periodo;
+        e.ventana.cantidad = 0;
+        e.ventana.minimo = e.ventana.maximo = 0.0f;
+        e.ventana.suma = 0.0;
+    }
+}
+
+void SensorBase::setParametrosDeteccion(const ParametrosDeteccion& parametros) {
+    std::lock_guard<std::mutex> lock(cerrojo);
+    detector.setParametros(parametros);
+}
+
+void SensorBase::notificarLectura(float valor, float promedio) {
+    bosquejo.agregar(valor);
+    ventana.agregar(valor, VentanaLecturas::periodoActual());
+    if (sistema != nullptr) {
+        // Solo se escribe cuando el reloj avanzó, no en cada lectura
+        uint32_t reloj = sistema->getRelojAcceso();
+        if (ultimoAcceso.load(std::memory_order_relaxed) != reloj) ultimoAcceso.store(reloj, std::memory_order_relaxed);
+    }
+    EventoAnomalia evento;
+    if (detector.evaluar(valor, evento) && sistema != nullptr) {
+        evento.sensorId = idInterno;
+        evento.tipoSensor = getTipo();
+        sistema->publicarAnomalia(evento);
+    }
+    if (sistema != nullptr) {
+        sistema->getClasificacion().actualizar(getTipo(), idInterno, valor, promedio, bosquejo.getMaximo());
+        sistema->getPublicador().publicar(idInterno, getTipo(), id, valor, promedio, bosquejo.getMinimo(),
+                                          bosquejo.getMaximo(), bosquejo.getCantidad());
+        sistema->getReglas().evaluar(estadoReglas, getTipo(), idInterno, valor);
+    }
+    if (sistema != nullptr && !pendiente.exchange(true)) {
+        sistema->marcarPendiente(this);
+    }
+}
+
+void SensorBase::notificarPromedio(float promedio) {
+    if (sistema != nullptr) {
+        sistema->getClasificacion().actualizarPromedio(getTipo(), idInterno, promedio);
+        sistema->getPublicador().publicarPromedio(idInterno, promedio);
+    }
 }
\ No newline at end of file
@@ -17,10 +17,53 @@
 
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <vector>
+#include "BosquejoKLL.h"
+#include "DetectorAnomalias.h"
+#include "ColaAcotada.h"
+#include "EscritorReporte.h"
+#include "VisitanteHistorial.h"
+#include "TablaIds.h"
+#include "ArchivoDerrame.h"
+#include "VentanaLecturas.h"
+#include "ClasificacionSensores.h"
+#include "PublicadorMemoria.h"
+#include "PuntoFijo.h"
+#include "Trazas.h"
+#include "MotorReglas.h"
+#include "ArenaNodos.h"
+
+/**
+ * @brief Activa los mensajes [Log] por nodo y por lectura
+ *
+ * Con millones de lecturas por segundo la consola es el cuello de botella;
+ * las pruebas de carga lo desactivan mientras corren.
+ */
+inline std::atomic<bool> logDetallado(true);
+
+inline bool logActivo() { return logDetallado.load(std::memory_order_relaxed); }
 
 /// Forward declarations
 template <typename T> struct Nodo;
 template <typename T> class ListaSensor;
+class SistemaGestion;
+class InstantaneaSensor;
+
+/**
+ * @brief Estadísticas de un sensor con las que se planifica una consulta
+ */
+struct EstadisticasSensor {
+    int cantidad;            ///< Lecturas en el historial
+    double suma;             ///< Suma de las lecturas del historial
+    float minimo;            ///< Cota inferior de cualquier lectura del historial
+    float maximo;            ///< Cota superior de cualquier lectura del historial
+    CubetaLecturas ventana;  ///< Totales de la ventana pedida (vacía si no se pidió)
+};
 
 /**
  * @brief Clase base abstracta que define la interfaz común para todos los sensores
@@ -29,8 +72,73 @@ template <typename T> class ListaSensor;
  * virtuales puros que deben ser implementados por las clases derivadas.
  */
 class SensorBase {
+    friend class SistemaGestion;
 protected:
-    char id[50]; ///< Identificador único del sensor
+    const char* id;              ///< Identificador único del sensor (texto en TablaIds)
+    uint32_t idInterno;          ///< Handle del identificador en TablaIds
+    mutable std::mutex cerrojo; ///< Serializa el acceso al historial del sensor
+    SistemaGestion* sistema;     ///< Sistema al que pertenece (lo asigna agregarSensor)
+    std::atomic<bool> pendiente; ///< Está en el conjunto de sensores con lecturas sin procesar
+    bool retirado;               ///< eliminarSensor() lo sacó de la lista (protegido por mtxPendientes)
+    BosquejoKLL bosquejo;        ///< Cuantiles aproximados de todas las lecturas registradas
+    DetectorAnomalias detector;  ///< Estado de la detección de anomalías en línea
+    std::atomic<uint32_t> ultimoAcceso; ///< Reloj de acceso del sistema en la última lectura
+    VentanaLecturas ventana;     ///< Totales por intervalo de la última hora
+    EstadoReglasSensor estadoReglas; ///< Reglas de alerta que aplican al sensor y su estado
+    std::atomic<unsigned long> saturadas; ///< Lecturas recortadas al rango del tipo del historial
+
+    /**
+     * @brief Convierte una lectura al tipo del historial, contando las que se recortan
+     *
+     * Las clases derivadas guardan y notifican el valor devuelto, no la
+     * lectura original: así el bosquejo, la ventana, las reglas y las
+     * consultas ven lo mismo que el historial.
+     */
+    template <typename Fijo>
+    Fijo convertirLectura(double lectura) {
+        if (Fijo::satura(lectura)) {
+            saturadas.fetch_add(1, std::memory_order_relaxed);
+            if (logActivo()) std::cout << "[WARN] Lectura " << lectura << " fuera de rango en " << id << "\n";
+        }
+        return Fijo(lectura);
+    }
+
+    /// Aviso de lecturas recortadas para imprimirInfo() (nada si no hubo)
+    void imprimirSaturadas() const;
+
+    /**
+     * @brief Avisa al sistema de que el historial cambió
+     *
+     * Las clases derivadas la llaman al final de registrarLectura(), con el
+     * cerrojo tomado; actualiza el bosquejo de cuantiles, evalúa el detector
+     * de anomalías (publicando un evento si corresponde) y, en la primera
+     * lectura tras un procesamiento, agrega el sensor al conjunto de pendientes.
+     * También actualiza la posición del sensor en las clasificaciones del sistema.
+     * @param valor Lectura recién registrada
+     * @param promedio Promedio del historial ya con la lectura
+     */
+    void notificarLectura(float valor, float promedio);
+
+    /**
+     * @brief Avisa de que el promedio cambió sin una lectura nueva
+     *
+     * Para las clases derivadas que eliminan lecturas del historial.
+     */
+    void notificarPromedio(float promedio);
+
+    /**
+     * @brief Completa id, tipo y percentiles de un resumen
+     *
+     * Las clases derivadas la llaman desde resumir() con el cerrojo tomado.
+     */
+    void resumirBosquejo(ResumenSensor& resumen) const;
+
+    /**
+     * @brief Cantidad y suma del historial
+     *
+     * La llama leerEstadisticas() con el cerrojo ya tomado.
+     */
+    virtual void totalesHistorial(int& cantidad, double& suma) const = 0;
 public:
     /**
      * @brief Constructor de la clase base
@@ -56,178 +164,893 @@ public:
      */
     virtual void procesarLectura() = 0;
 
+    /**
+     * @brief Procesa solo las lecturas registradas desde el último procesamiento
+     *
+     * Actualiza los resultados a partir del delta de lecturas nuevas en lugar
+     * de recorrer todo el historial.
+     */
+    virtual void procesarIncremental() = 0;
+
+    /**
+     * @brief Letra del tipo de sensor ('T', 'P' o 'V')
+     */
+    virtual char getTipo() const = 0;
+
     /**
      * @brief Imprime información del sensor y sus lecturas
      */
     virtual void imprimirInfo() const = 0;
 
+    /**
+     * @brief Llena la fila de reporte del sensor sin producir salida
+     * @param resumen Estructura a completar
+     */
+    virtual void resumir(ResumenSensor& resumen) const = 0;
+
+    /**
+     * @brief Entrega cada lectura del historial al visitante con su tipo real
+     *
+     * Se mantiene el cerrojo del sensor durante todo el recorrido; el
+     * visitante no debe volver a entrar en este sensor.
+     */
+    virtual void recorrerHistorial(VisitanteHistorial& visitante) const = 0;
+
+    /**
+     * @brief Vista inmutable del sensor en este instante
+     *
+     * Comparte los nodos del historial (no los copia); el llamador es dueño
+     * del objeto devuelto.
+     */
+    virtual InstantaneaSensor* tomarInstantanea() const = 0;
+
+    /**
+     * @brief Estadísticas del sensor sin recorrer el historial
+     *
+     * Las cotas salen del bosquejo, que recuerda también las lecturas ya
+     * eliminadas: ninguna lectura del historial queda fuera de ellas.
+     * @param minutos Ventana de tiempo a resumir (0 = ninguna)
+     * @param periodo Intervalo actual de VentanaLecturas
+     */
+    void leerEstadisticas(int minutos, uint32_t periodo, EstadisticasSensor& estadisticas) const;
+
+    /// Bytes de nodos del historial que ocupan memoria ahora mismo
+    virtual size_t getBytesResidentes() const = 0;
+
+    /**
+     * @brief Lleva el historial al archivo de derrame y libera sus nodos
+     *
+     * El historial vuelve a cargarse solo en cuanto algo lo modifica.
+     * @return Bytes de memoria liberados (0 si estaba vacío o ya derramado)
+     */
+    virtual size_t derramarHistorial(ArchivoDerrame& archivo) = 0;
+
+    /**
+     * @brief Descarta las lecturas menores y mayores del historial
+     *
+     * Para el rechazo de atípicos: cuesta O(n) sin importar cuántas se quiten.
+     * @return Lecturas eliminadas
+     */
+    virtual int recortarHistorial(int menores, int mayores) = 0;
+
+    /// Promedio del historial sin sus k lecturas menores ni sus k mayores, en O(n)
+    virtual float promedioRecortado(int k) const = 0;
+
+    /// Lecturas que no cabían en el tipo del historial y se guardaron recortadas
+    unsigned long getLecturasSaturadas() const { return saturadas.load(std::memory_order_relaxed); }
+
+    /// Valor de SistemaGestion::getRelojAcceso() en la última lectura registrada
+    uint32_t getUltimoAcceso() const { return ultimoAcceso.load(std::memory_order_relaxed); }
+
     /**
      * @brief Obtiene el identificador del sensor
      * @return Identificador del sensor
      */
     virtual const char* getId() const;
+
+    /// Handle del identificador en TablaIds::global()
+    uint32_t getIdInterno() const { return idInterno; }
+
+    /**
+     * @brief Cuantil aproximado de las lecturas registradas
+     *
+     * Se calcula sobre el bosquejo KLL del sensor, sin recorrer el historial.
+     * Las lecturas eliminadas por procesarLectura() siguen contando.
+     * @param q Fracción entre 0 y 1 (0.95 = p95)
+     */
+    float cuantil(double q) const;
+
+    /**
+     * @brief Fusiona el bosquejo de este sensor en otro (percentiles de flota)
+     */
+    void fusionarBosquejoEn(BosquejoKLL& destino) const;
+
+    /**
+     * @brief Ajusta la sensibilidad del detector de anomalías de este sensor
+     */
+    void setParametrosDeteccion(const ParametrosDeteccion& parametros);
 };
 
 /**
  * @brief Nodo genérico para la lista enlazada
  * @tparam T Tipo de dato a almacenar
+ *
+ * Los nodos se reservan en la arena del hilo que los crea (ArenaNodos.h).
  */
 template <typename T>
 struct Nodo {
     T dato;                ///< Dato almacenado en el nodo
+    std::atomic<int> referencias; ///< Punteros que llegan al nodo (anterior, lista o instantáneas)
     Nodo<T>* siguiente;    ///< Puntero al siguiente nodo
     
-    Nodo(T valor) : dato(valor), siguiente(nullptr) {
-        std::cout << "[Log] Nodo<" << typeid(T).name() << "> " << dato << " creado.\n";
+    Nodo(T valor) : dato(valor), referencias(1), siguiente(nullptr) {
+        if (logActivo()) std::cout << "[Log] Nodo<" << typeid(T).name() << "> " << dato << " creado.\n";
     }
     
     ~Nodo() {
-        std::cout << "[Log] Nodo<" << typeid(T).name() << "> " << dato << " liberado.\n";
+        if (logActivo()) std::cout << "[Log] Nodo<" << typeid(T).name() << "> " << dato << " liberado.\n";
+    }
+
+    static void* operator new(size_t bytes) { return ArenaNodos::reservar(bytes); }
+    static void operator delete(void* bloque, size_t bytes) { ArenaNodos::liberar(bloque, bytes); }
+};
+
+/**
+ * @brief Tipo con el que se acumulan las sumas de una lista de T
+ *
+ * Evita el desbordamiento de int y la pérdida de precisión de float al
+ * mantener la suma de miles de lecturas.
+ */
+template <typename T> struct Acumulador { typedef double tipo; };
+template <> struct Acumulador<int> { typedef long long tipo; };
+template <typename E, int S> struct Acumulador<PuntoFijo<E, S> > { typedef SumaPuntoFijo<E, S> tipo; };
+
+/**
+ * @brief Suelta una referencia a una cadena de nodos
+ *
+ * Libera los nodos que dejan de estar referenciados y se detiene en el
+ * primero que todavía comparte otra lista o instantánea.
+ */
+template <typename T>
+void soltarNodos(Nodo<T>* nodo) {
+    while (nodo != nullptr && nodo->referencias.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Nodo<T>* siguiente = nodo->siguiente;
+        delete nodo;
+        nodo = siguiente;
+    }
+}
+
+/**
+ * @brief Posición de un recorrido incremental sobre una vista del historial
+ */
+struct CursorHistorial {
+    int posicion;        ///< Lecturas ya entregadas
+    const void* nodo;    ///< Próximo nodo a leer; lo interpreta la vista
+
+    CursorHistorial() : posicion(0), nodo(nullptr) {}
+};
+
+/**
+ * @brief Vista inmutable de un ListaSensor en un instante
+ *
+ * Comparte los nodos con la lista (cuenta una referencia a la cabeza), por
+ * lo que tomarla es O(1). La lista solo agrega al final, donde la vista no
+ * mira porque recorre a lo sumo getCantidad() nodos, y eliminarMenor() copia
+ * el tramo compartido en lugar de modificarlo. Se puede leer desde otro hilo
+ * sin el cerrojo del sensor.
+ *
+ * Si la lista estaba derramada, la vista apunta a su región del archivo de
+ * derrame en lugar de a nodos, y la retiene hasta destruirse.
+ */
+template <typename T>
+class InstantaneaLista {
+private:
+    typedef typename Acumulador<T>::tipo Suma;
+
+    Nodo<T>* cabeza;
+    int cantidad;
+    Suma suma;
+    ArchivoDerrame* archivo;   ///< Origen de los valores si no hay nodos
+    RegionDerrame* region;     ///< Región retenida en archivo
+
+    void soltar() {
+        soltarNodos(cabeza);
+        if (archivo != nullptr) archivo->soltar(region);
+    }
+
+public:
+    InstantaneaLista() : cabeza(nullptr), cantidad(0), suma(0), archivo(nullptr), region(nullptr) {}
+
+    /// Adopta una referencia ya contada a cabeza
+    InstantaneaLista(Nodo<T>* c, int n, Suma s)
+        : cabeza(c), cantidad(n), suma(s), archivo(nullptr), region(nullptr) {}
+
+    /// Vista de una lista derramada: adopta una referencia ya contada a la región
+    InstantaneaLista(ArchivoDerrame* a, RegionDerrame* r, int n, Suma s)
+        : cabeza(nullptr), cantidad(n), suma(s), archivo(a), region(r) {}
+
+    ~InstantaneaLista() { soltar(); }
+
+    InstantaneaLista(const InstantaneaLista&) = delete;
+    InstantaneaLista& operator=(const InstantaneaLista&) = delete;
+
+    InstantaneaLista(InstantaneaLista&& otra)
+        : cabeza(otra.cabeza), cantidad(otra.cantidad), suma(otra.suma),
+          archivo(otra.archivo), region(otra.region) {
+        otra.cabeza = nullptr;
+        otra.cantidad = 0;
+        otra.suma = 0;
+        otra.archivo = nullptr;
+    }
+
+    InstantaneaLista& operator=(InstantaneaLista&& otra) {
+        if (this != &otra) {
+            soltar();
+            cabeza = otra.cabeza;
+            cantidad = otra.cantidad;
+            suma = otra.suma;
+            archivo = otra.archivo;
+            region = otra.region;
+            otra.cabeza = nullptr;
+            otra.cantidad = 0;
+            otra.suma = 0;
+            otra.archivo = nullptr;
+        }
+        return *this;
+    }
+
+    int getCantidad() const { return cantidad; }
+
+    float calcularPromedio() const {
+        if (cantidad == 0) return 0.0f;
+        return static_cast<float>(static_cast<double>(suma) / cantidad);
+    }
+
+    /**
+     * @brief Recorre las lecturas de la vista en orden de inserción
+     * @param f Invocable con firma void(const T&)
+     */
+    template <typename F>
+    void paraCada(F f) const {
+        if (archivo != nullptr) {
+            recorrerDerrame<T>(*archivo, region->desplazamiento, 0, cantidad, f);
+            return;
+        }
+        Nodo<T>* actual = cabeza;
+        for (int i = 0; i < cantidad; ++i) {
+            f(actual->dato);
+            // No leer el enlace del último: la lista puede estar agregando ahí
+            if (i + 1 < cantidad) actual = actual->siguiente;
+        }
+    }
+
+    /**
+     * @brief Recorre las lecturas en bloques contiguos de hasta kValoresPorBloque
+     *
+     * Pensado para núcleos que procesan arreglos (el compilador puede
+     * vectorizarlos) en lugar de un valor por llamada.
+     * @param f Invocable con firma void(const T*, int)
+     */
+    template <typename F>
+    void paraCadaBloque(F f) const {
+        T bloque[ArchivoDerrame::kValoresPorBloque];
+        int n = 0;
+        paraCada([&](T valor) {
+            bloque[n++] = valor;
+            if (n == ArchivoDerrame::kValoresPorBloque) {
+                f(static_cast<const T*>(bloque), n);
+                n = 0;
+            }
+        });
+        if (n > 0) f(static_cast<const T*>(bloque), n);
+    }
+
+    /**
+     * @brief Copia como float hasta maximo lecturas desde el cursor y lo avanza
+     *
+     * Permite recorrer varias vistas a la par sin copiar sus historiales.
+     * @return Lecturas copiadas (0 al llegar al final o si falló el archivo)
+     */
+    int leerValores(CursorHistorial& cursor, float* destino, int maximo) const {
+        int n = cantidad - cursor.posicion;
+        if (n > maximo) n = maximo;
+        if (n <= 0) return 0;
+        if (archivo != nullptr) {
+            int i = 0;
+            if (!recorrerDerrame<T>(*archivo, region->desplazamiento, cursor.posicion, cursor.posicion + n,
+                                    [&](T valor) { destino[i++] = static_cast<float>(valor); })) {
+                cursor.posicion = cantidad;   // No se puede seguir leyendo la región
+                return i;
+            }
+            cursor.posicion += n;
+            return n;
+        }
+        const Nodo<T>* actual = cursor.posicion == 0 ? cabeza : static_cast<const Nodo<T>*>(cursor.nodo);
+        for (int i = 0; i < n; ++i) {
+            destino[i] = static_cast<float>(actual->dato);
+            if (cursor.posicion + i + 1 < cantidad) actual = actual->siguiente;
+        }
+        cursor.posicion += n;
+        cursor.nodo = actual;
+        return n;
+    }
+
+    /// Saltea n lecturas sin leerlas (con la vista derramada no toca el archivo)
+    void avanzar(CursorHistorial& cursor, int n) const {
+        if (n > cantidad - cursor.posicion) n = cantidad - cursor.posicion;
+        if (n <= 0) return;
+        if (archivo == nullptr) {
+            const Nodo<T>* actual = cursor.posicion == 0 ? cabeza : static_cast<const Nodo<T>*>(cursor.nodo);
+            for (int i = 0; i < n; ++i) {
+                if (cursor.posicion + i + 1 < cantidad) actual = actual->siguiente;
+            }
+            cursor.nodo = actual;
+        }
+        cursor.posicion += n;
     }
 };
 
 /**
  * @brief Lista enlazada genérica para almacenar lecturas de sensores
- * @tparam T Tipo de dato de las lecturas (float para temperatura, int para presión)
+ * @tparam T Tipo de dato de las lecturas (float, int o un PuntoFijo como TemperaturaFija)
  * 
  * Esta clase implementa la Regla de los Tres (destructor, constructor de copia y
  * operador de asignación) para asegurar una correcta gestión de memoria.
+ *
+ * Además de la cabeza guarda la cola (inserción O(1)), la suma de los valores
+ * (promedio O(1)) y una marca con el último nodo ya procesado, de modo que el
+ * procesamiento incremental solo recorre las lecturas nuevas.
+ *
+ * La lista puede derramarse al ArchivoDerrame: sus valores se escriben en el
+ * archivo y los nodos se liberan, pero cantidad, suma, nuevas y la posición
+ * de la marca se conservan. Las consultas que solo usan esos datos (promedio,
+ * cantidad) no tocan el archivo; los recorridos lo leen por bloques, y las
+ * operaciones que modifican la lista la vuelven a cargar primero.
  */
 template <typename T>
 class ListaSensor {
 private:
+    typedef typename Acumulador<T>::tipo Suma;
+
     Nodo<T>* cabeza;    ///< Puntero al primer nodo de la lista
+    Nodo<T>* cola;      ///< Puntero al último nodo de la lista
+    Nodo<T>* marca;     ///< Último nodo procesado (nullptr: ninguno)
     int cantidad;       ///< Cantidad de lecturas almacenadas
+    int nuevas;         ///< Lecturas posteriores a la marca
+    Suma suma;          ///< Suma de todas las lecturas almacenadas
+    ArchivoDerrame* derrame;  ///< Archivo con los valores mientras la lista está derramada
+    RegionDerrame* region;    ///< Región de los valores en derrame (una referencia)
+    int posicionMarca;        ///< Lecturas hasta la marca inclusive, mientras está derramada
+
+    void liberar() {
+        // Los nodos que comparte una instantánea siguen vivos hasta que ella los suelte
+        soltarNodos(cabeza);
+        cabeza = nullptr;
+        cola = nullptr;
+        marca = nullptr;
+        cantidad = 0;
+        nuevas = 0;
+        suma = 0;
+        if (derrame != nullptr) derrame->soltar(region);
+        derrame = nullptr;
+    }
+
+    /// Reconstruye los nodos a partir de la región del archivo
+    void restaurar() {
+        ArchivoDerrame* archivo = derrame;
+        derrame = nullptr;
+        int esperadas = cantidad;
+        int indice = 0;
+        Suma leida = 0;
+        bool completa = recorrerDerrame<T>(*archivo, region->desplazamiento, 0, esperadas, [&](T valor) {
+            Nodo<T>* nodo = new Nodo<T>(valor);
+            if (cabeza == nullptr) cabeza = nodo; else cola->siguiente = nodo;
+            cola = nodo;
+            leida += valor;
+            if (++indice == posicionMarca) marca = nodo;
+        });
+        archivo->contarRecuperacion();
+        // Las instantáneas que la siguen leyendo conservan sus propias referencias
+        archivo->soltar(region);
+        if (!completa) {
+            // Se conserva lo que pudo leerse; las cuentas pasan a describir eso
+            std::cerr << "[ERR] Historial derramado ilegible: se recuperaron " << indice
+                      << " de " << esperadas << " lecturas.\n";
+            cantidad = indice;
+            suma = leida;
+            if (posicionMarca > indice) marca = cola;
+            if (nuevas > indice) nuevas = indice;
+        }
+    }
+
+    void copiarValores(std::vector<T>& destino) const {
+        destino.reserve(static_cast<size_t>(cantidad));
+        paraCadaBloque([&destino](const T* valores, int n) { destino.insert(destino.end(), valores, valores + n); });
+    }
+
+    /**
+     * @brief Quita las k lecturas más extremas según antes(a, b) = "a es más extrema que b"
+     *
+     * Los nodos anteriores al primero que comparte una instantánea se quitan
+     * en el lugar; desde ese nodo hasta la última lectura eliminada se
+     * copian los que se conservan (copia de ruta, como en eliminarMenor()) y
+     * la copia se engancha con el resto, que no cambia.
+     */
+    template <typename Antes>
+    int eliminarExtremos(int k, Antes antes) {
+        if (derrame != nullptr) restaurar();
+        if (k <= 0 || cabeza == nullptr) return 0;
+        if (k > cantidad) k = cantidad;
+
+        // Selección: el umbral es la k-ésima más extrema
+        std::vector<T> valores;
+        copiarValores(valores);
+        std::nth_element(valores.begin(), valores.begin() + (k - 1), valores.end(), antes);
+        T umbral = valores[k - 1];
+        int empates = k;
+        for (int i = 0; i < k - 1; ++i) {
+            if (antes(valores[i], umbral)) --empates;
+        }
+
+        // Compactación en una pasada
+        Nodo<T>* nuevaCabeza = nullptr;
+        Nodo<T>* previo = nullptr;        // Último nodo conservado de la lista nueva
+        Nodo<T>* compartido = nullptr;    // Primer nodo que ve alguna instantánea
+        Nodo<T>* actual = cabeza;
+        bool trasMarca = (marca == nullptr);
+        int restantes = k;
+        while (actual != nullptr && restantes > 0) {
+            Nodo<T>* siguiente = actual->siguiente;
+            if (compartido == nullptr && actual->referencias.load(std::memory_order_acquire) > 1) {
+                compartido = actual;
+            }
+            bool esMarca = (actual == marca);
+            bool quitar = antes(actual->dato, umbral) || (!antes(umbral, actual->dato) && empates > 0);
+            if (quitar) {
+                if (!antes(actual->dato, umbral)) --empates;
+                --restantes;
+                suma -= actual->dato;
+                if (trasMarca) --nuevas;
+                if (esMarca) marca = previo;
+                if (compartido == nullptr) delete actual;
+            } else {
+                Nodo<T>* conservado = compartido == nullptr ? actual : new Nodo<T>(actual->dato);
+                if (previo == nullptr) nuevaCabeza = conservado; else previo->siguiente = conservado;
+                previo = conservado;
+                if (esMarca) marca = conservado;
+            }
+            if (esMarca) trasMarca = true;
+            actual = siguiente;
+        }
+
+        // El resto de la lista se reutiliza tal cual
+        if (compartido != nullptr && actual != nullptr) actual->referencias.fetch_add(1, std::memory_order_relaxed);
+        if (previo == nullptr) nuevaCabeza = actual; else previo->siguiente = actual;
+        if (compartido != nullptr) soltarNodos(compartido);
+        cabeza = nuevaCabeza;
+        if (actual == nullptr) cola = previo;
+        cantidad -= k;
+        if (logActivo()) std::cout << "[Log] Eliminadas " << k << " lecturas extremas (umbral " << umbral << ")\n";
+        return k;
+    }
 
 public:
-    ListaSensor() : cabeza(nullptr), cantidad(0) {
-        std::cout << "[Log] ListaSensor<" << typeid(T).name() << "> creada.\n";
+    ListaSensor()
+        : cabeza(nullptr), cola(nullptr), marca(nullptr), cantidad(0), nuevas(0), suma(0),
+          derrame(nullptr), region(nullptr), posicionMarca(0) {
+        if (logActivo()) std::cout << "[Log] ListaSensor<" << typeid(T).name() << "> creada.\n";
     }
     
     ~ListaSensor() {
-        std::cout << "[Destructor ListaSensor] Liberando lista interna...\n";
-        Nodo<T>* actual = cabeza;
-        while (actual != nullptr) {
-            Nodo<T>* temp = actual;
-            actual = actual->siguiente;
-            delete temp;
-        }
-        cabeza = nullptr;
+        if (logActivo()) std::cout << "[Destructor ListaSensor] Liberando lista interna...\n";
+        liberar();
     }
     
     // Constructor de copia
-    ListaSensor(const ListaSensor& other) : cabeza(nullptr), cantidad(0) {
-        Nodo<T>* actual = other.cabeza;
-        while (actual != nullptr) {
-            insertar(actual->dato);
-            actual = actual->siguiente;
-        }
+    ListaSensor(const ListaSensor& other)
+        : cabeza(nullptr), cola(nullptr), marca(nullptr), cantidad(0), nuevas(0), suma(0),
+          derrame(nullptr), region(nullptr), posicionMarca(0) {
+        other.paraCada([this](T valor) { insertar(valor); });
     }
     
     // Operador de asignación
     ListaSensor& operator=(const ListaSensor& other) {
         if (this != &other) {
             // Liberar memoria actual
-            Nodo<T>* actual = cabeza;
-            while (actual != nullptr) {
-                Nodo<T>* temp = actual;
-                actual = actual->siguiente;
-                delete temp;
-            }
-            cabeza = nullptr;
-            cantidad = 0;
+            liberar();
             
             // Copiar datos
-            actual = other.cabeza;
-            while (actual != nullptr) {
-                insertar(actual->dato);
-                actual = actual->siguiente;
-            }
+            other.paraCada([this](T valor) { insertar(valor); });
         }
         return *this;
     }
     
     void insertar(T valor) {
+        if (derrame != nullptr) restaurar();
         Nodo<T>* nuevoNodo = new Nodo<T>(valor);
         
         if (cabeza == nullptr) {
             cabeza = nuevoNodo;
         } else {
-            Nodo<T>* actual = cabeza;
-            while (actual->siguiente != nullptr) {
-                actual = actual->siguiente;
-            }
-            actual->siguiente = nuevoNodo;
+            cola->siguiente = nuevoNodo;
         }
+        cola = nuevoNodo;
         cantidad++;
-        std::cout << "[Log] Insertando Nodo<" << typeid(T).name() << "> valor: " << valor << "\n";
+        nuevas++;
+        suma += valor;
+        if (logActivo()) std::cout << "[Log] Insertando Nodo<" << typeid(T).name() << "> valor: " << valor << "\n";
     }
     
     void eliminarMenor() {
+        if (derrame != nullptr) restaurar();
         if (cabeza == nullptr) return;
         
         Nodo<T>* anterior = nullptr;
         Nodo<T>* actual = cabeza;
         Nodo<T>* menorAnterior = nullptr;
         Nodo<T>* menor = cabeza;
+        bool menorEsNuevo = (marca == nullptr);
+        bool trasMarca = (marca == nullptr);
         
         // Encontrar el nodo con el valor menor
         while (actual != nullptr) {
             if (actual->dato < menor->dato) {
                 menor = actual;
                 menorAnterior = anterior;
+                menorEsNuevo = trasMarca;
             }
+            if (actual == marca) trasMarca = true;
             anterior = actual;
             actual = actual->siguiente;
         }
         
-        // Eliminar el nodo menor
-        if (menorAnterior == nullptr) {
-            cabeza = menor->siguiente;
+        if (menorEsNuevo) nuevas--;
+        if (logActivo()) std::cout << "[Log] Eliminando valor menor: " << menor->dato << "\n";
+        suma -= menor->dato;
+
+        // Primer nodo del tramo cabeza..menor que comparte alguna instantánea
+        Nodo<T>* previoUnico = nullptr;
+        Nodo<T>* compartido = nullptr;
+        for (Nodo<T>* n = cabeza; ; n = n->siguiente) {
+            if (n->referencias.load(std::memory_order_acquire) > 1) {
+                compartido = n;
+                break;
+            }
+            if (n == menor) break;
+            previoUnico = n;
+        }
+
+        if (compartido == nullptr) {
+            // Nadie más ve este tramo: eliminar el nodo menor en el lugar
+            if (menorAnterior == nullptr) {
+                cabeza = menor->siguiente;
+            } else {
+                menorAnterior->siguiente = menor->siguiente;
+            }
+            if (cola == menor) cola = menorAnterior;
+            if (marca == menor) marca = menorAnterior;
+            delete menor;
         } else {
-            menorAnterior->siguiente = menor->siguiente;
+            // Copia de ruta: se duplican los nodos compartidos anteriores al menor
+            // y la copia se engancha con el resto; las instantáneas no cambian
+            Nodo<T>* primeraCopia = nullptr;
+            Nodo<T>* ultimaCopia = nullptr;
+            for (Nodo<T>* n = compartido; n != menor; n = n->siguiente) {
+                Nodo<T>* copia = new Nodo<T>(n->dato);
+                if (ultimaCopia == nullptr) primeraCopia = copia; else ultimaCopia->siguiente = copia;
+                if (marca == n) marca = copia;
+                ultimaCopia = copia;
+            }
+            Nodo<T>* resto = menor->siguiente;
+            if (resto != nullptr) resto->referencias.fetch_add(1, std::memory_order_relaxed);
+            if (ultimaCopia == nullptr) primeraCopia = resto; else ultimaCopia->siguiente = resto;
+            if (previoUnico == nullptr) cabeza = primeraCopia; else previoUnico->siguiente = primeraCopia;
+
+            Nodo<T>* nuevoAnterior = ultimaCopia != nullptr ? ultimaCopia : previoUnico;
+            if (cola == menor) cola = nuevoAnterior;
+            if (marca == menor) marca = nuevoAnterior;
+            soltarNodos(compartido);
         }
-        
-        std::cout << "[Log] Eliminando valor menor: " << menor->dato << "\n";
-        delete menor;
         cantidad--;
     }
     
-    float calcularPromedio() const {
-        if (cabeza == nullptr) return 0.0f;
-        
-        T suma = 0;
-        Nodo<T>* actual = cabeza;
-        int count = 0;
-        
-        while (actual != nullptr) {
-            suma += actual->dato;
-            actual = actual->siguiente;
-            count++;
+    /**
+     * @brief Elimina las k lecturas menores en O(n)
+     *
+     * Una selección lineal (nth_element sobre una copia de los valores) fija
+     * el umbral y una sola pasada compacta la lista. Entre valores iguales al
+     * umbral se eliminan los más antiguos, como haría eliminarMenor() k veces.
+     * @return Lecturas eliminadas
+     */
+    int eliminarMenores(int k) {
+        return eliminarExtremos(k, [](const T& a, const T& b) { return a < b; });
+    }
+
+    /// Como eliminarMenores() para las k lecturas mayores
+    int eliminarMayores(int k) {
+        return eliminarExtremos(k, [](const T& a, const T& b) { return b < a; });
+    }
+
+    /**
+     * @brief Promedio sin las k lecturas menores ni las k mayores, en O(n)
+     *
+     * No modifica la lista. Si 2k no deja lecturas en el centro devuelve la
+     * mediana (la superior si la cantidad es par), y 0 si la lista está vacía.
+     */
+    float calcularPromedioRecortado(int k) const {
+        if (cantidad == 0) return 0.0f;
+        if (k <= 0) return calcularPromedio();
+        std::vector<T> valores;
+        copiarValores(valores);
+        int n = static_cast<int>(valores.size());
+        if (2 * k >= n) {
+            std::nth_element(valores.begin(), valores.begin() + n / 2, valores.end());
+            return static_cast<float>(valores[n / 2]);
         }
-        
-        return static_cast<float>(suma) / count;
+        // Primero las k menores al frente y luego las k mayores al fondo
+        std::nth_element(valores.begin(), valores.begin() + k, valores.end());
+        std::nth_element(valores.begin() + k, valores.end() - k, valores.end());
+        Suma centro = 0;
+        for (int i = k; i < n - k; ++i) centro += valores[i];
+        return static_cast<float>(static_cast<double>(centro) / (n - 2 * k));
+    }
+
+    float calcularPromedio() const {
+        if (cantidad == 0) return 0.0f;
+        return static_cast<float>(static_cast<double>(suma) / cantidad);
     }
     
     int getCantidad() const { return cantidad; }
+
+    double getSuma() const { return static_cast<double>(suma); }
+
+    bool estaDerramada() const { return derrame != nullptr; }
+
+    /// Bytes de nodos que la lista mantiene en memoria
+    size_t getBytesResidentes() const {
+        return derrame != nullptr ? 0 : static_cast<size_t>(cantidad) * sizeof(Nodo<T>);
+    }
+
+    /**
+     * @brief Escribe los valores en el archivo y libera los nodos
+     *
+     * Las instantáneas que compartían nodos los conservan hasta soltarlos.
+     * @return false si la lista estaba vacía o ya derramada, o si falló la escritura
+     */
+    bool derramar(ArchivoDerrame& archivo) {
+        if (derrame != nullptr || cabeza == nullptr || !archivo.estaAbierto()) return false;
+        RegionDerrame* nueva = archivo.reservar(static_cast<size_t>(cantidad) * sizeof(T));
+        T bloque[ArchivoDerrame::kValoresPorBloque];
+        int enBloque = 0;
+        int indice = 0;
+        uint64_t escrito = nueva->desplazamiento;
+        posicionMarca = 0;
+        for (Nodo<T>* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            bloque[enBloque++] = actual->dato;
+            if (actual == marca) posicionMarca = indice + 1;
+            ++indice;
+            if (enBloque == ArchivoDerrame::kValoresPorBloque || actual->siguiente == nullptr) {
+                if (!archivo.escribir(escrito, bloque, enBloque * sizeof(T))) {
+                    archivo.soltar(nueva);
+                    return false;
+                }
+                escrito += static_cast<uint64_t>(enBloque) * sizeof(T);
+                enBloque = 0;
+            }
+        }
+        soltarNodos(cabeza);
+        cabeza = nullptr;
+        cola = nullptr;
+        marca = nullptr;
+        derrame = &archivo;
+        region = nueva;
+        return true;
+    }
+
+    /**
+     * @brief Vista inmutable del historial actual, en O(1)
+     *
+     * Debe llamarse con el mismo cerrojo que protege las escrituras de la
+     * lista; la vista resultante puede leerse luego sin él.
+     */
+    InstantaneaLista<T> instantanea() const {
+        if (derrame != nullptr) {
+            derrame->retener(region);
+            return InstantaneaLista<T>(derrame, region, cantidad, suma);
+        }
+        if (cabeza != nullptr) cabeza->referencias.fetch_add(1, std::memory_order_relaxed);
+        return InstantaneaLista<T>(cabeza, cantidad, suma);
+    }
     
     T getPrimero() const {
         if (cabeza != nullptr) {
             return cabeza->dato;
         }
-        return T();
+        T primero = T();
+        if (derrame != nullptr && cantidad > 0) {
+            recorrerDerrame<T>(*derrame, region->desplazamiento, 0, 1, [&primero](T valor) { primero = valor; });
+        }
+        return primero;
+    }
+
+    /// Cantidad de lecturas insertadas desde la última llamada a marcarProcesadas()
+    int getNuevas() const { return nuevas; }
+
+    /**
+     * @brief Recorre todas las lecturas en orden de inserción
+     * @param f Invocable con firma void(const T&)
+     */
+    template <typename F>
+    void paraCada(F f) const {
+        if (derrame != nullptr) {
+            recorrerDerrame<T>(*derrame, region->desplazamiento, 0, cantidad, f);
+            return;
+        }
+        for (Nodo<T>* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            f(actual->dato);
+        }
+    }
+
+    /**
+     * @brief Recorre las lecturas en bloques contiguos de hasta kValoresPorBloque
+     *
+     * Pensado para núcleos que procesan arreglos (el compilador puede
+     * vectorizarlos) en lugar de un valor por llamada.
+     * @param f Invocable con firma void(const T*, int)
+     */
+    template <typename F>
+    void paraCadaBloque(F f) const {
+        T bloque[ArchivoDerrame::kValoresPorBloque];
+        int n = 0;
+        paraCada([&](T valor) {
+            bloque[n++] = valor;
+            if (n == ArchivoDerrame::kValoresPorBloque) {
+                f(static_cast<const T*>(bloque), n);
+                n = 0;
+            }
+        });
+        if (n > 0) f(static_cast<const T*>(bloque), n);
+    }
+
+    /**
+     * @brief Recorre solo las lecturas posteriores a la marca de procesamiento
+     * @param f Invocable con firma void(const T&)
+     */
+    template <typename F>
+    void paraCadaNueva(F f) const {
+        if (derrame != nullptr) {
+            recorrerDerrame<T>(*derrame, region->desplazamiento, posicionMarca, cantidad, f);
+            return;
+        }
+        Nodo<T>* actual = (marca == nullptr) ? cabeza : marca->siguiente;
+        while (actual != nullptr) {
+            f(actual->dato);
+            actual = actual->siguiente;
+        }
+    }
+
+    /// Mueve la marca al final: las lecturas actuales dejan de ser nuevas
+    void marcarProcesadas() {
+        marca = cola;
+        posicionMarca = cantidad;
+        nuevas = 0;
     }
 };
 
+/**
+ * @brief Vista inmutable de un sensor: identidad, bosquejo e historial
+ *
+ * Sobrevive al sensor: si este se elimina, la vista conserva sus datos.
+ */
+class InstantaneaSensor {
+protected:
+    const char* id;          ///< Texto en TablaIds, válido siempre
+    uint32_t idInterno;
+    char tipo;
+    BosquejoKLL bosquejo;    ///< Copia del bosquejo al tomar la vista
+    unsigned long saturadas; ///< Lecturas recortadas hasta tomar la vista
+
+public:
+    InstantaneaSensor(const char* i, uint32_t interno, char t, const BosquejoKLL& b, unsigned long sat)
+        : id(i), idInterno(interno), tipo(t), bosquejo(b), saturadas(sat) {}
+    virtual ~InstantaneaSensor() {}
+
+    const char* getId() const { return id; }
+    uint32_t getIdInterno() const { return idInterno; }
+    char getTipo() const { return tipo; }
+
+    /// Igual que SensorBase::resumir(), sobre los datos de la vista
+    virtual void resumir(ResumenSensor& resumen) const = 0;
+
+    /// Igual que SensorBase::recorrerHistorial(), sin cerrojos
+    virtual void recorrerHistorial(VisitanteHistorial& visitante) const = 0;
+
+    /// Lecturas de la vista
+    virtual int getCantidad() const = 0;
+
+    /**
+     * @brief Recorrido por partes: copia hasta maximo lecturas como float
+     *
+     * Un cursor nuevo empieza en la lectura más vieja. Sirve para avanzar
+     * sobre varias vistas a la vez, cosa que recorrerHistorial() no permite.
+     * @return Lecturas copiadas; 0 al final
+     */
+    virtual int leerValores(CursorHistorial& cursor, float* destino, int maximo) const = 0;
+
+    /// Saltea n lecturas del cursor
+    virtual void avanzar(CursorHistorial& cursor, int n) const = 0;
+};
+
+/**
+ * @brief Entrega un bloque del historial con el tipo que espera el visitante
+ */
+inline void entregarBloque(VisitanteHistorial& visitante, const float* valores, int n) {
+    visitante.visitarBloque(valores, n);
+}
+inline void entregarBloque(VisitanteHistorial& visitante, const int* valores, int n) {
+    visitante.visitarBloque(valores, n);
+}
+
+/// Un bloque en punto fijo se convierte a float, o a int si la escala es 1
+template <typename E, int S>
+void entregarBloque(VisitanteHistorial& visitante, const PuntoFijo<E, S>* valores, int n) {
+    typedef typename std::conditional<S == 1, int, float>::type Destino;
+    Destino convertidos[ArchivoDerrame::kValoresPorBloque];
+    for (int i = 0; i < n; ++i) convertidos[i] = static_cast<Destino>(static_cast<float>(valores[i]));
+    visitante.visitarBloque(static_cast<const Destino*>(convertidos), n);
+}
+
+/**
+ * @brief InstantaneaSensor de un historial de T
+ */
+template <typename T>
+class InstantaneaHistorial : public InstantaneaSensor {
+private:
+    InstantaneaLista<T> historial;
+
+public:
+    InstantaneaHistorial(const char* i, uint32_t interno, char t, const BosquejoKLL& b, unsigned long sat,
+                         InstantaneaLista<T>&& h)
+        : InstantaneaSensor(i, interno, t, b, sat), historial(std::move(h)) {}
+
+    void resumir(ResumenSensor& resumen) const override {
+        static const double fracciones[3] = {0.50, 0.95, 0.99};
+        float valores[3];
+        bosquejo.cuantiles(fracciones, valores, 3);
+        resumen.id = id;
+        resumen.tipo = tipo;
+        resumen.lecturas = static_cast<size_t>(historial.getCantidad());
+        resumen.promedio = historial.calcularPromedio();
+        resumen.p50 = valores[0];
+        resumen.p95 = valores[1];
+        resumen.p99 = valores[2];
+        resumen.saturadas = saturadas;
+    }
+
+    void recorrerHistorial(VisitanteHistorial& visitante) const override {
+        visitante.comenzarSensor(id, tipo, historial.getCantidad());
+        historial.paraCadaBloque([&visitante](const T* valores, int n) { entregarBloque(visitante, valores, n); });
+        visitante.terminarSensor();
+    }
+
+    int getCantidad() const override { return historial.getCantidad(); }
+
+    int leerValores(CursorHistorial& cursor, float* destino, int maximo) const override {
+        return historial.leerValores(cursor, destino, maximo);
+    }
+
+    void avanzar(CursorHistorial& cursor, int n) const override { historial.avanzar(cursor, n); }
+};
+
 /**
  * @brief Clase concreta para sensores de temperatura
  * 
- * Implementa la lógica específica para el manejo de lecturas de temperatura
- * usando valores de punto flotante (float).
+ * Implementa la lógica específica para el manejo de lecturas de temperatura.
+ * El historial guarda décimas de grado en 16 bits (TemperaturaFija).
  */
 class SensorTemperatura : public SensorBase {
 private:
-    ListaSensor<float> historial; ///< Historial de lecturas de temperatura
+    ListaSensor<TemperaturaFija> historial; ///< Historial de lecturas de temperatura
 
 public:
     SensorTemperatura(const char* sensorId) : SensorBase(sensorId) {
@@ -239,17 +1062,23 @@ public:
     }
     
     void registrarLectura(float lectura) override {
-        historial.insertar(lectura);
-        std::cout << "[Temperatura] Registrada lectura: " << lectura << " en " << id << "\n";
+        TramoTraza traza("registrarLectura", idInterno);
+        std::lock_guard<std::mutex> lock(cerrojo);
+        TemperaturaFija guardada = convertirLectura<TemperaturaFija>(lectura);
+        historial.insertar(guardada);
+        if (logActivo()) std::cout << "[Temperatura] Registrada lectura: " << guardada << " en " << id << "\n";
+        notificarLectura(guardada, historial.calcularPromedio());
     }
     
     void procesarLectura() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[Procesando Temperatura " << id << "] ";
         int lecturasAntes = historial.getCantidad();
         
         if (lecturasAntes > 1) {
             historial.eliminarMenor();
             float promedio = historial.calcularPromedio();
+            notificarPromedio(promedio);
             std::cout << "Lectura mas baja eliminada. Promedio restante: " << promedio 
                       << " sobre " << historial.getCantidad() << " lecturas.\n";
         } else if (lecturasAntes == 1) {
@@ -258,12 +1087,88 @@ public:
         } else {
             std::cout << "No hay lecturas para procesar.\n";
         }
+        historial.marcarProcesadas();
+    }
+    
+    void procesarIncremental() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int nuevas = historial.getNuevas();
+        if (nuevas == 0) return;
+        
+        double sumaNuevas = 0.0;
+        float minimo = 0.0f, maximo = 0.0f;
+        bool primera = true;
+        historial.paraCadaNueva([&](float valor) {
+            sumaNuevas += valor;
+            if (primera || valor < minimo) minimo = valor;
+            if (primera || valor > maximo) maximo = valor;
+            primera = false;
+        });
+        historial.marcarProcesadas();
+        std::cout << "[Incremental Temperatura " << id << "] Nuevas: " << nuevas
+                  << ", Promedio nuevas: " << sumaNuevas / nuevas
+                  << ", Rango: [" << minimo << ", " << maximo << "]"
+                  << ", Promedio total: " << historial.calcularPromedio() << "\n";
     }
     
+    char getTipo() const override { return 'T'; }
+    
     void imprimirInfo() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[T-INFO " << id << "] Tipo: Temperatura, Lecturas: " 
                   << historial.getCantidad() << ", Promedio: " 
-                  << historial.calcularPromedio() << "\n";
+                  << historial.calcularPromedio() << ", p50: " << bosquejo.cuantil(0.50)
+                  << ", p95: " << bosquejo.cuantil(0.95) << ", p99: " << bosquejo.cuantil(0.99) << "\n";
+        imprimirSaturadas();
+    }
+
+    void resumir(ResumenSensor& resumen) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        resumen.lecturas = historial.getCantidad();
+        resumen.promedio = historial.calcularPromedio();
+        resumirBosquejo(resumen);
+    }
+
+    void recorrerHistorial(VisitanteHistorial& visitante) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        visitante.comenzarSensor(id, getTipo(), historial.getCantidad());
+        historial.paraCadaBloque([&visitante](const TemperaturaFija* valores, int n) {
+            entregarBloque(visitante, valores, n);
+        });
+        visitante.terminarSensor();
+    }
+
+    InstantaneaSensor* tomarInstantanea() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return new InstantaneaHistorial<TemperaturaFija>(id, idInterno, getTipo(), bosquejo, saturadas.load(),
+                                                         historial.instantanea());
+    }
+    void totalesHistorial(int& cantidad, double& suma) const override {
+        cantidad = historial.getCantidad();
+        suma = historial.getSuma();
+    }
+
+    size_t getBytesResidentes() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.getBytesResidentes();
+    }
+
+    size_t derramarHistorial(ArchivoDerrame& archivo) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        size_t bytes = historial.getBytesResidentes();
+        return historial.derramar(archivo) ? bytes : 0;
+    }
+
+    int recortarHistorial(int menores, int mayores) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int eliminadas = historial.eliminarMenores(menores) + historial.eliminarMayores(mayores);
+        if (eliminadas > 0) notificarPromedio(historial.calcularPromedio());
+        return eliminadas;
+    }
+
+    float promedioRecortado(int k) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.calcularPromedioRecortado(k);
     }
 };
 
@@ -271,11 +1176,11 @@ public:
  * @brief Clase concreta para sensores de vibración
  * 
  * Implementa la lógica específica para el manejo de conteos de vibración
- * usando valores enteros (int).
+ * usando valores enteros de 16 bits (EnteroFijo).
  */
 class SensorVibracion : public SensorBase {
 private:
-    ListaSensor<int> historial; ///< Historial de conteos de vibración
+    ListaSensor<EnteroFijo> historial; ///< Historial de conteos de vibración
 
 public:
     SensorVibracion(const char* sensorId) : SensorBase(sensorId) {
@@ -287,12 +1192,17 @@ public:
     }
     
     void registrarLectura(float lectura) override {
-        int conteoVibraciones = static_cast<int>(lectura);
+        TramoTraza traza("registrarLectura", idInterno);
+        std::lock_guard<std::mutex> lock(cerrojo);
+        // Conteo entero: se trunca como antes y luego se satura a 16 bits
+        EnteroFijo conteoVibraciones = convertirLectura<EnteroFijo>(std::trunc(lectura));
         historial.insertar(conteoVibraciones);
-        std::cout << "[Vibracion] Registrada lectura: " << conteoVibraciones << " en " << id << "\n";
+        if (logActivo()) std::cout << "[Vibracion] Registrada lectura: " << conteoVibraciones << " en " << id << "\n";
+        notificarLectura(conteoVibraciones, historial.calcularPromedio());
     }
     
     void procesarLectura() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[Procesando Vibracion " << id << "] ";
         if (historial.getCantidad() > 0) {
             float promedio = historial.calcularPromedio();
@@ -301,12 +1211,78 @@ public:
         } else {
             std::cout << "No hay lecturas para procesar.\n";
         }
+        historial.marcarProcesadas();
     }
     
+    void procesarIncremental() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int nuevas = historial.getNuevas();
+        if (nuevas == 0) return;
+        
+        long long vibracionesNuevas = 0;
+        historial.paraCadaNueva([&](int conteo) { vibracionesNuevas += conteo; });
+        historial.marcarProcesadas();
+        std::cout << "[Incremental Vibracion " << id << "] Nuevas: " << nuevas
+                  << ", Vibraciones nuevas: " << vibracionesNuevas
+                  << ", Promedio total por lectura: " << historial.calcularPromedio() << "\n";
+    }
+    
+    char getTipo() const override { return 'V'; }
+    
     void imprimirInfo() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[V-INFO " << id << "] Tipo: Vibracion, Lecturas: " 
                   << historial.getCantidad() << ", Promedio: " 
-                  << historial.calcularPromedio() << "\n";
+                  << historial.calcularPromedio() << ", p50: " << bosquejo.cuantil(0.50)
+                  << ", p95: " << bosquejo.cuantil(0.95) << ", p99: " << bosquejo.cuantil(0.99) << "\n";
+        imprimirSaturadas();
+    }
+
+    void resumir(ResumenSensor& resumen) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        resumen.lecturas = historial.getCantidad();
+        resumen.promedio = historial.calcularPromedio();
+        resumirBosquejo(resumen);
+    }
+
+    void recorrerHistorial(VisitanteHistorial& visitante) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        visitante.comenzarSensor(id, getTipo(), historial.getCantidad());
+        historial.paraCadaBloque([&visitante](const EnteroFijo* valores, int n) { entregarBloque(visitante, valores, n); });
+        visitante.terminarSensor();
+    }
+
+    InstantaneaSensor* tomarInstantanea() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return new InstantaneaHistorial<EnteroFijo>(id, idInterno, getTipo(), bosquejo, saturadas.load(),
+                                                    historial.instantanea());
+    }
+    void totalesHistorial(int& cantidad, double& suma) const override {
+        cantidad = historial.getCantidad();
+        suma = historial.getSuma();
+    }
+
+    size_t getBytesResidentes() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.getBytesResidentes();
+    }
+
+    size_t derramarHistorial(ArchivoDerrame& archivo) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        size_t bytes = historial.getBytesResidentes();
+        return historial.derramar(archivo) ? bytes : 0;
+    }
+
+    int recortarHistorial(int menores, int mayores) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int eliminadas = historial.eliminarMenores(menores) + historial.eliminarMayores(mayores);
+        if (eliminadas > 0) notificarPromedio(historial.calcularPromedio());
+        return eliminadas;
+    }
+
+    float promedioRecortado(int k) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.calcularPromedioRecortado(k);
     }
 };
 
@@ -314,11 +1290,11 @@ public:
  * @brief Clase concreta para sensores de presión
  * 
  * Implementa la lógica específica para el manejo de lecturas de presión
- * usando valores enteros (int).
+ * usando valores enteros de 16 bits (EnteroFijo).
  */
 class SensorPresion : public SensorBase {
 private:
-    ListaSensor<int> historial; ///< Historial de lecturas de presión
+    ListaSensor<EnteroFijo> historial; ///< Historial de lecturas de presión
 
 public:
     SensorPresion(const char* sensorId) : SensorBase(sensorId) {
@@ -330,112 +1306,570 @@ public:
     }
     
     void registrarLectura(float lectura) override {
-        int lecturaInt = static_cast<int>(lectura);
+        TramoTraza traza("registrarLectura", idInterno);
+        std::lock_guard<std::mutex> lock(cerrojo);
+        EnteroFijo lecturaInt = convertirLectura<EnteroFijo>(std::trunc(lectura));
         historial.insertar(lecturaInt);
-        std::cout << "[Presion] Registrada lectura: " << lecturaInt << " en " << id << "\n";
+        if (logActivo()) std::cout << "[Presion] Registrada lectura: " << lecturaInt << " en " << id << "\n";
+        notificarLectura(lecturaInt, historial.calcularPromedio());
     }
     
     void procesarLectura() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[Procesando Presion " << id << "] ";
         float promedio = historial.calcularPromedio();
         std::cout << "Promedio de lecturas: " << promedio 
                   << " sobre " << historial.getCantidad() << " lecturas.\n";
+        historial.marcarProcesadas();
     }
     
+    void procesarIncremental() override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int nuevas = historial.getNuevas();
+        if (nuevas == 0) return;
+        
+        long long sumaNuevas = 0;
+        historial.paraCadaNueva([&](int valor) { sumaNuevas += valor; });
+        historial.marcarProcesadas();
+        std::cout << "[Incremental Presion " << id << "] Nuevas: " << nuevas
+                  << ", Promedio nuevas: " << static_cast<float>(sumaNuevas) / nuevas
+                  << ", Promedio total: " << historial.calcularPromedio() << "\n";
+    }
+    
+    char getTipo() const override { return 'P'; }
+    
     void imprimirInfo() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
         std::cout << "[P-INFO " << id << "] Tipo: Presion, Lecturas: " 
                   << historial.getCantidad() << ", Promedio: " 
-                  << historial.calcularPromedio() << "\n";
+                  << historial.calcularPromedio() << ", p50: " << bosquejo.cuantil(0.50)
+                  << ", p95: " << bosquejo.cuantil(0.95) << ", p99: " << bosquejo.cuantil(0.99) << "\n";
+        imprimirSaturadas();
+    }
+
+    void resumir(ResumenSensor& resumen) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        resumen.lecturas = historial.getCantidad();
+        resumen.promedio = historial.calcularPromedio();
+        resumirBosquejo(resumen);
+    }
+
+    void recorrerHistorial(VisitanteHistorial& visitante) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        visitante.comenzarSensor(id, getTipo(), historial.getCantidad());
+        historial.paraCadaBloque([&visitante](const EnteroFijo* valores, int n) { entregarBloque(visitante, valores, n); });
+        visitante.terminarSensor();
+    }
+
+    InstantaneaSensor* tomarInstantanea() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return new InstantaneaHistorial<EnteroFijo>(id, idInterno, getTipo(), bosquejo, saturadas.load(),
+                                                    historial.instantanea());
+    }
+    void totalesHistorial(int& cantidad, double& suma) const override {
+        cantidad = historial.getCantidad();
+        suma = historial.getSuma();
+    }
+
+    size_t getBytesResidentes() const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.getBytesResidentes();
+    }
+
+    size_t derramarHistorial(ArchivoDerrame& archivo) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        size_t bytes = historial.getBytesResidentes();
+        return historial.derramar(archivo) ? bytes : 0;
+    }
+
+    int recortarHistorial(int menores, int mayores) override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        int eliminadas = historial.eliminarMenores(menores) + historial.eliminarMayores(mayores);
+        if (eliminadas > 0) notificarPromedio(historial.calcularPromedio());
+        return eliminadas;
+    }
+
+    float promedioRecortado(int k) const override {
+        std::lock_guard<std::mutex> lock(cerrojo);
+        return historial.calcularPromedioRecortado(k);
     }
 };
 
 /**
  * @brief Nodo para la lista de gestión del sistema
- * 
+ *
  * Almacena punteros polimórficos a la clase base SensorBase, permitiendo
  * gestionar diferentes tipos de sensores en una única estructura.
+ * El enlace es atómico para que los lectores recorran la lista sin bloqueo.
  */
 struct NodoGestion {
-    SensorBase* sensor;      ///< Puntero al sensor (polimórfico)
-    NodoGestion* siguiente;  ///< Puntero al siguiente nodo
-    
+    SensorBase* sensor;                   ///< Puntero al sensor (polimórfico)
+    std::atomic<NodoGestion*> siguiente;  ///< Puntero al siguiente nodo
+
     NodoGestion(SensorBase* s) : sensor(s), siguiente(nullptr) {}
-    
+
     ~NodoGestion() {
         std::cout << "[Destructor General] Liberando Nodo: " << sensor->getId() << "\n";
         delete sensor;
     }
 };
 
+/**
+ * @brief Vista inmutable de todos los sensores del sistema
+ *
+ * Cada sensor se captura de forma atómica con su propio cerrojo, uno tras
+ * otro: tomarla cuesta O(sensores), no O(lecturas), y la ingesta nunca se
+ * detiene. Una vez tomada, recorrerla no toma cerrojos de los sensores, así
+ * que un reporte o una exportación larga no frena a quien registra lecturas.
+ */
+class InstantaneaSistema {
+private:
+    std::vector<InstantaneaSensor*> sensores;
+
+    friend class SistemaGestion;
+
+public:
+    InstantaneaSistema() {}
+    ~InstantaneaSistema() {
+        for (size_t i = 0; i < sensores.size(); ++i) delete sensores[i];
+    }
+
+    InstantaneaSistema(const InstantaneaSistema&) = delete;
+    InstantaneaSistema& operator=(const InstantaneaSistema&) = delete;
+    InstantaneaSistema(InstantaneaSistema&& otra) : sensores(std::move(otra.sensores)) {}
+
+    size_t getCantidad() const { return sensores.size(); }
+    const InstantaneaSensor& operator[](size_t i) const { return *sensores[i]; }
+
+    /**
+     * @brief Aplica una función a cada sensor de la vista, en orden de alta
+     * @param f Invocable con firma void(const InstantaneaSensor&)
+     */
+    template <typename F>
+    void paraCadaSensor(F f) const {
+        for (size_t i = 0; i < sensores.size(); ++i) f(*sensores[i]);
+    }
+};
+
 /**
  * @brief Sistema principal de gestión de sensores
- * 
+ *
  * Implementa una lista enlazada simple de sensores usando polimorfismo,
  * permitiendo gestionar diferentes tipos de sensores de manera unificada.
  * Gestiona la memoria de forma segura liberando todos los recursos al destruirse.
+ *
+ * Concurrencia: las búsquedas y recorridos no toman ningún mutex; se protegen
+ * con una sección de lectura por épocas (estilo RCU). Las altas y bajas de
+ * sensores se serializan entre sí y los nodos retirados solo se liberan cuando
+ * ningún lector de la época anterior sigue activo. El historial de cada sensor
+ * se protege con el cerrojo propio del sensor.
  */
 class SistemaGestion {
 private:
-    NodoGestion* cabeza; ///< Puntero al primer nodo de la lista de gestión
+    static const int kFranjas = 16; ///< Contadores de lectores repartidos por hilo
+
+    /// Contadores de lectores de una franja, uno por época, en su propia línea de caché
+    struct alignas(64) ContadorLectores {
+        std::atomic<int> activos[2];
+        ContadorLectores() { activos[0] = 0; activos[1] = 0; }
+    };
+
+    std::atomic<NodoGestion*> cabeza;          ///< Puntero al primer nodo de la lista de gestión
+    NodoGestion* cola;                         ///< Último nodo (solo lo usan los escritores)
+    std::mutex escritura;                      ///< Serializa altas y bajas de sensores
+    mutable std::atomic<unsigned> epoca;       ///< Época de lectura vigente
+    mutable ContadorLectores lectores[kFranjas]; ///< Lectores activos por franja y época
+    std::mutex mtxPendientes;                  ///< Protege el conjunto de sensores pendientes
+    std::vector<SensorBase*> pendientes;       ///< Sensores con lecturas sin procesar
+    ColaAcotada<EventoAnomalia> anomalias;     ///< Eventos emitidos por los detectores
+    std::atomic<unsigned long> anomaliasDescartadas; ///< Eventos perdidos por cola llena
+    mutable std::mutex mtxReporte;             ///< Serializa el uso del búfer de reporte
+    mutable EscritorReporte reporte;           ///< Búfer reutilizado entre reportes
+    std::atomic<uint32_t> relojAcceso;         ///< Avanza en cada pasada del presupuesto de memoria
+    ArchivoDerrame derrame;                    ///< Historiales fríos (vive tanto como los sensores)
+    ClasificacionSensores clasificacion;       ///< K mejores por tipo y métrica
+    PublicadorMemoria publicador;              ///< Estado para procesos locales (memoria compartida)
+    MotorReglas reglas;                        ///< Reglas de alerta evaluadas en cada lectura
+
+    static int franjaActual() {
+        return static_cast<int>(std::hash<std::thread::id>()(std::this_thread::get_id()) % kFranjas);
+    }
+
+    unsigned entrarLectura(int franja) const {
+        for (;;) {
+            unsigned e = epoca.load() & 1u;
+            lectores[franja].activos[e].fetch_add(1);
+            if ((epoca.load() & 1u) == e) return e;
+            // La época cambió mientras nos registrábamos: reintentar en la nueva
+            lectores[franja].activos[e].fetch_sub(1);
+        }
+    }
+
+    void salirLectura(int franja, unsigned e) const {
+        lectores[franja].activos[e].fetch_sub(1);
+    }
+
+    /**
+     * @brief Espera a que terminen los lectores que pudieran ver nodos ya desenlazados
+     *
+     * Debe llamarse con el mutex de escritura tomado.
+     */
+    void sincronizar() {
+        unsigned anterior = epoca.fetch_add(1) & 1u;
+        for (int i = 0; i < kFranjas; ++i) {
+            while (lectores[i].activos[anterior].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
 
 public:
-    SistemaGestion() : cabeza(nullptr) {
+    /**
+     * @brief Sección de lectura RAII
+     *
+     * Mientras exista, ningún sensor alcanzable desde la lista será liberado.
+     * Los punteros devueltos por buscarSensor() siguen siendo válidos dentro de
+     * la sección aunque otro hilo llame a eliminarSensor().
+     */
+    class GuardiaLectura {
+    private:
+        const SistemaGestion& sistema;
+        int franja;
+        unsigned e;
+    public:
+        explicit GuardiaLectura(const SistemaGestion& s)
+            : sistema(s), franja(franjaActual()), e(s.entrarLectura(franja)) {}
+        ~GuardiaLectura() { sistema.salirLectura(franja, e); }
+        GuardiaLectura(const GuardiaLectura&) = delete;
+        GuardiaLectura& operator=(const GuardiaLectura&) = delete;
+    };
+
+    static const size_t kCapacidadAnomalias = 4096; ///< Eventos retenidos sin consumir
+
+    SistemaGestion()
+        : cabeza(nullptr), cola(nullptr), epoca(0), anomalias(kCapacidadAnomalias),
+          anomaliasDescartadas(0), relojAcceso(0) {
         std::cout << "[SistemaGestion] Sistema creado.\n";
     }
-    
+
     ~SistemaGestion() {
         std::cout << "\n--- Liberación de Memoria en Cascada ---\n";
-        NodoGestion* actual = cabeza;
+        NodoGestion* actual = cabeza.load();
         while (actual != nullptr) {
             NodoGestion* temp = actual;
-            actual = actual->siguiente;
+            actual = actual->siguiente.load();
             delete temp;
         }
         std::cout << "Sistema cerrado. Memoria limpia.\n";
     }
-    
+
+    SistemaGestion(const SistemaGestion&) = delete;
+    SistemaGestion& operator=(const SistemaGestion&) = delete;
+
     void agregarSensor(SensorBase* sensor) {
         NodoGestion* nuevoNodo = new NodoGestion(sensor);
-        
-        if (cabeza == nullptr) {
-            cabeza = nuevoNodo;
-        } else {
-            NodoGestion* actual = cabeza;
-            while (actual->siguiente != nullptr) {
-                actual = actual->siguiente;
+        sensor->sistema = this;
+        {
+            std::lock_guard<std::mutex> lock(escritura);
+            if (cola == nullptr) {
+                cabeza.store(nuevoNodo);
+            } else {
+                cola->siguiente.store(nuevoNodo);
             }
-            actual->siguiente = nuevoNodo;
+            cola = nuevoNodo;
         }
         std::cout << "[Sistema] Sensor '" << sensor->getId() << "' agregado al sistema.\n";
+        // Las lecturas registradas antes del alta también cuentan como pendientes
+        if (!sensor->pendiente.exchange(true)) marcarPendiente(sensor);
     }
-    
-    SensorBase* buscarSensor(const char* id) {
-        NodoGestion* actual = cabeza;
+
+    /**
+     * @brief Retira un sensor de la lista y lo libera
+     *
+     * Espera a que los lectores concurrentes abandonen la época anterior antes
+     * de liberar el nodo, por lo que no debe llamarse dentro de una GuardiaLectura.
+     * @param id Identificador del sensor a eliminar
+     * @return true si el sensor existía
+     */
+    bool eliminarSensor(const char* id) {
+        uint32_t handle = TablaIds::global().buscar(id);
+        return handle != TablaIds::kInvalido && eliminarSensor(handle);
+    }
+
+    /// Igual que eliminarSensor(const char*), con el handle de TablaIds
+    bool eliminarSensor(uint32_t idInterno) {
+        NodoGestion* retirado = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(escritura);
+            NodoGestion* anterior = nullptr;
+            NodoGestion* actual = cabeza.load();
+            while (actual != nullptr && actual->sensor->getIdInterno() != idInterno) {
+                anterior = actual;
+                actual = actual->siguiente.load();
+            }
+            if (actual == nullptr) return false;
+
+            NodoGestion* siguiente = actual->siguiente.load();
+            if (anterior == nullptr) {
+                cabeza.store(siguiente);
+            } else {
+                anterior->siguiente.store(siguiente);
+            }
+            if (cola == actual) cola = anterior;
+            // Antes de sincronizar: una pasada de procesamiento que ya lo tomó de los
+            // pendientes entró a su sección antes del cambio de época y la espera
+            // alcanza; marcado como retirado, ni una lectura en curso puede volver
+            // a agregarlo ni tomarPendientes() devolverlo
+            {
+                std::lock_guard<std::mutex> lockPendientes(mtxPendientes);
+                actual->sensor->retirado = true;
+                for (size_t i = 0; i < pendientes.size(); ++i) {
+                    if (pendientes[i] == actual->sensor) {
+                        pendientes[i] = pendientes.back();
+                        pendientes.pop_back();
+                        break;
+                    }
+                }
+            }
+            sincronizar();
+            clasificacion.quitar(actual->sensor->getTipo(), idInterno);
+            publicador.retirar(idInterno);
+            retirado = actual;
+        }
+        delete retirado;
+        return true;
+    }
+
+    /**
+     * @brief Busca un sensor por su identificador sin bloquear
+     *
+     * Si otro hilo puede eliminar sensores, el llamador debe mantener una
+     * GuardiaLectura mientras use el puntero devuelto.
+     */
+    SensorBase* buscarSensor(const char* id) const {
+        TramoTraza traza("buscarSensor");
+        // Un id que nunca se internó no puede pertenecer a ningún sensor
+        uint32_t handle = TablaIds::global().buscar(id);
+        return handle == TablaIds::kInvalido ? nullptr : buscarSensor(handle);
+    }
+
+    /// Busca por handle de TablaIds: el recorrido compara enteros, no cadenas
+    SensorBase* buscarSensor(uint32_t idInterno) const {
+        TramoTraza traza("buscarSensorHandle");
+        GuardiaLectura guardia(*this);
+        NodoGestion* actual = cabeza.load(std::memory_order_acquire);
         while (actual != nullptr) {
-            if (strcmp(actual->sensor->getId(), id) == 0) {
+            if (actual->sensor->getIdInterno() == idInterno) {
                 return actual->sensor;
             }
-            actual = actual->siguiente;
+            actual = actual->siguiente.load(std::memory_order_acquire);
         }
         return nullptr;
     }
-    
+
+    /**
+     * @brief Encola un evento de anomalía sin bloquear la ingesta
+     *
+     * Si nadie consume los eventos y la cola se llena, el evento se descarta
+     * y se contabiliza en getAnomaliasDescartadas().
+     */
+    void publicarAnomalia(const EventoAnomalia& evento) {
+        if (!anomalias.tryPush(evento)) anomaliasDescartadas.fetch_add(1);
+    }
+
+    /**
+     * @brief Extrae sin esperar los eventos de anomalía pendientes
+     * @return Cantidad de eventos añadidos a destino
+     */
+    size_t extraerAnomalias(std::vector<EventoAnomalia>& destino, size_t maximo = kCapacidadAnomalias) {
+        return anomalias.tryPopLote(destino, maximo);
+    }
+
+    /// Cola de eventos, para consumidores que prefieran esperar con popLote()
+    ColaAcotada<EventoAnomalia>& getColaAnomalias() { return anomalias; }
+
+    unsigned long getAnomaliasDescartadas() const { return anomaliasDescartadas.load(); }
+
+    /**
+     * @brief Reloj lógico con el que cada sensor anota su última lectura
+     *
+     * Es de grano grueso a propósito: solo avanza con avanzarRelojAcceso(),
+     * así que registrar una lectura solo lee una línea de caché compartida.
+     */
+    uint32_t getRelojAcceso() const { return relojAcceso.load(std::memory_order_relaxed); }
+
+    /// Abre un nuevo intervalo de acceso y devuelve su valor
+    uint32_t avanzarRelojAcceso() { return relojAcceso.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    /// Clasificaciones que actualiza SensorBase::notificarLectura()
+    ClasificacionSensores& getClasificacion() { return clasificacion; }
+
+    /**
+     * @brief Publicador en memoria compartida que actualiza SensorBase::notificarLectura()
+     *
+     * No publica nada hasta que se llama a abrir().
+     */
+    PublicadorMemoria& getPublicador() { return publicador; }
+
+    /**
+     * @brief Reglas de alerta que evalúa SensorBase::notificarLectura()
+     *
+     * Las reglas agregadas rigen tras MotorReglas::compilar(); las alertas se
+     * consumen con MotorReglas::extraerAlertas().
+     */
+    MotorReglas& getReglas() { return reglas; }
+
+    /**
+     * @brief Los k sensores de un tipo con mayor valor de una métrica, en O(K log K)
+     *
+     * Un sensor aparece desde su primera lectura registrada estando en el sistema.
+     * @param tipo Letra del tipo ('T', 'P' o 'V')
+     * @return Cantidad de filas añadidas a destino, de mayor a menor
+     */
+    size_t mejoresSensores(char tipo, MetricaClasificacion metrica, size_t k,
+                           std::vector<PosicionClasificacion>& destino) const {
+        return clasificacion.mejores(tipo, metrica, k, destino);
+    }
+
+    /// Archivo al que se derraman los historiales fríos
+    ArchivoDerrame& getArchivoDerrame() { return derrame; }
+    const ArchivoDerrame& getArchivoDerrame() const { return derrame; }
+
+    /**
+     * @brief Agrega un sensor al conjunto de pendientes de procesamiento
+     *
+     * La invoca SensorBase::notificarLectura(); un sensor aparece a lo sumo
+     * una vez en el conjunto, y uno ya retirado no se agrega.
+     */
+    void marcarPendiente(SensorBase* sensor) {
+        std::lock_guard<std::mutex> lock(mtxPendientes);
+        if (!sensor->retirado) pendientes.push_back(sensor);
+    }
+
+    /**
+     * @brief Extrae los sensores pendientes de un tipo
+     *
+     * Los sensores extraídos vuelven a marcarse en su próxima lectura. El
+     * llamador debe mantener una GuardiaLectura mientras los use.
+     * @param tipo Letra del tipo de sensor ('T', 'P' o 'V')
+     * @param destino Vector al que se añaden los sensores extraídos
+     * @return Cantidad de sensores extraídos
+     */
+    size_t tomarPendientes(char tipo, std::vector<SensorBase*>& destino) {
+        std::lock_guard<std::mutex> lock(mtxPendientes);
+        size_t antes = destino.size();
+        size_t j = 0;
+        for (size_t i = 0; i < pendientes.size(); ++i) {
+            SensorBase* s = pendientes[i];
+            if (s->retirado) continue;
+            if (s->getTipo() == tipo) {
+                s->pendiente.store(false);
+                destino.push_back(s);
+            } else {
+                pendientes[j++] = s;
+            }
+        }
+        pendientes.resize(j);
+        return destino.size() - antes;
+    }
+
+    /**
+     * @brief Aplica una función a cada sensor registrado, en orden de alta
+     * @param f Invocable con firma void(SensorBase*)
+     */
+    template <typename F>
+    void paraCadaSensor(F f) const {
+        GuardiaLectura guardia(*this);
+        NodoGestion* actual = cabeza.load(std::memory_order_acquire);
+        while (actual != nullptr) {
+            f(actual->sensor);
+            actual = actual->siguiente.load(std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Vista inmutable de todos los sensores, sin detener la ingesta
+     *
+     * Cada sensor se bloquea solo lo que tarda en contar una referencia a la
+     * cabeza de su historial y copiar su bosquejo.
+     */
+    InstantaneaSistema tomarInstantanea() const {
+        InstantaneaSistema foto;
+        paraCadaSensor([&foto](SensorBase* s) { foto.sensores.push_back(s->tomarInstantanea()); });
+        return foto;
+    }
+
+    /**
+     * @brief Percentiles de toda la flota fusionando los bosquejos de cada sensor
+     * @param tipo Letra del tipo a incluir, o 0 para todos los sensores
+     * @param destino Bosquejo que recibe la fusión
+     */
+    void fusionarBosquejos(char tipo, BosquejoKLL& destino) const {
+        paraCadaSensor([tipo, &destino](SensorBase* s) {
+            if (tipo == 0 || s->getTipo() == tipo) s->fusionarBosquejoEn(destino);
+        });
+    }
+
     void ejecutarProcesamiento() {
+        TramoTraza traza("ejecutarProcesamiento");
+        GuardiaLectura guardia(*this);
         std::cout << "\n--- Ejecutando Polimorfismo ---\n";
-        NodoGestion* actual = cabeza;
+        NodoGestion* actual = cabeza.load(std::memory_order_acquire);
         while (actual != nullptr) {
             std::cout << "-> Procesando Sensor " << actual->sensor->getId() << "...\n";
+            TramoTraza trazaSensor("procesarLectura", actual->sensor->getIdInterno());
             actual->sensor->procesarLectura();
-            actual = actual->siguiente;
+            actual = actual->siguiente.load(std::memory_order_acquire);
         }
     }
-    
-    void imprimirTodos() {
-        NodoGestion* actual = cabeza;
-        while (actual != nullptr) {
-            actual->sensor->imprimirInfo();
-            actual = actual->siguiente;
+
+    /**
+     * @brief Imprime el reporte de todos los sensores en la salida estándar
+     */
+    void imprimirTodos(FormatoReporte formato = REPORTE_TEXTO) const {
+        escribirReporte(1, formato);
+    }
+
+    /**
+     * @brief Genera el reporte de todos los sensores y lo escribe en fd
+     *
+     * Las filas se formatean en el búfer reutilizable del sistema y se emiten
+     * con una sola escritura; no se usa std::cout por sensor.
+     * @param fd Descriptor de destino (1 = salida estándar)
+     * @return true si se escribió completo
+     */
+    bool escribirReporte(int fd, FormatoReporte formato) const {
+        std::lock_guard<std::mutex> lock(mtxReporte);
+        reporte.comenzar(formato);
+        {
+            GuardiaLectura guardia(*this);
+            NodoGestion* actual = cabeza.load(std::memory_order_acquire);
+            ResumenSensor resumen;
+            while (actual != nullptr) {
+                actual->sensor->resumir(resumen);
+                reporte.agregar(resumen);
+                actual = actual->siguiente.load(std::memory_order_acquire);
+            }
+        }
+        reporte.terminar();
+        return reporte.volcar(fd);
+    }
+
+    /**
+     * @brief Igual que escribirReporte(int, FormatoReporte), desde una instantánea
+     *
+     * No toma cerrojos de los sensores: la ingesta sigue mientras se escribe.
+     */
+    bool escribirReporte(const InstantaneaSistema& foto, int fd, FormatoReporte formato) const {
+        std::lock_guard<std::mutex> lock(mtxReporte);
+        reporte.comenzar(formato);
+        ResumenSensor resumen;
+        for (size_t i = 0; i < foto.getCantidad(); ++i) {
+            foto[i].resumir(resumen);
+            reporte.agregar(resumen);
         }
+        reporte.terminar();
+        return reporte.volcar(fd);
     }
 };
 
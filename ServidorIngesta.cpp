@@ -0,0 +1,364 @@
+#include "ServidorIngesta.h"
+#include "Trazas.h"
+#include "Afinidad.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+// Marcas de epoll para los descriptores fijos; las conexiones usan su puntero
+static const uint64_t kIdDespertador = 1;
+static const uint64_t kIdTcp = 2;
+static const uint64_t kIdUdp = 3;
+
+static int64_t ahoraMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int abrirReserva() {
+    return open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+ServidorIngesta::ServidorIngesta(MotorIngesta& m)
+    : motor(m), epfd(epoll_create1(EPOLL_CLOEXEC)),
+      despertador(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), socketTcp(-1), socketUdp(-1),
+      reserva(abrirReserva()), aceptarDesdeMs(0), udpPendiente(false),
+      puertoTcp(0), puertoUdp(0), enMarcha(false), activo(false),
+      cupo(kMaximoIdsNuevos), maximoIdsNuevos(kMaximoIdsNuevos), aceptadas(0), activas(0), datagramas(0),
+      lotesUdp(0), bytes(0), registros(0), descartes(0), idsNuevos(0), idsRechazados(0), rechazadas(0) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kIdDespertador;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, despertador, &ev);
+}
+
+ServidorIngesta::~ServidorIngesta() {
+    detener();
+    if (socketTcp >= 0) close(socketTcp);
+    if (socketUdp >= 0) close(socketUdp);
+    if (reserva >= 0) close(reserva);
+    close(despertador);
+    close(epfd);
+}
+
+int ServidorIngesta::abrirSocket(int tipo, const char* direccion, uint16_t puerto, uint16_t& asignado) {
+    sockaddr_in dir{};
+    dir.sin_family = AF_INET;
+    dir.sin_port = htons(puerto);
+    dir.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (direccion && inet_pton(AF_INET, direccion, &dir.sin_addr) != 1) return -1;
+
+    int fd = socket(AF_INET, tipo | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int uno = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&dir), sizeof(dir)) < 0 ||
+        (tipo == SOCK_STREAM && listen(fd, 128) < 0)) {
+        close(fd);
+        return -1;
+    }
+    socklen_t largo = sizeof(dir);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&dir), &largo);
+    asignado = ntohs(dir.sin_port);
+    return fd;
+}
+
+bool ServidorIngesta::escucharTcp(const char* direccion, uint16_t puerto) {
+    if (enMarcha || socketTcp >= 0) return false;
+    socketTcp = abrirSocket(SOCK_STREAM, direccion, puerto, puertoTcp);
+    if (socketTcp < 0) return false;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kIdTcp;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, socketTcp, &ev);
+    return true;
+}
+
+bool ServidorIngesta::escucharUdp(const char* direccion, uint16_t puerto) {
+    if (enMarcha || socketUdp >= 0) return false;
+    socketUdp = abrirSocket(SOCK_DGRAM, direccion, puerto, puertoUdp);
+    if (socketUdp < 0) return false;
+    bufferUdp.resize(kDatagramasPorLote * kLargoDatagrama);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = kIdUdp;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, socketUdp, &ev);
+    return true;
+}
+
+void ServidorIngesta::setMaximoIdsNuevos(size_t maximo) {
+    if (enMarcha) return;
+    maximoIdsNuevos = maximo;
+    cupo = CupoIds(maximo);
+}
+
+void ServidorIngesta::iniciar() {
+    if (enMarcha) return;
+    enMarcha = true;
+    activo.store(true);
+    hilo = std::thread(&ServidorIngesta::bucle, this);
+}
+
+void ServidorIngesta::detener() {
+    if (!enMarcha) return;
+    activo.store(false);
+    uint64_t uno = 1;
+    ssize_t r = write(despertador, &uno, sizeof(uno));
+    (void)r;
+    hilo.join();
+    while (!conexiones.empty()) cerrarConexion(conexiones.back());
+    pausarAceptar(false);
+    udpPendiente = false;
+    enMarcha = false;
+}
+
+void ServidorIngesta::bucle() {
+    AfinidadHilos::global().aplicar(HILO_LECTURA, 1);
+    Trazador::global().nombrarHilo("servidorIngesta");
+    epoll_event eventos[64];
+    std::vector<Conexion*> turno;
+    while (activo.load()) {
+        // Con lecturas a medias no se espera: solo se miran los eventos nuevos
+        int espera = -1;
+        if (!listas.empty() || udpPendiente) {
+            espera = 0;
+        } else if (aceptarDesdeMs != 0) {
+            espera = static_cast<int>(std::max<int64_t>(aceptarDesdeMs - ahoraMs(), 0));
+        }
+        int n = epoll_wait(epfd, eventos, 64, espera);
+        if (n < 0 && errno != EINTR) break;
+        if (aceptarDesdeMs != 0 && ahoraMs() >= aceptarDesdeMs) {
+            pausarAceptar(false);
+            aceptar();
+        }
+        // Los que agotaron su turno en la vuelta anterior siguen después de los eventos nuevos
+        turno.swap(listas);
+        for (size_t i = 0; i < turno.size(); ++i) turno[i]->enCola = false;
+        if (udpPendiente) {
+            udpPendiente = false;
+            leerDatagramas();
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = eventos[i].data.u64;
+            if (id == kIdDespertador) {
+                uint64_t valor;
+                ssize_t r = read(despertador, &valor, sizeof(valor));
+                (void)r;
+            } else if (id == kIdTcp) {
+                aceptar();
+            } else if (id == kIdUdp) {
+                leerDatagramas();
+            } else {
+                leerConexion(reinterpret_cast<Conexion*>(id));
+            }
+        }
+        // Las que se cerraron en esta vuelta ya no están en conexiones
+        for (size_t i = 0; i < turno.size(); ++i) {
+            if (std::find(conexiones.begin(), conexiones.end(), turno[i]) != conexiones.end()) {
+                leerConexion(turno[i]);
+            }
+        }
+        turno.clear();
+        // Una sola entrega al motor por tanda de eventos
+        vaciarLote();
+    }
+}
+
+void ServidorIngesta::pausarAceptar(bool pausar) {
+    if (socketTcp < 0 || pausar == (aceptarDesdeMs != 0)) return;
+    if (pausar) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, socketTcp, nullptr);
+        aceptarDesdeMs = ahoraMs() + kPausaAceptarMs;
+    } else {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = kIdTcp;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, socketTcp, &ev);
+        aceptarDesdeMs = 0;
+    }
+}
+
+void ServidorIngesta::aceptar() {
+    for (;;) {
+        int fd = accept4(socketTcp, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EMFILE && errno != ENFILE) return;   // EAGAIN: no hay más pendientes
+            // El socket sigue listo (nivel): sin hacer nada, epoll_wait volvería enseguida.
+            // Con la reserva libre hay un descriptor para sacar la conexión de la cola y cerrarla
+            if (reserva >= 0) {
+                close(reserva);
+                fd = accept4(socketTcp, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd >= 0) {
+                    close(fd);
+                    rechazadas.fetch_add(1, std::memory_order_relaxed);
+                }
+                reserva = abrirReserva();
+                if (fd >= 0) continue;
+            }
+            pausarAceptar(true);
+            return;
+        }
+        Conexion* c = new Conexion();
+        c->fd = fd;
+        c->descartando = false;
+        c->enCola = false;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = reinterpret_cast<uint64_t>(c);
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            delete c;
+            continue;
+        }
+        conexiones.push_back(c);
+        aceptadas.fetch_add(1, std::memory_order_relaxed);
+        activas.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ServidorIngesta::leerConexion(Conexion* c) {
+    char buffer[16384];
+    for (int lecturas = 0;; ++lecturas) {
+        if (lecturas == kLecturasPorTurno) {
+            // Edge-triggered: no llegará otro evento por lo que ya está en el socket
+            if (!c->enCola) {
+                c->enCola = true;
+                listas.push_back(c);
+            }
+            return;
+        }
+        ssize_t n = read(c->fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            bytes.fetch_add(static_cast<unsigned long>(n), std::memory_order_relaxed);
+            consumir(*c, buffer, static_cast<size_t>(n));
+            // Una conexión muy activa no acumula un lote sin límite
+            if (lote.size() >= 4096) vaciarLote();
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        // Fin de datos o error: la última línea sin salto también cuenta
+        if (!c->descartando && !c->pendiente.empty()) {
+            motor.analizarBloque(c->pendiente.data(), c->pendiente.size(), lote, &cupo);
+        }
+        cerrarConexion(c);
+        return;
+    }
+}
+
+void ServidorIngesta::consumir(Conexion& c, const char* datos, size_t n) {
+    const char* ultimo = static_cast<const char*>(memrchr(datos, '\n', n));
+    if (ultimo == nullptr) {
+        // Sin línea completa: solo acumular
+        if (c.descartando) return;
+        if (c.pendiente.size() + n > kLargoMaximoLinea) {
+            c.pendiente.clear();
+            c.descartando = true;
+            descartes.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        c.pendiente.append(datos, n);
+        return;
+    }
+
+    const char* p = datos;
+    const char* fin = ultimo + 1;
+    if (c.descartando || !c.pendiente.empty()) {
+        // Completar la línea que venía de lecturas anteriores
+        const char* salto = static_cast<const char*>(memchr(datos, '\n', n));
+        if (!c.descartando) {
+            c.pendiente.append(datos, static_cast<size_t>(salto - datos));
+            motor.analizarBloque(c.pendiente.data(), c.pendiente.size(), lote, &cupo);
+        }
+        c.pendiente.clear();
+        c.descartando = false;
+        p = salto + 1;
+    }
+    // El resto hasta el último salto son líneas completas: se analizan sin copiarlas
+    if (p < fin) motor.analizarBloque(p, static_cast<size_t>(fin - p), lote, &cupo);
+
+    size_t resto = static_cast<size_t>(datos + n - fin);
+    if (resto > kLargoMaximoLinea) {
+        c.descartando = true;
+        descartes.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        c.pendiente.assign(fin, resto);
+    }
+}
+
+void ServidorIngesta::cerrarConexion(Conexion* c) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    conexiones.erase(std::find(conexiones.begin(), conexiones.end(), c));
+    if (c->enCola) listas.erase(std::find(listas.begin(), listas.end(), c));
+    delete c;
+    activas.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ServidorIngesta::leerDatagramas() {
+    mmsghdr mensajes[kDatagramasPorLote];
+    iovec vectores[kDatagramasPorLote];
+    for (int lotes = 0;; ++lotes) {
+        if (lotes == kLotesUdpPorTurno) {
+            udpPendiente = true;
+            return;
+        }
+        std::memset(mensajes, 0, sizeof(mensajes));
+        for (size_t i = 0; i < kDatagramasPorLote; ++i) {
+            vectores[i].iov_base = bufferUdp.data() + i * kLargoDatagrama;
+            vectores[i].iov_len = kLargoDatagrama;
+            mensajes[i].msg_hdr.msg_iov = &vectores[i];
+            mensajes[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(socketUdp, mensajes, kDatagramasPorLote, MSG_DONTWAIT, nullptr);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+
+        lotesUdp.fetch_add(1, std::memory_order_relaxed);
+        datagramas.fetch_add(static_cast<unsigned long>(n), std::memory_order_relaxed);
+        for (int i = 0; i < n; ++i) {
+            bytes.fetch_add(mensajes[i].msg_len, std::memory_order_relaxed);
+            if (mensajes[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                descartes.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            motor.analizarBloque(static_cast<const char*>(vectores[i].iov_base), mensajes[i].msg_len, lote,
+                                 &cupo);
+        }
+        vaciarLote();
+        // Edge-triggered: seguir hasta vaciar el socket
+        if (static_cast<size_t>(n) < kDatagramasPorLote) return;
+    }
+}
+
+void ServidorIngesta::vaciarLote() {
+    idsNuevos.store(maximoIdsNuevos - cupo.restantes, std::memory_order_relaxed);
+    idsRechazados.store(cupo.rechazados, std::memory_order_relaxed);
+    if (lote.empty()) return;
+    registros.fetch_add(motor.encolarLote(lote), std::memory_order_relaxed);
+    lote.clear();
+}
+
+ServidorIngesta::Estadisticas ServidorIngesta::getEstadisticas() const {
+    Estadisticas e;
+    e.conexiones = aceptadas.load();
+    e.conexionesActivas = activas.load();
+    e.datagramas = datagramas.load();
+    e.lotesUdp = lotesUdp.load();
+    e.bytes = bytes.load();
+    e.registros = registros.load();
+    e.descartes = descartes.load();
+    e.idsNuevos = idsNuevos.load();
+    e.idsRechazados = idsRechazados.load();
+    e.rechazadas = rechazadas.load();
+    return e;
+}
@@ -0,0 +1,167 @@
+#ifndef SERVIDOR_INGESTA_H
+#define SERVIDOR_INGESTA_H
+
+/**
+ * @file ServidorIngesta.h
+ * @brief Servidor TCP/UDP que recibe lecturas de otros gateways y las pasa a un MotorIngesta
+ *
+ * Acepta el mismo formato de texto que el puerto serie ("T,T-001,27.8\n"):
+ *  - TCP: un flujo de líneas por conexión. Cada conexión guarda su línea
+ *    parcial entre lecturas.
+ *  - UDP: cada datagrama lleva una o más líneas completas (la última puede ir
+ *    sin salto). Los datagramas se leen de a kDatagramasPorLote con recvmmsg.
+ *
+ * Un solo hilo atiende todos los sockets con epoll, sin bloquear. Para que un
+ * emisor que no para de escribir no deje sin turno a los demás, cada despertar
+ * lee a lo sumo kLecturasPorTurno veces de una conexión (o kLotesUdpPorTurno
+ * lotes del socket UDP); lo que quede se sigue leyendo en la próxima vuelta,
+ * después de atender al resto. Si se acaban los descriptores al aceptar, la
+ * conexión se acepta con un descriptor de reserva y se cierra enseguida, o,
+ * sin reserva, se deja de escuchar por kPausaAceptarMs. Las líneas
+ * que llegan en una tanda de lecturas se analizan juntas y se encolan con
+ * MotorIngesta::encolarLote(). Si los fragmentos se atrasan, el hilo espera
+ * y la contrapresión llega a los emisores por el control de flujo de TCP
+ * (en UDP el kernel descarta lo que no cabe en el buffer del socket).
+ *
+ * Los emisores no se autentican, así que por omisión solo se escucha en
+ * 127.0.0.1; otra interfaz debe pedirse explícitamente. Además, las líneas
+ * remotas solo pueden agregar setMaximoIdsNuevos() ids desconocidos
+ * (cada uno crea un sensor y queda para siempre en TablaIds); pasado el
+ * cupo, las lecturas de ids nuevos se descartan y se cuentan.
+ *
+ * Para probarlo basta con escuchar con puerto 0 y consultar el puerto
+ * asignado con getPuertoTcp() / getPuertoUdp().
+ */
+
+#include "Ingesta.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Servidor de ingesta por red en un solo hilo
+ *
+ * escucharTcp() y escucharUdp() deben llamarse antes de iniciar(). El motor
+ * debe estar en marcha mientras el servidor lo esté, y detenerse después.
+ */
+class ServidorIngesta {
+public:
+    /**
+     * @brief Contadores del servidor
+     */
+    struct Estadisticas {
+        unsigned long conexiones;         ///< Conexiones TCP aceptadas
+        unsigned long conexionesActivas;  ///< Conexiones TCP abiertas ahora
+        unsigned long datagramas;         ///< Datagramas UDP recibidos
+        unsigned long lotesUdp;           ///< Llamadas a recvmmsg que devolvieron datos
+        unsigned long bytes;              ///< Bytes recibidos por TCP y UDP
+        unsigned long registros;          ///< Registros encolados en el motor
+        unsigned long descartes;          ///< Líneas demasiado largas y datagramas truncados
+        unsigned long idsNuevos;          ///< Ids desconocidos que se agregaron
+        unsigned long idsRechazados;      ///< Líneas con id desconocido descartadas por falta de cupo
+        unsigned long rechazadas;         ///< Conexiones cerradas al aceptarlas por falta de descriptores
+    };
+
+    static const size_t kDatagramasPorLote = 64;     ///< Datagramas por llamada a recvmmsg
+    static const size_t kLargoDatagrama = 9000;      ///< Datagramas más largos se descartan
+    static const size_t kLargoMaximoLinea = BucleSerial::kLargoMaximoLinea;
+    static const size_t kMaximoIdsNuevos = 1024;     ///< Cupo por omisión de ids desconocidos
+    static const int kLecturasPorTurno = 16;         ///< read() por conexión en cada vuelta del bucle
+    static const int kLotesUdpPorTurno = 16;         ///< recvmmsg() en cada vuelta del bucle
+    static const int kPausaAceptarMs = 100;          ///< Sin descriptores ni reserva: pausa del socket TCP
+
+    explicit ServidorIngesta(MotorIngesta& motor);
+    ~ServidorIngesta();
+
+    ServidorIngesta(const ServidorIngesta&) = delete;
+    ServidorIngesta& operator=(const ServidorIngesta&) = delete;
+
+    /**
+     * @brief Escucha conexiones TCP
+     * @param direccion IPv4 en texto; nullptr = 127.0.0.1, "0.0.0.0" = todas las interfaces
+     * @param puerto 0 = el que asigne el sistema
+     * @return false si el servidor ya está en marcha o el socket no pudo abrirse
+     */
+    bool escucharTcp(const char* direccion, uint16_t puerto);
+
+    /// Igual que escucharTcp() para datagramas UDP
+    bool escucharUdp(const char* direccion, uint16_t puerto);
+
+    /**
+     * @brief Cuántos ids desconocidos pueden agregar los emisores remotos
+     *
+     * Debe llamarse antes de iniciar(); 0 acepta solo ids ya conocidos.
+     */
+    void setMaximoIdsNuevos(size_t maximo);
+
+    /// Puerto TCP en uso (0 si no se escucha)
+    uint16_t getPuertoTcp() const { return puertoTcp; }
+
+    /// Puerto UDP en uso (0 si no se escucha)
+    uint16_t getPuertoUdp() const { return puertoUdp; }
+
+    /// Arranca el hilo del servidor
+    void iniciar();
+
+    /// Detiene el hilo y cierra todas las conexiones; lo ya recibido queda encolado
+    void detener();
+
+    bool estaEnMarcha() const { return enMarcha; }
+
+    Estadisticas getEstadisticas() const;
+
+private:
+    struct Conexion {
+        int fd;
+        std::string pendiente;    ///< Línea parcial acumulada
+        bool descartando;         ///< Se superó el límite; ignorar hasta el próximo salto
+        bool enCola;              ///< Quedaron datos sin leer; está en listas
+    };
+
+    MotorIngesta& motor;
+    int epfd;
+    int despertador;              ///< eventfd para detener()
+    int socketTcp;
+    int socketUdp;
+    int reserva;                  ///< Descriptor que se suelta para aceptar y rechazar sin EMFILE
+    int64_t aceptarDesdeMs;       ///< Socket TCP fuera de epoll hasta este instante (0 = escuchando)
+    bool udpPendiente;            ///< El socket UDP quedó con datagramas sin leer
+    uint16_t puertoTcp;
+    uint16_t puertoUdp;
+    std::thread hilo;
+    bool enMarcha;
+    std::atomic<bool> activo;
+
+    std::vector<Conexion*> conexiones;        ///< Solo las toca el hilo del servidor
+    std::vector<Conexion*> listas;            ///< Con datos sin leer al agotar su turno
+    std::vector<char> bufferUdp;              ///< kDatagramasPorLote * kLargoDatagrama
+    std::vector<RegistroLectura> lote;        ///< Registros de la tanda actual
+    CupoIds cupo;                             ///< Ids nuevos que aún se aceptan
+    size_t maximoIdsNuevos;
+
+    std::atomic<unsigned long> aceptadas;
+    std::atomic<unsigned long> activas;
+    std::atomic<unsigned long> datagramas;
+    std::atomic<unsigned long> lotesUdp;
+    std::atomic<unsigned long> bytes;
+    std::atomic<unsigned long> registros;
+    std::atomic<unsigned long> descartes;
+    std::atomic<unsigned long> idsNuevos;
+    std::atomic<unsigned long> idsRechazados;
+    std::atomic<unsigned long> rechazadas;
+
+    int abrirSocket(int tipo, const char* direccion, uint16_t puerto, uint16_t& asignado);
+    void bucle();
+    void aceptar();
+    void pausarAceptar(bool pausar);
+    void leerConexion(Conexion* c);
+    void cerrarConexion(Conexion* c);
+    void leerDatagramas();
+    void consumir(Conexion& c, const char* datos, size_t n);
+    void vaciarLote();
+};
+
+#endif
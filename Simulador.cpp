@@ -0,0 +1,176 @@
+#include "Simulador.h"
+#include "SensorSystem.h"
+#include "Ingesta.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+static uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+GeneradorXoshiro::GeneradorXoshiro(uint64_t semilla, uint64_t flujo)
+    : normalGuardada(0.0), hayNormal(false) {
+    // splitmix64 expande la semilla; el flujo se mezcla antes para separar secuencias
+    uint64_t x = semilla ^ (flujo * 0xD1B54A32D192ED03ull);
+    splitmix64(x);
+    for (int i = 0; i < 4; ++i) estado[i] = splitmix64(x);
+}
+
+uint64_t GeneradorXoshiro::siguiente() {
+    uint64_t resultado = rotl(estado[1] * 5, 7) * 9;
+    uint64_t t = estado[1] << 17;
+    estado[2] ^= estado[0];
+    estado[3] ^= estado[1];
+    estado[1] ^= estado[2];
+    estado[0] ^= estado[3];
+    estado[2] ^= t;
+    estado[3] = rotl(estado[3], 45);
+    return resultado;
+}
+
+double GeneradorXoshiro::uniforme() {
+    // 53 bits altos: todos los double de [0, 1) con paso 2^-53
+    return static_cast<double>(siguiente() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double GeneradorXoshiro::normal() {
+    if (hayNormal) {
+        hayNormal = false;
+        return normalGuardada;
+    }
+    double u, v, s;
+    do {
+        u = 2.0 * uniforme() - 1.0;
+        v = 2.0 * uniforme() - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    double factor = std::sqrt(-2.0 * std::log(s) / s);
+    normalGuardada = v * factor;
+    hayNormal = true;
+    return u * factor;
+}
+
+ModeloSenal ModeloSenal::porTipo(char tipo) {
+    ModeloSenal m;
+    if (tipo == 'P') {
+        // Presión: estable, ruido de ±1 unidad, golpes de ariete ocasionales
+        m.base = 80.0f; m.deriva = 0.05f; m.retorno = 0.002f; m.ruido = 1.0f;
+        m.probabilidadPico = 0.0005f; m.magnitudPico = 25.0f; m.minimo = 0.0f; m.maximo = 200.0f;
+    } else if (tipo == 'V') {
+        // Vibración: conteos con mucho ruido y ráfagas frecuentes
+        m.base = 20.0f; m.deriva = 0.1f; m.retorno = 0.01f; m.ruido = 5.0f;
+        m.probabilidadPico = 0.002f; m.magnitudPico = 60.0f; m.minimo = 0.0f; m.maximo = 500.0f;
+    } else {
+        // Temperatura: deriva térmica lenta con ruido pequeño
+        m.base = 40.0f; m.deriva = 0.02f; m.retorno = 0.001f; m.ruido = 0.3f;
+        m.probabilidadPico = 0.0002f; m.magnitudPico = 15.0f; m.minimo = -40.0f; m.maximo = 125.0f;
+    }
+    return m;
+}
+
+FlujoSimulado::FlujoSimulado(const ModeloSenal& m, uint64_t semilla, uint64_t indice)
+    : modelo(m), generador(semilla, indice), nivel(m.base) {}
+
+void FlujoSimulado::generar(float* destino, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        nivel += modelo.deriva * generador.normal() + modelo.retorno * (modelo.base - nivel);
+        double valor = nivel + modelo.ruido * generador.normal();
+        if (generador.uniforme() < modelo.probabilidadPico) {
+            valor += modelo.magnitudPico * (0.5 + 0.5 * generador.uniforme());
+        }
+        if (valor < modelo.minimo) valor = modelo.minimo;
+        if (valor > modelo.maximo) valor = modelo.maximo;
+        destino[i] = static_cast<float>(valor);
+    }
+}
+
+/// Mapa id -> sensor de todo el sistema, en una sola pasada (buscarSensor es lineal)
+static std::unordered_map<std::string, SensorBase*> indizarSensores(SistemaGestion& sistema) {
+    std::unordered_map<std::string, SensorBase*> indice;
+    sistema.paraCadaSensor([&indice](SensorBase* s) { indice[s->getId()] = s; });
+    return indice;
+}
+
+Simulador::Simulador(SistemaGestion& s, uint64_t semillaParam)
+    : sistema(s), semilla(semillaParam) {
+    creados[0] = creados[1] = creados[2] = 0;
+}
+
+void Simulador::agregarSensores(char tipo, int cantidad) {
+    int indiceTipo = tipo == 'T' ? 0 : (tipo == 'P' ? 1 : 2);
+    ModeloSenal modelo = ModeloSenal::porTipo(tipo);
+    std::unordered_map<std::string, SensorBase*> existentes = indizarSensores(sistema);
+    for (int i = 0; i < cantidad; ++i) {
+        std::string id = std::string("SIM-") + tipo + "-" + std::to_string(creados[indiceTipo]++);
+        std::unordered_map<std::string, SensorBase*>::iterator it = existentes.find(id);
+        SensorBase* sensor = it != existentes.end() ? it->second : nullptr;
+        if (!sensor) {
+            sensor = crearSensor(tipo, id.c_str());
+            if (!sensor) return;
+            sistema.agregarSensor(sensor);
+        }
+        Objetivo objetivo = { id, sensor, FlujoSimulado(modelo, semilla, objetivos.size()) };
+        objetivos.push_back(objetivo);
+    }
+}
+
+void Simulador::inyectar(std::vector<Objetivo>& objetivos, size_t desde, size_t paso,
+                         uint64_t lecturasPorSensor) {
+    float lote[kTamanoLote];
+    for (uint64_t hechas = 0; hechas < lecturasPorSensor; hechas += kTamanoLote) {
+        size_t n = static_cast<size_t>(
+            lecturasPorSensor - hechas < kTamanoLote ? lecturasPorSensor - hechas : kTamanoLote);
+        for (size_t i = desde; i < objetivos.size(); i += paso) {
+            SensorBase* sensor = objetivos[i].sensor;
+            if (!sensor) continue;
+            objetivos[i].flujo.generar(lote, n);
+            for (size_t j = 0; j < n; ++j) sensor->registrarLectura(lote[j]);
+        }
+    }
+}
+
+ResultadoCarga Simulador::ejecutar(uint64_t lecturasPorSensor, int hilos) {
+    if (hilos < 1) hilos = 1;
+    if (static_cast<size_t>(hilos) > objetivos.size() && !objetivos.empty()) {
+        hilos = static_cast<int>(objetivos.size());
+    }
+
+    bool logPrevio = logDetallado.exchange(false);
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    size_t activos = 0;
+    {
+        // Los sensores no pueden liberarse mientras se les inyecta
+        SistemaGestion::GuardiaLectura guardia(sistema);
+        std::unordered_map<std::string, SensorBase*> vivos = indizarSensores(sistema);
+        for (size_t i = 0; i < objetivos.size(); ++i) {
+            std::unordered_map<std::string, SensorBase*>::iterator it = vivos.find(objetivos[i].id);
+            objetivos[i].sensor = it != vivos.end() ? it->second : nullptr;
+            if (objetivos[i].sensor) ++activos;
+        }
+        std::vector<std::thread> trabajadores;
+        for (int h = 1; h < hilos; ++h) {
+            trabajadores.push_back(std::thread(&Simulador::inyectar, std::ref(objetivos),
+                                               static_cast<size_t>(h), static_cast<size_t>(hilos),
+                                               lecturasPorSensor));
+        }
+        inyectar(objetivos, 0, static_cast<size_t>(hilos), lecturasPorSensor);
+        for (size_t i = 0; i < trabajadores.size(); ++i) trabajadores[i].join();
+    }
+    std::chrono::duration<double> duracion = std::chrono::steady_clock::now() - inicio;
+    logDetallado.store(logPrevio);
+
+    ResultadoCarga resultado;
+    resultado.lecturas = lecturasPorSensor * activos;
+    resultado.segundos = duracion.count();
+    resultado.porSegundo = resultado.segundos > 0.0 ? resultado.lecturas / resultado.segundos : 0.0;
+    return resultado;
+}
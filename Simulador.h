@@ -0,0 +1,149 @@
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+/**
+ * @file Simulador.h
+ * @brief Generación determinista de lecturas a alta tasa para pruebas de carga
+ *
+ * Sustituye a rand(), que comparte estado global y no es seguro entre hilos.
+ * Cada sensor simulado tiene su propio flujo xoshiro256** derivado de una
+ * semilla y de su índice, de modo que la misma semilla produce exactamente
+ * las mismas lecturas sin importar cuántos hilos se usen.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SistemaGestion;
+class SensorBase;
+
+/**
+ * @brief Generador pseudoaleatorio xoshiro256** (Blackman y Vigna)
+ *
+ * Cuatro palabras de estado y unas pocas operaciones por número; no usa
+ * memoria compartida, así que cada hilo puede tener el suyo.
+ */
+class GeneradorXoshiro {
+public:
+    /**
+     * @param semilla Semilla base
+     * @param flujo Índice del flujo; flujos distintos dan secuencias independientes
+     */
+    explicit GeneradorXoshiro(uint64_t semilla = 0, uint64_t flujo = 0);
+
+    /// Siguiente número de 64 bits
+    uint64_t siguiente();
+
+    /// Uniforme en [0, 1)
+    double uniforme();
+
+    /// Normal estándar (Marsaglia polar; guarda el segundo valor)
+    double normal();
+
+private:
+    uint64_t estado[4];
+    double normalGuardada;
+    bool hayNormal;
+};
+
+/**
+ * @brief Modelo de señal de un tipo de sensor
+ *
+ * La lectura es nivel + ruido; el nivel hace un paseo aleatorio lento
+ * (deriva) que tiende a volver a la base, y con baja probabilidad aparece
+ * un pico. El resultado se recorta al rango físico del tipo.
+ */
+struct ModeloSenal {
+    float base;             ///< Valor de reposo
+    float deriva;           ///< Desviación del paso del paseo aleatorio por lectura
+    float retorno;          ///< Fracción de la distancia a la base que se corrige por lectura
+    float ruido;            ///< Desviación estándar del ruido de medición
+    float probabilidadPico; ///< Probabilidad de pico por lectura
+    float magnitudPico;     ///< Amplitud máxima del pico
+    float minimo;           ///< Límite inferior del rango físico
+    float maximo;           ///< Límite superior del rango físico
+
+    /// Modelo por defecto de 'T', 'P' o 'V'
+    static ModeloSenal porTipo(char tipo);
+};
+
+/**
+ * @brief Flujo de lecturas de un sensor simulado
+ */
+class FlujoSimulado {
+public:
+    FlujoSimulado(const ModeloSenal& modelo, uint64_t semilla, uint64_t indice);
+
+    /**
+     * @brief Genera un lote de lecturas consecutivas
+     * @param destino Arreglo de al menos n elementos
+     * @param n Cantidad de lecturas
+     */
+    void generar(float* destino, size_t n);
+
+private:
+    ModeloSenal modelo;
+    GeneradorXoshiro generador;
+    double nivel;
+};
+
+/**
+ * @brief Resultado de una prueba de carga
+ */
+struct ResultadoCarga {
+    uint64_t lecturas;   ///< Lecturas registradas en total
+    double segundos;     ///< Tiempo de pared de la inyección
+    double porSegundo;   ///< Lecturas por segundo
+};
+
+/**
+ * @brief Inyector de carga sobre SistemaGestion
+ *
+ * Crea sensores "SIM-T-0", "SIM-P-0", ... (o reutiliza los existentes) y los
+ * reparte entre hilos. Cada hilo genera lotes con el flujo de cada sensor y
+ * los registra directamente, sin pasar por texto ni por colas.
+ */
+class Simulador {
+public:
+    static const size_t kTamanoLote = 256; ///< Lecturas generadas por lote
+
+    /**
+     * @param sistema Sistema donde se registran las lecturas
+     * @param semilla Semilla de todos los flujos
+     */
+    Simulador(SistemaGestion& sistema, uint64_t semilla);
+
+    /**
+     * @brief Agrega sensores simulados de un tipo
+     * @param tipo 'T', 'P' o 'V'
+     * @param cantidad Sensores a agregar
+     */
+    void agregarSensores(char tipo, int cantidad);
+
+    /**
+     * @brief Registra lecturasPorSensor lecturas en cada sensor simulado
+     *
+     * Los sensores eliminados del sistema desde agregarSensores() se omiten.
+     * @param hilos Hilos inyectores (al menos 1)
+     */
+    ResultadoCarga ejecutar(uint64_t lecturasPorSensor, int hilos);
+
+private:
+    struct Objetivo {
+        std::string id;
+        SensorBase* sensor;     ///< Resuelto en cada ejecución; nullptr si fue eliminado
+        FlujoSimulado flujo;
+    };
+
+    SistemaGestion& sistema;
+    uint64_t semilla;
+    std::vector<Objetivo> objetivos;
+    int creados[3];
+
+    static void inyectar(std::vector<Objetivo>& objetivos, size_t desde, size_t paso,
+                         uint64_t lecturasPorSensor);
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "TablaIds.h"
+#include <mutex>
+
+TablaIds& TablaIds::global() {
+    static TablaIds tabla;
+    return tabla;
+}
+
+uint32_t TablaIds::calcularHash(const char* texto, size_t largo) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < largo; ++i) {
+        h ^= static_cast<unsigned char>(texto[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+TablaIds::TablaIds() : cantidad(0), ranuras(1024, kInvalido), libreEnBloque(0), cursor(nullptr) {
+    for (uint32_t i = 0; i < kMaxSegmentos; ++i) segmentos[i].store(nullptr, std::memory_order_relaxed);
+}
+
+TablaIds::~TablaIds() {
+    for (uint32_t i = 0; i < kMaxSegmentos; ++i) delete[] segmentos[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < bloques.size(); ++i) delete[] bloques[i];
+}
+
+uint32_t TablaIds::sondear(const char* texto, size_t largo, uint32_t h, size_t& ranura) const {
+    size_t mascara = ranuras.size() - 1;
+    for (ranura = h & mascara; ; ranura = (ranura + 1) & mascara) {
+        uint32_t id = ranuras[ranura];
+        if (id == kInvalido) return kInvalido;
+        const Entrada& e = entrada(id);
+        // El hash guardado descarta casi todas las colisiones sin tocar el texto
+        if (e.hash == h && e.largo == largo && std::memcmp(e.texto, texto, largo) == 0) return id;
+    }
+}
+
+uint32_t TablaIds::buscar(const char* texto, size_t largo) const {
+    uint32_t h = calcularHash(texto, largo);
+    size_t ranura;
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return sondear(texto, largo, h, ranura);
+}
+
+const char* TablaIds::copiarTexto(const char* texto, size_t largo) {
+    size_t necesario = largo + 1;
+    if (necesario > libreEnBloque) {
+        size_t tamano = necesario > kTamanoBloque ? necesario : kTamanoBloque;
+        cursor = new char[tamano];
+        bloques.push_back(cursor);
+        libreEnBloque = tamano;
+    }
+    char* copia = cursor;
+    std::memcpy(copia, texto, largo);
+    copia[largo] = '\0';
+    cursor += necesario;
+    libreEnBloque -= necesario;
+    return copia;
+}
+
+void TablaIds::crecer() {
+    std::vector<uint32_t> nuevas(ranuras.size() * 2, kInvalido);
+    size_t mascara = nuevas.size() - 1;
+    uint32_t n = cantidad.load(std::memory_order_relaxed);
+    for (uint32_t id = 0; id < n; ++id) {
+        size_t r = entrada(id).hash & mascara;
+        while (nuevas[r] != kInvalido) r = (r + 1) & mascara;
+        nuevas[r] = id;
+    }
+    ranuras.swap(nuevas);
+}
+
+uint32_t TablaIds::internar(const char* texto, size_t largo) {
+    uint32_t h = calcularHash(texto, largo);
+    size_t ranura;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        uint32_t id = sondear(texto, largo, h, ranura);
+        if (id != kInvalido) return id;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    // Otro hilo pudo internarlo entre los dos cerrojos
+    uint32_t id = sondear(texto, largo, h, ranura);
+    if (id != kInvalido) return id;
+
+    id = cantidad.load(std::memory_order_relaxed);
+    if (id >= kMaxSegmentos * kTamanoSegmento) return kInvalido;
+    uint32_t segmento = id >> kBitsSegmento;
+    if (segmentos[segmento].load(std::memory_order_relaxed) == nullptr) {
+        segmentos[segmento].store(new Entrada[kTamanoSegmento], std::memory_order_release);
+    }
+    Entrada& e = segmentos[segmento].load(std::memory_order_relaxed)[id & (kTamanoSegmento - 1)];
+    e.texto = copiarTexto(texto, largo);
+    e.largo = static_cast<uint32_t>(largo);
+    e.hash = h;
+    cantidad.store(id + 1, std::memory_order_release);
+
+    if (static_cast<size_t>(id + 1) * 2 > ranuras.size()) {
+        crecer();
+    } else {
+        ranuras[ranura] = id;
+    }
+    return id;
+}
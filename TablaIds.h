@@ -0,0 +1,97 @@
+#ifndef TABLA_IDS_H
+#define TABLA_IDS_H
+
+/**
+ * @file TablaIds.h
+ * @brief Internado de identificadores de sensor en handles de 32 bits
+ *
+ * Cada texto de identificador se guarda una sola vez y recibe un handle
+ * denso (0, 1, 2, ...) junto con su hash precalculado. Comparar dos ids pasa
+ * a ser comparar dos enteros, y los índices por sensor pueden ser vectores
+ * indexados por el handle en lugar de mapas de cadenas.
+ *
+ * Los textos no se liberan nunca: la tabla vive lo que el proceso, y un
+ * handle sigue siendo válido aunque el sensor se elimine.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <shared_mutex>
+#include <vector>
+
+/**
+ * @brief Tabla global de identificadores internados
+ *
+ * internar() y buscar() toman un cerrojo compartido en el caso común (id ya
+ * conocido); texto(), largo() y hash() no toman ninguno.
+ */
+class TablaIds {
+public:
+    static constexpr uint32_t kInvalido = 0xFFFFFFFFu;  ///< Handle que no corresponde a ningún id
+
+    /// Tabla única del proceso
+    static TablaIds& global();
+
+    /// Hash FNV-1a de 32 bits
+    static uint32_t calcularHash(const char* texto, size_t largo);
+
+    TablaIds();
+    ~TablaIds();
+    TablaIds(const TablaIds&) = delete;
+    TablaIds& operator=(const TablaIds&) = delete;
+
+    /**
+     * @brief Handle del id, agregándolo si no existe
+     * @return Handle, o kInvalido si la tabla está llena
+     */
+    uint32_t internar(const char* texto, size_t largo);
+    uint32_t internar(const char* texto) { return internar(texto, std::strlen(texto)); }
+
+    /**
+     * @brief Handle del id sin agregarlo
+     * @return Handle, o kInvalido si el id nunca se internó
+     */
+    uint32_t buscar(const char* texto, size_t largo) const;
+    uint32_t buscar(const char* texto) const { return buscar(texto, std::strlen(texto)); }
+
+    /// Texto terminado en '\0' (válido mientras viva la tabla)
+    const char* texto(uint32_t id) const { return entrada(id).texto; }
+    uint32_t largo(uint32_t id) const { return entrada(id).largo; }
+    uint32_t hash(uint32_t id) const { return entrada(id).hash; }
+
+    /// Cantidad de ids internados
+    uint32_t getCantidad() const { return cantidad.load(std::memory_order_acquire); }
+
+private:
+    struct Entrada {
+        const char* texto;
+        uint32_t largo;
+        uint32_t hash;
+    };
+
+    static const uint32_t kBitsSegmento = 12;
+    static const uint32_t kTamanoSegmento = 1u << kBitsSegmento;
+    static const uint32_t kMaxSegmentos = 16384;          ///< 64M ids
+    static const size_t kTamanoBloque = 64 * 1024;        ///< Bloque de textos
+
+    // Las entradas viven en segmentos que nunca se mueven: leerlas no requiere cerrojo
+    std::atomic<Entrada*> segmentos[kMaxSegmentos];
+    std::atomic<uint32_t> cantidad;
+
+    mutable std::shared_mutex mtx;
+    std::vector<uint32_t> ranuras;      ///< Direccionamiento abierto; kInvalido = libre
+    std::vector<char*> bloques;         ///< Memoria de los textos
+    size_t libreEnBloque;
+    char* cursor;
+
+    const Entrada& entrada(uint32_t id) const {
+        return segmentos[id >> kBitsSegmento].load(std::memory_order_acquire)[id & (kTamanoSegmento - 1)];
+    }
+    uint32_t sondear(const char* texto, size_t largo, uint32_t h, size_t& ranura) const;
+    const char* copiarTexto(const char* texto, size_t largo);
+    void crecer();
+};
+
+#endif
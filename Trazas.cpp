@@ -0,0 +1,195 @@
+#include "Trazas.h"
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+
+std::atomic<bool> Trazador::encendido(false);
+std::atomic<uint32_t> Trazador::sesionActual(1);
+
+Trazador& Trazador::global() {
+    static Trazador trazador;
+    return trazador;
+}
+
+Trazador::~Trazador() {
+    for (size_t i = 0; i < anillos.size(); ++i) delete anillos[i];
+}
+
+uint64_t Trazador::ahoraNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// El anillo se toma en el primer tramo: los hilos que nunca trazan no gastan memoria
+static thread_local const char* nombreHilo = nullptr;
+
+Trazador::DuenoAnillo::~DuenoAnillo() {
+    if (anillo != nullptr) Trazador::global().devolver(anillo);
+}
+
+Trazador::AnilloHilo* Trazador::anilloPropio(bool crear) {
+    thread_local DuenoAnillo propio;
+    if (propio.anillo == nullptr && crear) {
+        uint32_t sesion = sesionActual.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mtx);
+        AnilloHilo* elegido = nullptr;
+        size_t posicion = 0;
+        // Primero uno libre sin tramos de esta sesión; con muchos anillos, el libre más viejo
+        for (size_t i = 0; i < libres.size() && elegido == nullptr; ++i) {
+            AnilloHilo* a = libres[i];
+            if (a->sesion.load(std::memory_order_relaxed) != sesion ||
+                a->escritos.load(std::memory_order_relaxed) == 0) {
+                elegido = a;
+                posicion = i;
+            }
+        }
+        if (elegido == nullptr && !libres.empty() && anillos.size() >= kMaximoAnillos) elegido = libres[0];
+        if (elegido != nullptr) {
+            libres.erase(libres.begin() + static_cast<std::ptrdiff_t>(posicion));
+        } else {
+            elegido = new AnilloHilo();
+            anillos.push_back(elegido);
+        }
+        elegido->escritos.store(0, std::memory_order_relaxed);
+        elegido->sesion.store(sesion, std::memory_order_relaxed);
+        elegido->hilo = ++siguienteHilo;
+        elegido->nombre = nombreHilo != nullptr ? nombreHilo : "";
+        propio.anillo = elegido;
+    }
+    return propio.anillo;
+}
+
+void Trazador::devolver(AnilloHilo* anillo) {
+    std::lock_guard<std::mutex> lock(mtx);
+    libres.push_back(anillo);
+}
+
+void Trazador::activar() {
+    std::lock_guard<std::mutex> lock(mtx);
+    // No se tocan los anillos ajenos: cada hilo vacía el suyo en su próximo tramo
+    sesionActual.fetch_add(1, std::memory_order_relaxed);
+    origenNs = ahoraNs();
+    encendido.store(true, std::memory_order_release);
+}
+
+void Trazador::desactivar() {
+    encendido.store(false, std::memory_order_release);
+}
+
+void Trazador::nombrarHilo(const char* nombre) {
+    nombreHilo = nombre;
+    AnilloHilo* a = anilloPropio(false);
+    if (a == nullptr) return;
+    std::lock_guard<std::mutex> lock(mtx);
+    a->nombre = nombre;
+}
+
+void Trazador::registrar(const char* nombre, uint64_t inicioNs, uint64_t finNs, uint32_t sensor) {
+    AnilloHilo& a = *anilloPropio(true);
+    uint32_t sesion = sesionActual.load(std::memory_order_relaxed);
+    if (a.sesion.load(std::memory_order_relaxed) != sesion) {
+        a.escritos.store(0, std::memory_order_relaxed);
+        a.sesion.store(sesion, std::memory_order_relaxed);
+    }
+    uint64_t n = a.escritos.load(std::memory_order_relaxed);
+    EventoTraza& e = a.eventos[n % kEventosPorHilo];
+    e.nombre = nombre;
+    e.inicioNs = inicioNs;
+    e.duracionNs = finNs - inicioNs;
+    e.sensor = sensor;
+    a.escritos.store(n + 1, std::memory_order_release);
+}
+
+uint64_t Trazador::getRegistrados() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    uint64_t total = 0;
+    uint32_t sesion = sesionActual.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < anillos.size(); ++i) {
+        if (anillos[i]->sesion.load(std::memory_order_acquire) != sesion) continue;
+        total += anillos[i]->escritos.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+/// Escribe el JSON por partes con write(), sin armarlo entero en memoria
+class SalidaJson {
+public:
+    explicit SalidaJson(int f) : fd(f), error(false) {}
+
+    void agregar(const char* texto) { datos += texto; if (datos.size() >= 64 * 1024) vaciar(); }
+    void agregarCadena(const char* texto) {
+        datos += '"';
+        for (const char* p = texto; *p; ++p) {
+            if (*p == '"' || *p == '\\') datos += '\\';
+            if (static_cast<unsigned char>(*p) >= 0x20) datos += *p;
+        }
+        datos += '"';
+    }
+
+    bool vaciar() {
+        size_t enviado = 0;
+        while (enviado < datos.size() && !error) {
+            ssize_t n = write(fd, datos.data() + enviado, datos.size() - enviado);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error = true;
+                break;
+            }
+            enviado += static_cast<size_t>(n);
+        }
+        datos.clear();
+        return !error;
+    }
+
+private:
+    int fd;
+    bool error;
+    std::string datos;
+};
+
+bool Trazador::exportar(int fd) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    SalidaJson salida(fd);
+    char numero[96];
+    bool primero = true;
+    salida.agregar("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    uint32_t sesion = sesionActual.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < anillos.size(); ++i) {
+        const AnilloHilo& a = *anillos[i];
+        // Un anillo que nadie usó desde activar() guarda tramos de otra sesión
+        if (a.sesion.load(std::memory_order_acquire) != sesion) continue;
+        if (!a.nombre.empty()) {
+            // Metadatos: nombre del hilo en la línea de tiempo
+            std::snprintf(numero, sizeof(numero), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,",
+                          primero ? "" : ",\n", a.hilo);
+            salida.agregar(numero);
+            salida.agregar("\"args\":{\"name\":");
+            salida.agregarCadena(a.nombre.c_str());
+            salida.agregar("}}");
+            primero = false;
+        }
+        uint64_t escritos = a.escritos.load(std::memory_order_acquire);
+        uint64_t desde = escritos > kEventosPorHilo ? escritos - kEventosPorHilo : 0;
+        for (uint64_t j = desde; j < escritos; ++j) {
+            const EventoTraza& e = a.eventos[j % kEventosPorHilo];
+            // Tramos empezados antes de activar() no tienen lugar en la línea de tiempo
+            if (e.inicioNs < origenNs) continue;
+            salida.agregar(primero ? "{\"name\":" : ",\n{\"name\":");
+            salida.agregarCadena(e.nombre);
+            std::snprintf(numero, sizeof(numero), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                          a.hilo, (e.inicioNs - origenNs) / 1000.0, e.duracionNs / 1000.0);
+            salida.agregar(numero);
+            if (e.sensor != TablaIds::kInvalido) {
+                salida.agregar(",\"args\":{\"sensor\":");
+                salida.agregarCadena(TablaIds::global().texto(e.sensor));
+                salida.agregar("}");
+            }
+            salida.agregar("}");
+            primero = false;
+        }
+    }
+    salida.agregar("\n]}\n");
+    return salida.vaciar();
+}
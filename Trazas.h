@@ -0,0 +1,145 @@
+#ifndef TRAZAS_H
+#define TRAZAS_H
+
+/**
+ * @file Trazas.h
+ * @brief Tramos de traza con alcance y exportación al formato trace-event de Chrome
+ *
+ * Los contadores dicen cuánto, pero no cuándo: una espera de 1.5 s en el
+ * select() de readLineFromSerial() o un procesarLectura() lento sobre un
+ * historial enorme solo se ven en una línea de tiempo. Un TramoTraza mide
+ * desde su construcción hasta su destrucción y lo anota en un anillo propio
+ * del hilo (sin cerrojos ni memoria dinámica en la ruta caliente).
+ * exportar() escribe todos los anillos como JSON que abren chrome://tracing
+ * y Perfetto.
+ *
+ * Con las trazas desactivadas un tramo cuesta una lectura relajada de un
+ * atómico y un salto.
+ *
+ * Cuando un hilo termina, su anillo vuelve a una lista de libres y lo toma
+ * el próximo hilo que trace: los hilos de corta vida (consultas de
+ * MotorCorrelacion, fragmentos, servidores) no suman un anillo cada vez.
+ * Mientras queden anillos libres sin tramos de la sesión actual se usan
+ * esos; pasado kMaximoAnillos se reutiliza el libre más viejo aunque se
+ * pierdan sus tramos.
+ */
+
+#include "TablaIds.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Un tramo terminado
+ */
+struct EventoTraza {
+    const char* nombre;     ///< Literal de cadena: se guarda el puntero
+    uint64_t inicioNs;      ///< CLOCK_MONOTONIC
+    uint64_t duracionNs;
+    uint32_t sensor;        ///< Handle en TablaIds o TablaIds::kInvalido
+};
+
+/**
+ * @brief Anillos de todos los hilos y control global de las trazas
+ */
+class Trazador {
+public:
+    static const size_t kEventosPorHilo = 16384;   ///< Los más viejos se pisan
+    static const size_t kMaximoAnillos = 64;        ///< Desde aquí se reutilizan anillos con tramos
+
+    static Trazador& global();
+
+    /// Lectura barata que hacen todos los tramos
+    static bool activo() { return encendido.load(std::memory_order_relaxed); }
+
+    /// Descarta lo anotado (empieza una sesión nueva) y empieza a registrar
+    void activar();
+
+    /// Deja de registrar; lo anotado se conserva para exportar()
+    void desactivar();
+
+    /// Nombre que aparece en la línea de tiempo para el hilo que llama (literal de cadena)
+    void nombrarHilo(const char* nombre);
+
+    /// Anota un tramo en el anillo del hilo que llama
+    void registrar(const char* nombre, uint64_t inicioNs, uint64_t finNs, uint32_t sensor);
+
+    /**
+     * @brief Escribe las trazas como JSON trace-event de Chrome
+     *
+     * Debe llamarse con las trazas desactivadas: los anillos se leen sin
+     * sincronizarse con los hilos que los llenan.
+     * @return false si falló la escritura
+     */
+    bool exportar(int fd) const;
+
+    /// Tramos anotados desde activar(), incluidos los que ya se pisaron
+    /// (los de anillos reutilizados después de terminar su hilo ya no cuentan)
+    uint64_t getRegistrados() const;
+
+    static uint64_t ahoraNs();
+
+private:
+    struct AnilloHilo {
+        std::vector<EventoTraza> eventos;
+        std::atomic<uint64_t> escritos;
+        std::atomic<uint32_t> sesion;   ///< Sesión a la que pertenecen los escritos
+        uint32_t hilo;           ///< tid de la exportación, en orden de registro
+        std::string nombre;
+
+        AnilloHilo() : eventos(kEventosPorHilo), escritos(0), sesion(0), hilo(0) {}
+    };
+
+    /// Devuelve el anillo a la lista de libres cuando termina su hilo
+    struct DuenoAnillo {
+        AnilloHilo* anillo;
+        DuenoAnillo() : anillo(nullptr) {}
+        ~DuenoAnillo();
+    };
+
+    static std::atomic<bool> encendido;
+    /// Número de la sesión actual: cada hilo vacía su propio anillo al verla cambiar
+    static std::atomic<uint32_t> sesionActual;
+
+    mutable std::mutex mtx;                 ///< Solo para alta y baja de hilos y exportación
+    std::vector<AnilloHilo*> anillos;       ///< Todos los anillos (en uso y libres); se liberan al salir
+    std::vector<AnilloHilo*> libres;        ///< De hilos que terminaron, el más viejo primero
+    uint32_t siguienteHilo;
+    uint64_t origenNs;
+
+    Trazador() : siguienteHilo(0), origenNs(0) {}
+    ~Trazador();
+    AnilloHilo* anilloPropio(bool crear);
+    void devolver(AnilloHilo* anillo);
+};
+
+/**
+ * @brief Mide su propio alcance
+ *
+ * @code
+ *   TramoTraza traza("buscarSensor");
+ * @endcode
+ */
+class TramoTraza {
+public:
+    /// @param nombre Literal de cadena (se guarda el puntero)
+    explicit TramoTraza(const char* nombre, uint32_t sensor = TablaIds::kInvalido)
+        : nombre(nombre), sensor(sensor), inicioNs(Trazador::activo() ? Trazador::ahoraNs() : 0) {}
+
+    ~TramoTraza() {
+        if (inicioNs != 0) Trazador::global().registrar(nombre, inicioNs, Trazador::ahoraNs(), sensor);
+    }
+
+    TramoTraza(const TramoTraza&) = delete;
+    TramoTraza& operator=(const TramoTraza&) = delete;
+
+private:
+    const char* nombre;
+    uint32_t sensor;
+    uint64_t inicioNs;      ///< 0 = las trazas estaban apagadas al empezar
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "VentanaLecturas.h"
+#include <ctime>
+
+VentanaLecturas::VentanaLecturas() {
+    for (int i = 0; i < kCubetas; ++i) {
+        cubetas[i].periodo = 0;
+        cubetas[i].cantidad = 0;
+        cubetas[i].minimo = 0.0f;
+        cubetas[i].maximo = 0.0f;
+        cubetas[i].suma = 0.0;
+    }
+}
+
+uint32_t VentanaLecturas::periodoActual() {
+    // La resolución del reloj grueso (milisegundos) sobra para intervalos de minutos
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    // +1: el periodo 0 queda reservado para las cubetas vacías
+    return static_cast<uint32_t>(ts.tv_sec / kSegundosCubeta) + 1;
+}
+
+void VentanaLecturas::agregar(float valor, uint32_t periodo) {
+    CubetaLecturas& c = cubetas[periodo % kCubetas];
+    if (c.periodo != periodo) {
+        c.periodo = periodo;
+        c.cantidad = 0;
+        c.minimo = valor;
+        c.maximo = valor;
+        c.suma = 0.0;
+    }
+    ++c.cantidad;
+    c.suma += valor;
+    if (valor < c.minimo) c.minimo = valor;
+    if (valor > c.maximo) c.maximo = valor;
+}
+
+void VentanaLecturas::resumir(int minutos, uint32_t periodo, CubetaLecturas& total) const {
+    int n = (minutos * 60 + kSegundosCubeta - 1) / kSegundosCubeta;
+    if (n > kCubetas) n = kCubetas;
+    if (n < 1) n = 1;
+    total.periodo = periodo;
+    total.cantidad = 0;
+    total.minimo = 0.0f;
+    total.maximo = 0.0f;
+    total.suma = 0.0;
+    for (int i = 0; i < kCubetas; ++i) {
+        const CubetaLecturas& c = cubetas[i];
+        if (c.cantidad == 0 || c.periodo > periodo || periodo - c.periodo >= static_cast<uint32_t>(n)) continue;
+        if (total.cantidad == 0 || c.minimo < total.minimo) total.minimo = c.minimo;
+        if (total.cantidad == 0 || c.maximo > total.maximo) total.maximo = c.maximo;
+        total.cantidad += c.cantidad;
+        total.suma += c.suma;
+    }
+}
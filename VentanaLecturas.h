@@ -0,0 +1,58 @@
+#ifndef VENTANA_LECTURAS_H
+#define VENTANA_LECTURAS_H
+
+/**
+ * @file VentanaLecturas.h
+ * @brief Resumen por intervalos de tiempo de las lecturas recientes de un sensor
+ *
+ * Las lecturas del historial no llevan marca de tiempo. Para responder
+ * consultas como "máximo en la última hora" sin recorrer nodos, cada sensor
+ * acumula cantidad, suma, mínimo y máximo por intervalos de 5 minutos en un
+ * anillo que cubre la última hora. La ventana se resuelve con la
+ * granularidad de un intervalo.
+ */
+
+#include <cstdint>
+
+/**
+ * @brief Totales de las lecturas de un intervalo
+ */
+struct CubetaLecturas {
+    uint32_t periodo;   ///< Número de intervalo (segundos monotónicos / kSegundosCubeta)
+    uint32_t cantidad;
+    float minimo;
+    float maximo;
+    double suma;
+};
+
+/**
+ * @brief Anillo de intervalos de la última hora
+ *
+ * No es seguro entre hilos: el sensor lo actualiza con su cerrojo tomado.
+ */
+class VentanaLecturas {
+public:
+    static const int kCubetas = 12;           ///< Intervalos retenidos
+    static const int kSegundosCubeta = 300;   ///< Duración de cada intervalo
+
+    VentanaLecturas();
+
+    /// Intervalo actual según el reloj monotónico de baja resolución
+    static uint32_t periodoActual();
+
+    /// Suma una lectura al intervalo indicado
+    void agregar(float valor, uint32_t periodo);
+
+    /**
+     * @brief Totales de los intervalos que caen en los últimos minutos
+     * @param minutos Largo de la ventana; se redondea hacia arriba a intervalos completos
+     * @param periodo Intervalo actual (el de periodoActual())
+     * @param total Recibe la cantidad, suma, mínimo y máximo combinados
+     */
+    void resumir(int minutos, uint32_t periodo, CubetaLecturas& total) const;
+
+private:
+    CubetaLecturas cubetas[kCubetas];
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef VISITANTE_HISTORIAL_H
+#define VISITANTE_HISTORIAL_H
+
+/**
+ * @file VisitanteHistorial.h
+ * @brief Recorrido del historial de un sensor conservando el tipo de sus valores
+ *
+ * SensorBase no conoce el T de su ListaSensor<T>. Con este visitante (doble
+ * despacho) cada sensor entrega sus lecturas como float o int sin copiarlas
+ * ni convertirlas a un tipo común.
+ */
+
+/**
+ * @brief Receptor de las lecturas de SensorBase::recorrerHistorial()
+ */
+class VisitanteHistorial {
+public:
+    virtual ~VisitanteHistorial() {}
+
+    /**
+     * @brief Inicio del historial de un sensor
+     * @param id Identificador del sensor
+     * @param tipo 'T', 'P' o 'V'
+     * @param cantidad Lecturas que se van a entregar
+     */
+    virtual void comenzarSensor(const char* id, char tipo, int cantidad) = 0;
+
+    virtual void visitar(float valor) = 0;
+    virtual void visitar(int valor) = 0;
+
+    /**
+     * @brief Lecturas consecutivas del sensor actual
+     *
+     * Los sensores entregan el historial por bloques; por omisión cada valor
+     * se reenvía a visitar(). Un visitante que procese arreglos completos
+     * puede redefinirlas.
+     */
+    virtual void visitarBloque(const float* valores, int n) {
+        for (int i = 0; i < n; ++i) visitar(valores[i]);
+    }
+    virtual void visitarBloque(const int* valores, int n) {
+        for (int i = 0; i < n; ++i) visitar(valores[i]);
+    }
+
+    /// Fin del historial del sensor actual
+    virtual void terminarSensor() {}
+};
+
+#endif
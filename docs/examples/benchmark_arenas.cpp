@@ -0,0 +1,56 @@
+// Example: medición de los modos de página de ArenaNodos en un historial largo (snippet para Doxygen @example)
+#include "SensorSystem.h"
+#include "Afinidad.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+
+static double segundosDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+/// Cada modo corre en un proceso hijo para empezar con arenas vacías
+static void medirModo(ModoPaginasArena modo, int lecturas, int recorridos) {
+    logDetallado.store(false);
+    AfinidadHilos::global().setCpus(HILO_PROCESAMIENTO, std::vector<int>(1, cpuActual()));
+    AfinidadHilos::global().aplicar(HILO_PROCESAMIENTO);
+    ArenaNodos::setModoPaginas(modo);
+
+    // Cuatro historiales intercalados, como los sensores de un mismo fragmento
+    ListaSensor<float> historiales[4];
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; ++i) historiales[i % 4].insertar(static_cast<float>(i % 100));
+    double insercion = segundosDesde(inicio);
+
+    double total = 0;
+    inicio = std::chrono::steady_clock::now();
+    for (int r = 0; r < recorridos; ++r) {
+        for (int h = 0; h < 4; ++h) historiales[h].paraCada([&total](float v) { total += v; });
+    }
+    double recorrido = segundosDesde(inicio);
+
+    EstadisticasArenas e = ArenaNodos::getEstadisticas();
+    std::printf("modo %d: insertar %.1f ns/lectura, recorrer %.2f ns/nodo, %zu tramos (%zu MAP_HUGETLB, %zu fallidos)"
+                " nodo %d [%g]\n",
+                static_cast<int>(modo), insercion * 1e9 / lecturas,
+                recorrido * 1e9 / (static_cast<double>(lecturas) * recorridos), e.tramos, e.tramosExplicitos,
+                e.fallosExplicitos, nodoNumaActual(), total);
+}
+
+int main_benchmark_arenas() {
+    const int lecturas = 8 * 1000 * 1000;
+    const int recorridos = 5;
+    for (int modo = PAGINAS_NORMALES; modo <= PAGINAS_EXPLICITAS; ++modo) {
+        pid_t hijo = fork();
+        if (hijo < 0) return 1;
+        if (hijo == 0) {
+            medirModo(static_cast<ModoPaginasArena>(modo), lecturas, recorridos);
+            std::fflush(stdout);
+            _exit(0);
+        }
+        int estado;
+        waitpid(hijo, &estado, 0);
+    }
+    return 0;
+}
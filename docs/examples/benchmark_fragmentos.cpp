@@ -0,0 +1,49 @@
+// Example: escalado de MotorIngesta con la cantidad de fragmentos (snippet para Doxygen @example)
+// Mide lecturas aplicadas por segundo con 1, 2, 4 y 8 fragmentos sobre los
+// mismos sensores. Con fragmentos independientes el rendimiento debería
+// crecer casi en proporción hasta la cantidad de CPUs libres.
+#include "Ingesta.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double medirFragmentos(int fragmentos, int sensores, int lecturas) {
+    SistemaGestion sistema;
+    std::string bloque;
+    for (int i = 0; i < sensores; ++i) {
+        std::string id = "T-ESC-" + std::to_string(i);
+        sistema.agregarSensor(new SensorTemperatura(id.c_str()));
+        bloque += "T," + id + "," + std::to_string(20 + i % 10) + "\n";
+    }
+    // Las líneas se analizan antes de medir: solo cuenta el reparto y la aplicación
+    MotorIngesta motor(sistema, fragmentos);
+    std::vector<RegistroLectura> modelo;
+    motor.analizarBloque(bloque.data(), bloque.size(), modelo);
+    std::vector<RegistroLectura> lote;
+
+    motor.iniciar();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    for (int enviadas = 0; enviadas < lecturas; enviadas += static_cast<int>(modelo.size())) {
+        lote = modelo;
+        motor.encolarLote(lote);
+    }
+    motor.detener();   // Vacía las colas antes de volver
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return lecturas / segundos;
+}
+
+int main_benchmark_fragmentos() {
+    logDetallado.store(false);
+    const int sensores = 4096;
+    const int lecturas = 4 * 1000 * 1000;
+    double base = 0;
+    std::printf("CPUs: %u\n", std::thread::hardware_concurrency());
+    for (int fragmentos = 1; fragmentos <= 8; fragmentos *= 2) {
+        double porSegundo = medirFragmentos(fragmentos, sensores, lecturas);
+        if (fragmentos == 1) base = porSegundo;
+        std::printf("%d fragmentos: %.2f M lecturas/s (x%.2f)\n", fragmentos, porSegundo / 1e6, porSegundo / base);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+// Example: eliminar sensores mientras corren el programador y la ingesta (snippet para Doxygen @example)
+// Pensado para compilarse con -fsanitize=address: un sensor liberado que siga en
+// los pendientes aparece como uso después de liberar en procesarIncremental().
+#include "SensorSystem.h"
+#include "ProgramadorProcesamiento.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main_prueba_eliminar_sensores() {
+    logDetallado.store(false);
+    const int sensores = 32;
+    const int vueltas = 2000;
+    SistemaGestion sistema;
+    std::vector<std::string> ids;
+    for (int i = 0; i < sensores; ++i) ids.push_back("T-BAJA-" + std::to_string(i));
+
+    ProgramadorProcesamiento programador(sistema);
+    programador.setPeriodo('T', 1);
+    programador.iniciar();
+
+    // Ingesta: lecturas continuas, así cada sensor vuelve a los pendientes enseguida
+    std::atomic<bool> activo(true);
+    std::thread ingesta([&] {
+        for (unsigned n = 0; activo.load(); ++n) {
+            SistemaGestion::GuardiaLectura guardia(sistema);
+            SensorBase* s = sistema.buscarSensor(ids[n % sensores].c_str());
+            if (s != nullptr) s->registrarLectura(static_cast<float>(n % 40));
+        }
+    });
+
+    for (int v = 0; v < vueltas; ++v) {
+        const std::string& id = ids[v % sensores];
+        if (!sistema.eliminarSensor(id.c_str())) sistema.agregarSensor(new SensorTemperatura(id.c_str()));
+    }
+
+    activo.store(false);
+    ingesta.join();
+    programador.detener();
+    std::printf("%d altas y bajas, %lu sensores procesados\n", vueltas, programador.getVisitados());
+    return 0;
+}
@@ -1,23 +1,90 @@
 #include "SensorSystem.h"
 #include "serial_linux.h"
+#include "Ingesta.h"
+#include "Corrutinas.h"
+#include "ProgramadorProcesamiento.h"
+#include "Simulador.h"
+#include "ExportadorColumnar.h"
+#include "ImportadorCSV.h"
+#include "PresupuestoMemoria.h"
+#include "MotorConsultas.h"
+#include "ServidorIngesta.h"
+#include "MotorCorrelacion.h"
+#include "Afinidad.h"
+#include <fcntl.h>
+#include <unistd.h>
 #include <cstdlib>
 #include <ctime>
 #include <sstream>
 #include <limits>
 
 float simularLecturaSerial(int tipoSensor) {
+    // Un generador por hilo: rand() comparte estado global y no es seguro entre hilos
+    static thread_local GeneradorXoshiro generador(
+        static_cast<uint64_t>(time(0)), std::hash<std::thread::id>()(std::this_thread::get_id()));
     if (tipoSensor == 1) { // Temperatura (float)
-        return 30.0f + static_cast<float>(rand() % 200) / 10.0f;
+        return 30.0f + static_cast<float>(generador.siguiente() % 200) / 10.0f;
     } else if (tipoSensor == 2) { // Presión (int)
-        return 70.0f + static_cast<float>(rand() % 20);
+        return 70.0f + static_cast<float>(generador.siguiente() % 20);
     } else if (tipoSensor == 3) { // Vibración (int)
-        return static_cast<float>(rand() % 50); // 0-49 vibraciones
+        return static_cast<float>(generador.siguiente() % 50); // 0-49 vibraciones
     }
     return 0.0f;
 }
 
+/**
+ * @brief Tarea que registra cada línea recibida por un descriptor serial
+ */
+Tarea tareaIngestaSerial(SistemaGestion& sistema, DescriptorPropio fd) {
+    LectorLineas lector(fd.get());
+    std::string linea;
+    while (co_await lector.leerLinea(linea)) {
+        RegistroLectura registro;
+        if (parsearLinea(linea.data(), linea.size(), registro) != PARSEO_OK) {
+            std::cout << "[ERR] Formato invalido: " << linea << "\n";
+            continue;
+        }
+        if (aplicarRegistro(sistema, registro)) {
+            std::cout << "[OK] " << TablaIds::global().texto(registro.id) << " <- " << registro.valor << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Tarea que ejecuta el procesamiento polimórfico cada periodoMs
+ */
+Tarea tareaProcesamiento(SistemaGestion& sistema, int periodoMs) {
+    for (;;) {
+        co_await dormir(periodoMs);
+        co_await procesarLote(sistema, 16);
+    }
+}
+
+/**
+ * @brief Tarea que imprime el estado de los sensores cada periodoMs
+ */
+Tarea tareaReporte(SistemaGestion& sistema, int periodoMs) {
+    for (;;) {
+        co_await dormir(periodoMs);
+        std::cout << "\n--- Estado Actual de los Sensores ---\n";
+        sistema.imprimirTodos();
+    }
+}
+
+/**
+ * @brief Tarea que detiene el planificador cuando el usuario escribe una línea
+ */
+Tarea tareaTeclado(Planificador& planificador) {
+    LectorLineas lector(STDIN_FILENO);
+    std::string linea;
+    co_await lector.leerLinea(linea);
+    planificador.detener();
+}
+
 void menu(SistemaGestion& sistema) {
     int opcion;
+    ProgramadorProcesamiento programador(sistema);
+    PresupuestoMemoria memoria(sistema);
     std::cout << "\n--- Sistema IoT de Monitoreo Polimórfico ---\n";
     do {
         std::cout << "\nSeleccione una opcion:\n";
@@ -29,6 +96,25 @@ void menu(SistemaGestion& sistema) {
         std::cout << "6. Imprimir Info de Sensores\n";
         std::cout << "7. Cerrar Sistema (Liberar Memoria)\n";
         std::cout << "8. Leer una linea desde Serial (/dev/ttyUSB0) y registrar\n";
+        std::cout << "9. Ingesta multi-dispositivo fragmentada\n";
+        std::cout << "10. Modo asincrono (serial + procesamiento y reporte periodicos)\n";
+        std::cout << "11. Activar/Detener procesamiento incremental periodico\n";
+        std::cout << "12. Percentiles de la flota por tipo\n";
+        std::cout << "13. Ver anomalias detectadas\n";
+        std::cout << "14. Prueba de carga con lecturas simuladas\n";
+        std::cout << "15. Exportar reporte (texto, CSV o JSON)\n";
+        std::cout << "16. Exportar historiales completos (formato columnar)\n";
+        std::cout << "17. Importar captura CSV historica\n";
+        std::cout << "18. Presupuesto de memoria de los historiales\n";
+        std::cout << "19. Consultar sensores (filtro y agregado)\n";
+        std::cout << "20. Clasificacion de sensores (K mejores por metrica)\n";
+        std::cout << "21. Servidor de ingesta TCP/UDP (agregador de gateways)\n";
+        std::cout << "22. Publicar estado en memoria compartida (tablero, alertas)\n";
+        std::cout << "23. Recortar lecturas atipicas de un sensor\n";
+        std::cout << "24. Activar/detener trazas de tiempo (JSON para chrome://tracing)\n";
+        std::cout << "25. Correlacion entre sensores\n";
+        std::cout << "26. Reglas de alerta (agregar, cargar archivo o ver alertas)\n";
+        std::cout << "27. Afinidad de hilos y paginas de las arenas\n";
         std::cout << "Opcion: ";
         
         if (!(std::cin >> opcion)) {
@@ -116,36 +202,611 @@ void menu(SistemaGestion& sistema) {
                     std::cout << "[Timeout] No se recibio nada.\n";
                     break;
                 }
-                // Espera "T,T-001,27.8" ó "P,P-105,81" ó "V,V-001,15"
-                char tipo = 0;
-                std::string id, valstr;
-                size_t p1 = s.find(','), p2 = (p1==std::string::npos) ? std::string::npos : s.find(',', p1+1);
-                if(p1!=std::string::npos && p2!=std::string::npos){
-                    tipo = s[0];
-                    id = s.substr(p1+1, p2-(p1+1));
-                    valstr = s.substr(p2+1);
-                }
-                if(!tipo || id.empty() || valstr.empty()){
+                RegistroLectura registro;
+                ResultadoParseo resultado = parsearLinea(s.data(), s.size(), registro);
+                if(resultado == PARSEO_FORMATO_INVALIDO){
                     std::cout << "[ERR] Formato invalido: " << s << "\n";
                     break;
                 }
-                auto sensor = sistema.buscarSensor(id.c_str());
-                if(!sensor){
-                    std::cout << "[WARN] Sensor '" << id << "' no existe. Creandolo...\n";
-                    if(tipo=='T' || tipo=='t') sistema.agregarSensor(new SensorTemperatura(id.c_str()));
-                    else if(tipo=='P' || tipo=='p') sistema.agregarSensor(new SensorPresion(id.c_str()));
-                    else if(tipo=='V' || tipo=='v') sistema.agregarSensor(new SensorVibracion(id.c_str()));
-                    sensor = sistema.buscarSensor(id.c_str());
+                if(resultado == PARSEO_VALOR_INVALIDO){
+                    std::cout << "[ERR] Valor no numerico: " << s << "\n";
+                    break;
+                }
+                if(resultado == PARSEO_TIPO_INVALIDO){
+                    std::cout << "[ERR] Tipo de sensor desconocido: " << s << "\n";
+                    break;
+                }
+                if(aplicarRegistro(sistema, registro)){
+                    std::cout << "[OK] " << TablaIds::global().texto(registro.id) << " <- " << registro.valor << "\n";
+                }
+                break;
+            }
+            case 9: {
+                int numFragmentos = 0;
+                std::cout << "Cantidad de fragmentos (hilos de procesamiento): ";
+                if (!(std::cin >> numFragmentos) || numFragmentos < 1) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Valor invalido.\n";
+                    break;
+                }
+                std::cout << "Dispositivos separados por espacio; 'bin:' pide formato binario (ej: /dev/ttyUSB0 bin:/dev/ttyACM0): ";
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::string linea;
+                std::getline(std::cin, linea);
+
+                MotorIngesta motor(sistema, numFragmentos);
+                std::istringstream rutas(linea);
+                std::string ruta;
+                while (rutas >> ruta) {
+                    bool binario = ruta.compare(0, 4, "bin:") == 0;
+                    if (binario) ruta.erase(0, 4);
+                    if (motor.agregarDispositivo(ruta.c_str(), 115200, binario)) {
+                        std::cout << "[OK] Leyendo " << ruta << "\n";
+                    }
+                }
+                motor.iniciar();
+                std::cout << "Ingesta en marcha. Presione Enter para detener...\n";
+                std::getline(std::cin, linea);
+                motor.detener();
+
+                MotorIngesta::Estadisticas e = motor.getEstadisticas();
+                std::cout << "[Ingesta] Lineas: " << e.lineas << ", lecturas binarias: " << e.registrosBinarios
+                          << ", invalidas: " << e.invalidas << "\n";
+                for (size_t i = 0; i < e.aplicados.size(); ++i) {
+                    std::cout << "  Fragmento " << i << ": " << e.aplicados[i]
+                              << " lecturas, " << e.esperas[i] << " esperas por cola llena\n";
+                }
+                break;
+            }
+
+            case 10: {
+                Planificador planificador;
+                int fd = abrirPuertoSerial("/dev/ttyUSB0", 115200);
+                if (fd >= 0) {
+                    planificador.lanzar(tareaIngestaSerial(sistema, DescriptorPropio(fd)));
+                } else {
+                    std::cout << "[WARN] /dev/ttyUSB0 no disponible; solo procesamiento y reporte.\n";
+                }
+                planificador.lanzar(tareaProcesamiento(sistema, 5000));
+                planificador.lanzar(tareaReporte(sistema, 10000));
+                planificador.lanzar(tareaTeclado(planificador));
+
+                int flags = fcntl(STDIN_FILENO, F_GETFL);
+                fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+                std::cout << "Modo asincrono en marcha. Escriba 'q' y Enter para volver al menu...\n";
+                planificador.ejecutar();
+                fcntl(STDIN_FILENO, F_SETFL, flags);
+                break;
+            }
+
+            case 11: {
+                if (programador.estaEnMarcha()) {
+                    programador.detener();
+                    std::cout << "[Programador] Detenido. Sensores visitados: "
+                              << programador.getVisitados() << "\n";
+                    break;
+                }
+                int periodoT = 0, periodoP = 0, periodoV = 0;
+                std::cout << "Periodos en ms para Temperatura, Presion y Vibracion (0 = desactivar): ";
+                if (!(std::cin >> periodoT >> periodoP >> periodoV)) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Valores invalidos.\n";
+                    break;
+                }
+                programador.setPeriodo('T', periodoT);
+                programador.setPeriodo('P', periodoP);
+                programador.setPeriodo('V', periodoV);
+                programador.iniciar();
+                std::cout << "[Programador] En marcha. Elija 11 de nuevo para detenerlo.\n";
+                break;
+            }
+
+            case 12: {
+                const char tipos[] = {'T', 'P', 'V', 0};
+                const char* nombres[] = {"Temperatura", "Presion", "Vibracion", "Todos"};
+                std::cout << "\n--- Percentiles de la Flota ---\n";
+                for (int i = 0; i < 4; ++i) {
+                    BosquejoKLL flota;
+                    sistema.fusionarBosquejos(tipos[i], flota);
+                    std::cout << "[" << nombres[i] << "] Lecturas: " << flota.getCantidad()
+                              << ", p50: " << flota.cuantil(0.50)
+                              << ", p95: " << flota.cuantil(0.95)
+                              << ", p99: " << flota.cuantil(0.99) << "\n";
+                }
+                break;
+            }
+
+            case 13: {
+                std::vector<EventoAnomalia> eventos;
+                sistema.extraerAnomalias(eventos);
+                std::cout << "\n--- Anomalias Detectadas ---\n";
+                for (size_t i = 0; i < eventos.size(); ++i) {
+                    const EventoAnomalia& e = eventos[i];
+                    std::cout << "[ALERTA " << TablaIds::global().texto(e.sensorId) << "] " << e.nombreCausa()
+                              << " en lectura #" << e.lectura << ": valor " << e.valor
+                              << ", media " << e.media << ", puntaje " << e.puntaje << "\n";
+                }
+                if (eventos.empty()) std::cout << "Sin anomalias nuevas.\n";
+                if (sistema.getAnomaliasDescartadas() > 0) {
+                    std::cout << "[WARN] Eventos descartados por cola llena: "
+                              << sistema.getAnomaliasDescartadas() << "\n";
+                }
+                break;
+            }
+
+            case 14: {
+                int porTipo = 0, hilos = 0;
+                unsigned long long lecturas = 0, semilla = 0;
+                std::cout << "Sensores por tipo, lecturas por sensor, hilos y semilla (ej. 4 100000 2 42): ";
+                if (!(std::cin >> porTipo >> lecturas >> hilos >> semilla) || porTipo < 1 || hilos < 1) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                Simulador simulador(sistema, semilla);
+                simulador.agregarSensores('T', porTipo);
+                simulador.agregarSensores('P', porTipo);
+                simulador.agregarSensores('V', porTipo);
+                std::cout << "[Simulador] Inyectando (log detallado suspendido)...\n";
+                ResultadoCarga resultado = simulador.ejecutar(lecturas, hilos);
+                std::cout << "[Simulador] " << resultado.lecturas << " lecturas en "
+                          << resultado.segundos << " s (" << resultado.porSegundo
+                          << " lecturas/s)\n";
+                break;
+            }
+
+            case 15: {
+                int formato = 0;
+                std::string ruta;
+                std::cout << "Formato (1=Texto, 2=CSV, 3=JSON) y archivo ('-' = pantalla): ";
+                if (!(std::cin >> formato >> ruta) || formato < 1 || formato > 3) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                FormatoReporte f = formato == 1 ? REPORTE_TEXTO : (formato == 2 ? REPORTE_CSV : REPORTE_JSON);
+                if (ruta == "-") {
+                    sistema.imprimirTodos(f);
+                    break;
+                }
+                int fd = open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    std::cout << "[ERR] No se pudo abrir " << ruta << "\n";
+                    break;
+                }
+                // Desde una instantánea: la ingesta en curso no espera al disco
+                InstantaneaSistema foto = sistema.tomarInstantanea();
+                bool completo = sistema.escribirReporte(foto, fd, f);
+                close(fd);
+                std::cout << (completo ? "[OK] Reporte escrito en " : "[ERR] Escritura incompleta en ")
+                          << ruta << "\n";
+                break;
+            }
+
+            case 16: {
+                std::string ruta;
+                std::cout << "Archivo de destino: ";
+                std::cin >> ruta;
+                int fd = open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    std::cout << "[ERR] No se pudo abrir " << ruta << "\n";
+                    break;
+                }
+                ExportadorColumnar exportador(fd);
+                bool completo = exportador.exportar(sistema);
+                close(fd);
+                const EstadisticasExportacion& e = exportador.getEstadisticas();
+                std::cout << (completo ? "[OK] " : "[ERR] Escritura incompleta. ")
+                          << e.filas << " lecturas de " << e.sensores << " sensores en "
+                          << e.bloques << " bloques (" << e.bytes << " bytes) -> " << ruta << "\n";
+                break;
+            }
+
+            case 17: {
+                std::string ruta;
+                int hilos = 0;
+                std::cout << "Archivo de captura y hilos (0 = automatico): ";
+                if (!(std::cin >> ruta >> hilos)) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                ImportadorCSV importador(sistema, hilos);
+                EstadisticasImportacion e;
+                if (!importador.importar(ruta.c_str(), e)) {
+                    std::cout << "[ERR] No se pudo abrir " << ruta << "\n";
+                    break;
+                }
+                double mb = static_cast<double>(e.bytes) / (1024.0 * 1024.0);
+                std::cout << "[Importacion] " << e.aplicadas << " lecturas de " << e.lineas << " lineas ("
+                          << e.invalidas << " invalidas), " << e.creados << " sensores creados, "
+                          << mb << " MB en " << e.segundos << " s ("
+                          << (e.segundos > 0 ? mb / e.segundos : 0.0) << " MB/s)\n";
+                break;
+            }
+
+            case 18: {
+                EstadoMemoria e = memoria.getEstado();
+                std::cout << "[Memoria] Residentes: " << e.residentes / 1024 << " KB, presupuesto: ";
+                if (e.presupuesto == 0) std::cout << "sin limite"; else std::cout << e.presupuesto / 1024 << " KB";
+                std::cout << ", derrames: " << e.derrames << ", recuperaciones: " << e.recuperaciones
+                          << ", archivo: " << e.bytesArchivo / 1024 << " KB (" << e.bytesDerramados / 1024
+                          << " KB en uso)\n";
+                size_t kb = 0;
+                std::string directorio;
+                std::cout << "Presupuesto en KB (0 = sin limite) y directorio para el derrame: ";
+                if (!(std::cin >> kb >> directorio)) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                if (!memoria.configurar(kb * 1024, directorio.c_str())) {
+                    std::cout << "[ERR] No se pudo crear el archivo de derrame en " << directorio << "\n";
+                    break;
+                }
+                if (kb == 0) {
+                    memoria.detener();
+                    std::cout << "[Memoria] Sin limite; los historiales derramados vuelven al usarse.\n";
+                } else {
+                    memoria.iniciar();
+                    size_t liberados = memoria.aplicar();
+                    std::cout << "[Memoria] Presupuesto activo. Liberados ahora: " << liberados / 1024 << " KB\n";
+                }
+                break;
+            }
+
+            case 19: {
+                std::string tipo, prefijo, agregado, condicion;
+                int ventana = 0;
+                std::cout << "Tipo (T/P/V/*), prefijo de id (* = todos), agregado (sensores/max/min/promedio/contar),\n"
+                          << "ventana en minutos (0 = historial) y condicion (>N, <N o -): ";
+                Consulta consulta;
+                ComparacionConsulta comparacion = COMPARAR_NADA;
+                float umbral = 0.0f;
+                bool valida = static_cast<bool>(std::cin >> tipo >> prefijo >> agregado >> ventana >> condicion);
+                if (valida && condicion != "-") {
+                    char* fin = nullptr;
+                    umbral = std::strtof(condicion.c_str() + 1, &fin);
+                    comparacion = condicion[0] == '>' ? COMPARAR_MAYOR : condicion[0] == '<' ? COMPARAR_MENOR : COMPARAR_NADA;
+                    valida = comparacion != COMPARAR_NADA && fin != condicion.c_str() + 1 && *fin == '\0';
+                }
+                if (valida) {
+                    if (agregado == "sensores") consulta.agregado = CONSULTA_SENSORES;
+                    else if (agregado == "max") consulta.agregado = CONSULTA_MAXIMO;
+                    else if (agregado == "min") consulta.agregado = CONSULTA_MINIMO;
+                    else if (agregado == "promedio") consulta.agregado = CONSULTA_PROMEDIO;
+                    else if (agregado == "contar") consulta.agregado = CONSULTA_CONTAR;
+                    else valida = false;
+                }
+                // contar exige la condicion por lectura; en los demas filtra sensores por su promedio
+                if (valida && consulta.agregado == CONSULTA_CONTAR && comparacion == COMPARAR_NADA) valida = false;
+                if (!valida || ventana < 0) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                consulta.tipo = tipo == "*" ? 0 : tipo[0];
+                consulta.prefijo = prefijo == "*" ? nullptr : prefijo.c_str();
+                consulta.ventanaMinutos = ventana;
+                if (consulta.agregado == CONSULTA_CONTAR) {
+                    consulta.comparacion = comparacion;
+                    consulta.umbral = umbral;
+                } else {
+                    consulta.filtroPromedio = comparacion;
+                    consulta.umbralPromedio = umbral;
+                }
+
+                ResultadoConsulta r = MotorConsultas(sistema).ejecutar(consulta);
+                if (!r.valido) {
+                    std::cout << "[Consulta] No se puede contar por valor dentro de una ventana para estos sensores.\n";
+                    break;
+                }
+                std::cout << "[Consulta] Resultado: " << r.valor << " (" << r.lecturas << " lecturas)\n";
+                for (size_t i = 0; i < r.sensores.size() && i < 20; ++i) {
+                    std::cout << "  " << TablaIds::global().texto(r.sensores[i]) << "\n";
+                }
+                if (r.sensores.size() > 20) std::cout << "  ... y " << r.sensores.size() - 20 << " mas\n";
+                std::cout << "[Consulta] Candidatos: " << r.candidatos << ", resueltos por estadisticas: "
+                          << r.resueltos << ", recorridos: " << r.recorridos << " (" << r.valoresLeidos
+                          << " valores) en " << r.segundos * 1000.0 << " ms\n";
+                break;
+            }
+
+            case 20: {
+                char tipo;
+                std::string metrica;
+                size_t k = 0;
+                std::cout << "Tipo (T/P/V), metrica (ultima/promedio/maximo) y K: ";
+                if (!(std::cin >> tipo >> metrica >> k) ||
+                    (metrica != "ultima" && metrica != "promedio" && metrica != "maximo")) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                MetricaClasificacion m = metrica == "ultima" ? METRICA_ULTIMA
+                                       : metrica == "promedio" ? METRICA_PROMEDIO : METRICA_MAXIMO;
+                std::vector<PosicionClasificacion> filas;
+                sistema.mejoresSensores(tipo, m, k, filas);
+                if (filas.empty()) {
+                    std::cout << "[Clasificacion] Sin sensores de tipo " << tipo << " con lecturas.\n";
+                    break;
+                }
+                for (size_t i = 0; i < filas.size(); ++i) {
+                    std::cout << "  " << i + 1 << ". " << TablaIds::global().texto(filas[i].sensor)
+                              << ": " << filas[i].valor << "\n";
+                }
+                break;
+            }
+
+            case 21: {
+                int numFragmentos = 0;
+                int puerto = 0;
+                std::string interfaz;
+                long maximoIds = 0;
+                std::cout << "Fragmentos, puerto TCP/UDP, interfaz (127.0.0.1 = solo local, 0.0.0.0 = todas)\n"
+                          << "y maximo de sensores nuevos desde la red (ej: 4 9000 127.0.0.1 1024): ";
+                if (!(std::cin >> numFragmentos >> puerto >> interfaz >> maximoIds) || numFragmentos < 1 || puerto < 1 ||
+                    puerto > 65535 || maximoIds < 0) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+                MotorIngesta motor(sistema, numFragmentos);
+                ServidorIngesta servidor(motor);
+                servidor.setMaximoIdsNuevos(static_cast<size_t>(maximoIds));
+                bool tcp = servidor.escucharTcp(interfaz.c_str(), static_cast<uint16_t>(puerto));
+                bool udp = servidor.escucharUdp(interfaz.c_str(), static_cast<uint16_t>(puerto));
+                if (!tcp && !udp) {
+                    std::cout << "[ERROR] No se pudo abrir " << interfaz << ":" << puerto << ".\n";
+                    break;
+                }
+                motor.iniciar();
+                servidor.iniciar();
+                std::cout << "Escuchando en " << interfaz << ":" << puerto << (tcp ? " TCP" : "") << (udp ? " UDP" : "")
+                          << ". Presione Enter para detener...\n";
+                std::string linea;
+                std::getline(std::cin, linea);
+                servidor.detener();
+                motor.detener();
+
+                ServidorIngesta::Estadisticas e = servidor.getEstadisticas();
+                MotorIngesta::Estadisticas em = motor.getEstadisticas();
+                std::cout << "[Servidor] Conexiones: " << e.conexiones << " (rechazadas sin descriptores: " << e.rechazadas
+                          << "), datagramas: " << e.datagramas
+                          << " en " << e.lotesUdp << " lotes, bytes: " << e.bytes << "\n";
+                std::cout << "[Servidor] Lineas: " << em.lineas << ", invalidas: " << em.invalidas
+                          << ", registros encolados: " << e.registros << ", descartes: " << e.descartes << "\n";
+                std::cout << "[Servidor] Sensores nuevos: " << e.idsNuevos << ", lineas con id desconocido rechazadas: "
+                          << e.idsRechazados << "\n";
+                break;
+            }
+
+            case 22: {
+                PublicadorMemoria& publicador = sistema.getPublicador();
+                if (publicador.estaAbierto()) {
+                    std::cout << "[Publicador] Ya publicando. Lecturas sin lugar en la tabla: "
+                              << publicador.getSinLugar() << "\n";
+                    break;
+                }
+                std::string nombre;
+                std::cout << "Nombre de la region (ej: /sensores): ";
+                if (!(std::cin >> nombre) || nombre.empty() || nombre[0] != '/') {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                if (publicador.abrir(nombre.c_str())) {
+                    std::cout << "[Publicador] Publicando en /dev/shm" << nombre << "\n";
+                } else {
+                    std::cout << "[ERROR] No se pudo crear la region " << nombre << ".\n";
                 }
-                try {
-                    float valor = std::stof(valstr);
-                    if(sensor){
-                        sensor->registrarLectura(valor);
-                        std::cout << "[OK] " << id << " <- " << valor << "\n";
+                break;
+            }
+
+            case 23: {
+                char id[50];
+                int menores = 0;
+                int mayores = 0;
+                std::cout << "ID del sensor, lecturas menores y mayores a descartar (ej: T-001 5 5): ";
+                if (!(std::cin >> id >> menores >> mayores) || menores < 0 || mayores < 0) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                SensorBase* sensor = sistema.buscarSensor(id);
+                if (!sensor) {
+                    std::cout << "Sensor no encontrado.\n";
+                    break;
+                }
+                int k = menores < mayores ? menores : mayores;
+                std::cout << "[Recorte] Promedio recortado (" << k << " por extremo): "
+                          << sensor->promedioRecortado(k) << "\n";
+                int eliminadas = sensor->recortarHistorial(menores, mayores);
+                ResumenSensor resumen;
+                sensor->resumir(resumen);
+                std::cout << "[Recorte] Eliminadas " << eliminadas << " lecturas. Quedan " << resumen.lecturas
+                          << " con promedio " << resumen.promedio << "\n";
+                break;
+            }
+
+            case 24: {
+                Trazador& trazador = Trazador::global();
+                if (!Trazador::activo()) {
+                    trazador.activar();
+                    std::cout << "[Trazas] Registrando. Elija 24 de nuevo para detener y exportar.\n";
+                    break;
+                }
+                trazador.desactivar();
+                std::string ruta;
+                std::cout << "Archivo de destino (ej: trazas.json): ";
+                std::cin >> ruta;
+                int fd = open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    std::cout << "[ERR] No se pudo abrir " << ruta << "\n";
+                    break;
+                }
+                bool completo = trazador.exportar(fd);
+                close(fd);
+                std::cout << (completo ? "[OK] " : "[ERR] Escritura incompleta. ")
+                          << trazador.getRegistrados() << " tramos -> " << ruta << "\n";
+                break;
+            }
+
+            case 25: {
+                ConsultaCorrelacion consulta;
+                std::string linea;
+                std::cout << "IDs de los sensores separados por espacios (ej: T-001 P-105): ";
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::getline(std::cin, linea);
+                std::istringstream ids(linea);
+                std::string id;
+                bool encontrados = true;
+                while (ids >> id) {
+                    uint32_t handle = TablaIds::global().buscar(id.c_str(), id.size());
+                    if (handle == TablaIds::kInvalido || sistema.buscarSensor(handle) == nullptr) {
+                        std::cout << "Sensor no encontrado: " << id << "\n";
+                        encontrados = false;
+                        break;
                     }
-                } catch(...) {
-                    std::cout << "[ERR] Valor no numerico: " << valstr << "\n";
+                    consulta.sensores.push_back(handle);
+                }
+                if (!encontrados) break;
+                std::cout << "Lecturas por cubeta, ventana movil y retardo maximo en cubetas (ej: 10 30 5): ";
+                if (!(std::cin >> consulta.lecturasPorCubeta >> consulta.ventanaMovil >> consulta.retardoMaximo)) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
                 }
+                MotorCorrelacion motor(sistema);
+                ResultadoCorrelacion r = motor.ejecutar(consulta);
+                if (!r.valido) {
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                for (size_t i = 0; i < r.pares.size(); ++i) {
+                    const ResultadoPar& p = r.pares[i];
+                    std::cout << "[Correlacion] " << TablaIds::global().texto(p.a) << " ~ "
+                              << TablaIds::global().texto(p.b) << ": " << p.cubetas << " cubetas, r = "
+                              << p.correlacion << ", cov = " << p.covarianza << "\n";
+                    if (!p.movil.empty()) {
+                        std::cout << "  Movil (" << p.movil.size() << " ventanas), ultima: " << p.movil.back() << "\n";
+                    }
+                    if (consulta.retardoMaximo > 0) {
+                        std::cout << "  Mayor correlacion cruzada con desfase " << p.mejorRetardo << ": "
+                                  << p.cruzada[p.mejorRetardo + consulta.retardoMaximo] << "\n";
+                    }
+                }
+                std::cout << "[Correlacion] " << r.valoresLeidos << " lecturas leidas en " << r.segundos << " s\n";
+                break;
+            }
+
+            case 26: {
+                MotorReglas& reglas = sistema.getReglas();
+                std::string linea;
+                std::cout << "Regla (ej: T-* > 48 for 3, P-105 avg(1m) < 72), @archivo, o vacio para ver alertas: ";
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::getline(std::cin, linea);
+                if (!linea.empty() && linea[0] == '@') {
+                    size_t invalidas = 0;
+                    long agregadas = reglas.cargarArchivo(linea.c_str() + 1, invalidas);
+                    if (agregadas < 0) {
+                        std::cout << "[ERR] No se pudo abrir " << linea.substr(1) << "\n";
+                    } else {
+                        std::cout << "[Reglas] " << agregadas << " reglas agregadas, " << invalidas
+                                  << " lineas no validas. Total: " << reglas.getCantidad() << "\n";
+                    }
+                    break;
+                }
+                if (!linea.empty()) {
+                    int numero = reglas.agregar(linea.c_str());
+                    if (numero < 0) {
+                        std::cout << "Parametros no validos.\n";
+                        break;
+                    }
+                    reglas.compilar();
+                    std::cout << "[Reglas] Regla #" << numero << " activa.\n";
+                    break;
+                }
+                std::vector<AlertaRegla> alertas;
+                reglas.extraerAlertas(alertas);
+                std::cout << "\n--- Alertas de Reglas ---\n";
+                for (size_t i = 0; i < alertas.size(); ++i) {
+                    const AlertaRegla& a = alertas[i];
+                    std::cout << "[ALERTA " << TablaIds::global().texto(a.sensorId) << "] Regla #" << a.regla << " ("
+                              << reglas.getTexto(a.regla) << "): valor " << a.valor << "\n";
+                }
+                if (alertas.empty()) std::cout << "Sin alertas nuevas.\n";
+                if (reglas.getAlertasDescartadas() > 0) {
+                    std::cout << "[WARN] Alertas descartadas por cola llena: " << reglas.getAlertasDescartadas() << "\n";
+                }
+                break;
+            }
+
+            case 27: {
+                const char* roles[ROLES_HILO] = {"lectura", "ingesta", "procesamiento"};
+                std::cout << "CPUs por rol (ej: 0-3,8; '-' sin fijar; vacio conserva). Rige para hilos nuevos.\n";
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                bool valido = true;
+                for (int r = 0; r < ROLES_HILO && valido; ++r) {
+                    std::string linea;
+                    std::cout << "  " << roles[r] << ": ";
+                    std::getline(std::cin, linea);
+                    if (linea.empty()) continue;
+                    std::vector<int> cpus;
+                    if (linea != "-" && !parsearListaCpus(linea.c_str(), cpus)) {
+                        valido = false;
+                        break;
+                    }
+                    int invalida = -1;
+                    if (!cpusPermitidas(cpus, invalida)) {
+                        std::cout << "La CPU " << invalida << " no esta en linea o el proceso no puede usarla.\n";
+                        valido = false;
+                        break;
+                    }
+                    AfinidadHilos::global().setCpus(static_cast<RolHilo>(r), cpus);
+                }
+                if (!valido) {
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                int modo;
+                std::cout << "Paginas de tramos nuevos (0 normales, 1 transparentes, 2 explicitas): ";
+                if (!(std::cin >> modo) || modo < PAGINAS_NORMALES || modo > PAGINAS_EXPLICITAS) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    std::cout << "Parametros no validos.\n";
+                    break;
+                }
+                ArenaNodos::setModoPaginas(static_cast<ModoPaginasArena>(modo));
+                std::cout << "\n--- Afinidad y Arenas ---\n";
+                for (int r = 0; r < ROLES_HILO; ++r) {
+                    std::vector<int> cpus = AfinidadHilos::global().getCpus(static_cast<RolHilo>(r));
+                    std::cout << "  " << roles[r] << ":";
+                    if (cpus.empty()) std::cout << " sin fijar";
+                    for (size_t i = 0; i < cpus.size(); ++i) std::cout << " " << cpus[i];
+                    std::cout << "\n";
+                }
+                std::cout << "Fijaciones fallidas: " << AfinidadHilos::global().getFallos() << "\n";
+                EstadisticasArenas e = ArenaNodos::getEstadisticas();
+                std::cout << "Nodo NUMA de este hilo: " << nodoNumaActual() << "\n"
+                          << "Arenas: " << e.arenas << ", tramos: " << e.tramos << " (" << e.bytes / (1024 * 1024)
+                          << " MiB), con MAP_HUGETLB: " << e.tramosExplicitos << ", fallidos: " << e.fallosExplicitos << "\n"
+                          << "Arenas adoptadas: " << e.adoptadas << ", bloques recuperados de otras arenas: "
+                          << e.recuperados << "\n";
                 break;
             }
 
@@ -156,8 +817,6 @@ void menu(SistemaGestion& sistema) {
 }
 
 int main() {
-    srand(static_cast<unsigned int>(time(0)));
-    
     SistemaGestion sistema; 
     
     std::cout << "\n--- Creando Sensores de Ejemplo ---\n";
@@ -1,5 +1,7 @@
 #include "serial_linux.h"
+#include "Trazas.h"
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/select.h>
@@ -13,21 +15,40 @@ static speed_t to_speed(int baud){
     case 38400: return B38400;
     case 57600: return B57600;
     case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
     default: return B115200;
   }
 }
 
+int abrirPuertoSerial(const char* device, int baud){
+  // Solo un dispositivo de caracteres (una terminal) se abre también para escribir
+  // y negociar el formato. En una FIFO, tener el extremo de escritura haría que
+  // read() nunca devuelva 0 (no se vería la desconexión) y el saludo volvería
+  // como una línea leída
+  int fd = -1;
+  struct stat info;
+  if(stat(device, &info) == 0 && S_ISCHR(info.st_mode)) fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if(fd < 0) fd = open(device, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+  if(fd < 0) return -1;
+
+  if(isatty(fd)){
+    termios tio{}; tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, to_speed(baud));
+    cfsetospeed(&tio, to_speed(baud));
+    tio.c_cflag |= (CLOCAL | CREAD);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
 std::string readLineFromSerial(const char* device, int baud){
-  int fd = open(device, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+  TramoTraza traza("leerLineaSerial");
+  int fd = abrirPuertoSerial(device, baud);
   if(fd < 0) return {};
 
-  termios tio{}; tcgetattr(fd, &tio);
-  cfmakeraw(&tio);
-  cfsetispeed(&tio, to_speed(baud));
-  cfsetospeed(&tio, to_speed(baud));
-  tio.c_cflag |= (CLOCAL | CREAD);
-  tcsetattr(fd, TCSANOW, &tio);
-
   std::string line;
   char ch;
   // Esperar hasta 1.5 s por datos
@@ -8,3 +8,13 @@
  *   std::string s = readLineFromSerial("/dev/ttyUSB0", 115200);
  */
 std::string readLineFromSerial(const char* device = "/dev/ttyUSB0", int baud = 115200);
+
+/**
+ * Abre un dispositivo en modo no bloqueante y, si es una terminal, lo deja en
+ * modo raw a la velocidad indicada. Pipes y FIFOs se aceptan tal cual.
+ * Una terminal se abre para lectura y escritura cuando se puede (para enviar
+ * el saludo); pipes, FIFOs y archivos, solo para lectura, así el cierre del
+ * otro extremo se ve como fin de datos.
+ * Devuelve el descriptor o -1 en error.
+ */
+int abrirPuertoSerial(const char* device, int baud = 115200);